@@ -0,0 +1,99 @@
+#include "bench.h"
+#include "buildw/parser.h"
+#include "buildw/tokenizer.h"
+#include <new>
+
+using namespace wckt;
+using namespace wckt::build;
+
+/* Heap allocations made through the global operator new, which this executable replaces */
+static size_t heapAllocations = 0;
+
+void* operator new(size_t size)
+{
+	heapAllocations++;
+	if(void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{ std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept
+{ std::free(ptr); }
+
+static const char* SNIPPET =
+	"namespace geometry\n"
+	"{\n"
+	"\ttype Shape<T satisfies Point> as Circle | Polygon<T> & Closed;\n"
+	"\ttype Path as (Point[], Float) -> Point?;\n"
+	"\tarea: Float = width * height / 2 + offset.x - scale(points[0], 1.5) << 1;\n"
+	"\tclosed: Bool = count >= 3 && points[0] == points[count - 1] || forced;\n"
+	"}\n";
+
+/* Fastest of runs of fn, each preceded by an untimed setup */
+static double fastest(uint32_t runs, const std::function<void()>& setup, const std::function<void()>& fn)
+{
+	double best = 0;
+	for(uint32_t i = 0 ; i < runs ; ++i)
+	{
+		setup();
+		double t = bench::time(fn);
+		best = i == 0 || t < best ? t : best;
+	}
+	return best;
+}
+
+int main()
+{
+	std::string source;
+	uint32_t lines = 0;
+	while(lines < 20000)
+	{
+		source += SNIPPET;
+		lines += 7;
+	}
+	double kloc = lines / 1000.0;
+
+	build_info_t info = {};
+	info.sourceTable = std::make_shared<SourceTable>(base::URL(base::URL::STRING_PROTOCOL, source));
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	services::tokenize(info, &sentinel);
+	bench::report("source", kloc, "KLOC");
+
+	size_t before = heapAllocations;
+	services::parse(info, &sentinel);
+	size_t parseAllocations = heapAllocations - before;
+	const ParseArena& arena = *std::get_deleter<ParseTreeDeleter>(info.translationUnit)->arenas[0];
+	size_t objects = arena.getAllocationCount(), bytes = arena.getBytesUsed();
+
+	// Before the arena, every parse object was a heap allocation of its own
+	bench::report("parse objects per KLOC", objects / kloc, "objects");
+	bench::report("arena blocks per KLOC", arena.getBlockCount() / kloc, "blocks");
+	bench::report("heap allocations per KLOC, one per object", (parseAllocations - arena.getBlockCount() + objects) / kloc, "allocs");
+	bench::report("heap allocations per KLOC, arena", parseAllocations / kloc, "allocs");
+
+	// Tearing down the unit destructs every object then frees a few blocks, before it also freed every object
+	double arenaTeardown = fastest(5, [&info, &sentinel] {
+		services::parse(info, &sentinel);
+	}, [&info] {
+		info.translationUnit = nullptr;
+	});
+	std::vector<void*> individual;
+	double individualTeardown = fastest(5, [&individual, objects, bytes] {
+		for(size_t i = 0 ; i < objects ; ++i)
+			individual.push_back(::operator new(bytes / objects));
+	}, [&individual] {
+		for(void* ptr : individual)
+			::operator delete(ptr);
+		individual.clear();
+	});
+	bench::report("teardown per KLOC, arena", arenaTeardown * 1e3 / kloc, "ms");
+	bench::report("teardown per KLOC, freeing each object", (arenaTeardown + individualTeardown) * 1e3 / kloc, "ms");
+
+	if(sentinel.hasErrors())
+		std::cerr << "source has syntax errors" << std::endl;
+	sentinel.clear();
+	return 0;
+}
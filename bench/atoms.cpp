@@ -0,0 +1,82 @@
+#include "bench.h"
+#include "symbol/symbol.h"
+#include <malloc.h>
+
+using namespace wckt;
+using namespace wckt::sym;
+
+static const size_t SYMBOL_COUNT = 1000000;
+
+/* Bytes currently allocated on the heap */
+static size_t heapSize()
+{
+	struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+}
+
+int main()
+{
+	// A fresh prefix per run keeps every string new to the table, the same strings are found on the second pass
+	std::vector<std::string> names;
+	names.reserve(SYMBOL_COUNT);
+	for(size_t i = 0 ; i < SYMBOL_COUNT ; ++i)
+		names.push_back("symbol_" + std::to_string(i));
+	std::vector<atom_t> atoms(SYMBOL_COUNT);
+	uint32_t round = 0;
+	bench::measure("intern new identifiers", SYMBOL_COUNT, "atoms", [&names, &round] {
+		std::string prefix = "r" + std::to_string(round++) + "_";
+		for(const std::string& name : names)
+			bench::keep(AtomTable::intern(prefix + name));
+	});
+	bench::measure("intern known identifiers", SYMBOL_COUNT, "atoms", [&names, &atoms] {
+		for(size_t i = 0 ; i < SYMBOL_COUNT ; ++i)
+			atoms[i] = AtomTable::intern(names[i]);
+	});
+
+	Locator base("wckt.bench.atoms");
+	bench::measure("Locator from signature", 100000, "locators", [] {
+		for(size_t i = 0 ; i < 100000 ; ++i)
+			bench::keep(Locator("wckt.bench.atoms.Locator"));
+	});
+	bench::measure("Locator operator+", 100000, "locators", [&base] {
+		Locator child("child");
+		for(size_t i = 0 ; i < 100000 ; ++i)
+			bench::keep(base + child);
+	});
+	bench::measure("Locator operator==", 100000, "comparisons", [&base] {
+		Locator other("wckt.bench.atoms");
+		for(size_t i = 0 ; i < 100000 ; ++i)
+			bench::keep(base == other);
+	});
+
+	// Atoms are interned up front, so the namespace is measured without the atom table, but its symbols hold their locator
+	size_t before = heapSize();
+	auto table = std::make_unique<Namespace>();
+	for(size_t i = 0 ; i < SYMBOL_COUNT ; ++i)
+		table->declareSymbol(atoms[i], std::make_unique<Symbol>());
+	bench::report("Namespace memory per symbol", (double) (heapSize() - before) / SYMBOL_COUNT, "bytes");
+
+	before = heapSize();
+	auto baseline = std::make_unique<std::map<std::string, std::unique_ptr<Symbol>>>();
+	for(size_t i = 0 ; i < SYMBOL_COUNT ; ++i)
+		baseline->emplace(names[i], std::make_unique<Symbol>());
+	bench::report("std::map memory per symbol", (double) (heapSize() - before) / SYMBOL_COUNT, "bytes");
+
+	// Lookups in a shuffled order, so neither table benefits from insertion order
+	std::vector<size_t> order(SYMBOL_COUNT);
+	for(size_t i = 0 ; i < SYMBOL_COUNT ; ++i)
+		order[i] = (i * 7919) % SYMBOL_COUNT;
+	bench::measure("Namespace lookup by atom", SYMBOL_COUNT, "lookups", [&table, &atoms, &order] {
+		for(size_t i : order)
+			bench::keep(table->tryGetSymbol(atoms[i]));
+	});
+	bench::measure("Namespace lookup by string", SYMBOL_COUNT, "lookups", [&table, &names, &order] {
+		for(size_t i : order)
+			bench::keep(table->isDeclared(names[i]));
+	});
+	bench::measure("std::map lookup by string", SYMBOL_COUNT, "lookups", [&baseline, &names, &order] {
+		for(size_t i : order)
+			bench::keep(baseline->find(names[i]));
+	});
+	return 0;
+}
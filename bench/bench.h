@@ -0,0 +1,55 @@
+#pragma once
+
+#include "include/definitions.h"
+#include <chrono>
+#include <iomanip>
+
+/**
+ * Minimal benchmark support. Every file under bench/ is built into its own executable by `make bench`,
+ * whose main() reports one line per measurement. Numbers are only meaningful in optimized builds.
+ */
+namespace wckt::bench
+{
+	/* Seconds taken by one call of fn */
+	inline double time(const std::function<void()>& fn)
+	{
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/**
+	 * Runs fn until it took at least minTime seconds and ran at least 3 times, and reports the fastest run as
+	 * milliseconds, and as `units` of work per second. Returns the fastest run in seconds.
+	 */
+	inline double measure(const std::string& name, double units, const std::string& unit,
+		const std::function<void()>& fn, double minTime = 0.5)
+	{
+		double best = 0, total = 0;
+		for(uint32_t runs = 0 ; runs < 3 || total < minTime ; ++runs)
+		{
+			double t = time(fn);
+			best = runs == 0 || t < best ? t : best;
+			total += t;
+		}
+
+		std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << best * 1e3 << " ms";
+		if(units > 0)
+			std::cout << std::setprecision(0) << std::setw(16) << units / best << " " << unit << "/s";
+		std::cout << std::defaultfloat << std::endl;
+		return best;
+	}
+
+	/* Reports a value that is not a time, such as a size */
+	inline void report(const std::string& name, double value, const std::string& unit)
+	{
+		std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(value < 100 ? 2 : 0)
+			<< std::setw(15) << value << " " << unit << std::defaultfloat << std::endl;
+	}
+
+	/* Keeps the compiler from optimizing away a computed value */
+	template<typename _Ty>
+	inline void keep(const _Ty& value)
+	{ asm volatile("" : : "g"(&value) : "memory"); }
+}
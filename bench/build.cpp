@@ -0,0 +1,63 @@
+#include "bench.h"
+#include "buildw/build.h"
+#include "buildw/cache.h"
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace wckt;
+using namespace wckt::build;
+
+static const char* SNIPPET =
+	"\ttype Shape<T satisfies Point> as Circle | Polygon<T> & Closed;\n"
+	"\tarea: Float = width * height / 2 + offset.x - scale(points[0], 1.5) << 1;\n"
+	"\tclosed: Bool = count >= 3 && points[0] == points[count - 1] || forced;\n";
+
+static const uint32_t ASSET_COUNT = 64;
+
+int main()
+{
+	BuildContext context(std::make_shared<base::EngineContext>(), 0);
+	for(uint32_t i = 0 ; i < ASSET_COUNT ; ++i)
+	{
+		std::string source = "namespace asset" + std::to_string(i) + "\n{\n";
+		while(source.length() < (1 << 15))
+			source += SNIPPET;
+		context.addAsset(base::URL(base::URL::STRING_PROTOCOL, source + "}\n"), sym::Locator());
+	}
+	bench::report("assets of 32 KB", ASSET_COUNT, "assets");
+
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	uint32_t maxJobs = std::max(1u, std::thread::hardware_concurrency());
+	for(uint32_t jobs = 1 ; ; jobs = std::min(jobs * 2, maxJobs))
+	{
+		bench::measure("build with " + std::to_string(jobs) + " jobs", ASSET_COUNT, "assets", [&context, &sentinel, jobs] {
+			// The build writes every token and tree to stdout, which would dominate the measurement
+			std::stringstream discard;
+			std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+			services::buildFromContext(context, &sentinel, jobs);
+			std::cout.rdbuf(previous);
+		});
+		if(jobs == maxJobs)
+			break;
+	}
+
+	// Rebuilding unchanged assets in a new run only checks them against their records
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / ("wckt-bench-cache-" + std::to_string(::getpid()));
+	auto cache = std::make_shared<BuildCache>(directory);
+	BuildContext cached = context;
+	cached.setCache(cache);
+	std::stringstream discard;
+	std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+	services::buildFromContext(cached, &sentinel, 1);
+	std::cout.rdbuf(previous);
+	bench::measure("no-op rebuild with cache", ASSET_COUNT, "assets", [&context, &sentinel, &cache] {
+		BuildContext run = context;
+		run.setCache(cache);
+		services::buildFromContext(run, &sentinel, 1);
+	});
+	std::filesystem::remove_all(directory);
+
+	sentinel.clear();
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include "bench.h"
+#include "base/engine.h"
+#include "base/runtime/bytecode.h"
+
+using namespace wckt;
+using namespace wckt::base;
+
+static void putU16(std::string& out, uint16_t value)
+{
+	out += (char) (value & 0xff);
+	out += (char) (value >> 8);
+}
+
+static void putU32(std::string& out, uint32_t value)
+{
+	putU16(out, value & 0xffff);
+	putU16(out, value >> 16);
+}
+
+/* Hand-assembled OPP file, whose initializer stores every function as a property of its package */
+struct assembler_t
+{
+	std::string constants;
+	uint16_t constantCount = 0;
+	std::string pool;
+	std::string init;
+
+	uint16_t utf8(const std::string& value)
+	{
+		this->constants += (char) OPPFile::CUTF8;
+		putU16(this->constants, value.length());
+		this->constants += value;
+		return ++this->constantCount;
+	}
+
+	/* Function taking one argument, whose instructions are given as bytes and whose branches are offsets into them */
+	void function(const std::string& name, uint16_t localCount, const std::vector<uint16_t>& branches, const std::string& code)
+	{
+		this->constants += (char) OPPFile::CFNLIT;
+		putU32(this->constants, this->pool.length());
+		putU16(this->constants, 5 + 2 * branches.size() + code.length());
+		uint16_t index = ++this->constantCount;
+
+		this->pool += (char) 1;
+		putU16(this->pool, localCount);
+		putU16(this->pool, branches.size());
+		for(uint16_t branch : branches)
+			putU16(this->pool, branch);
+		this->pool += code;
+		this->init += std::string({ (char) OP_THIS, (char) OP_CONST, (char) index, (char) OP_SETPROP, (char) utf8(name) });
+	}
+
+	std::shared_ptr<OPPFile> assemble()
+	{
+		this->constants += (char) OPPFile::CFNLIT;
+		putU32(this->constants, this->pool.length());
+		putU16(this->constants, 5 + this->init.length() + 1);
+		uint16_t initializer = ++this->constantCount;
+		this->pool += std::string(5, '\0') + this->init + (char) OP_RETURN;
+
+		std::string file;
+		putU16(file, OPPFile::SIGNATURE);
+		putU16(file, OPPFile::MAJOR_VERSION);
+		file += (char) OPPFile::MINOR_VERSION;
+		file += std::string(12, '\0');
+		putU16(file, initializer);
+		putU32(file, 0);
+		putU32(file, this->constants.length());
+		return std::make_shared<OPPFile>(URL(URL::STRING_PROTOCOL, "bench.opp"),
+			std::make_shared<StringBuffer>(file + this->constants + this->pool));
+	}
+};
+
+static std::string code(std::initializer_list<uint8_t> bytes)
+{
+	return std::string(bytes.begin(), bytes.end());
+}
+
+int main()
+{
+	auto context = std::make_shared<EngineContext>();
+	Engine& engine = Engine::startInstance(context);
+	assembler_t assembler;
+
+	// sum(n): s = 0; while(n > 0) { s += n; n-- } return s, with the loop condition at offset 4 and the body at 14
+	std::string sum = code({
+		OP_ICONST, 0, OP_STORE, 1,
+		OP_LOAD, 0, OP_ICONST, 0, OP_GRT, OP_GOTOIF, 1, OP_LOAD, 1, OP_VRETURN,
+		OP_LOAD, 1, OP_LOAD, 0, OP_ADD, OP_STORE, 1, OP_LOAD, 0, OP_DEC, OP_STORE, 0, OP_GOTO, 0 });
+	assembler.function("sum", 2, { 4, 14 }, sum);
+
+	// count(n): o = {}; o.x = 0; while(n > 0) { o.x = o.x + 1; n-- } return o.x
+	uint16_t x = assembler.utf8("x");
+	std::string count = code({
+		OP_NEW, OP_STORE, 1, OP_LOAD, 1, OP_ICONST, 0, OP_SETPROP, (uint8_t) x,
+		OP_LOAD, 0, OP_ICONST, 0, OP_GRT, OP_GOTOIF, 1, OP_LOAD, 1, OP_GETPROP, (uint8_t) x, OP_VRETURN,
+		OP_LOAD, 1, OP_LOAD, 1, OP_GETPROP, (uint8_t) x, OP_ICONST, 1, OP_ADD, OP_SETPROP, (uint8_t) x,
+		OP_LOAD, 0, OP_DEC, OP_STORE, 0, OP_GOTO, 0 });
+	assembler.function("count", 2, { 9, 21 }, count);
+
+	// fib(n): n < 2 ? n : fib(n - 1) + fib(n - 2), looking itself up as a static symbol
+	uint16_t fib = assembler.utf8("bench.fib");
+	std::string recursive = code({
+		OP_LOAD, 0, OP_ICONST, 2, OP_LST, OP_GOTOIF, 0,
+		OP_CONST, (uint8_t) fib, OP_LOAD, 0, OP_DEC, OP_INVOKE, 1,
+		OP_CONST, (uint8_t) fib, OP_LOAD, 0, OP_ICONST, 2, OP_SUB, OP_INVOKE, 1, OP_ADD, OP_VRETURN,
+		OP_LOAD, 0, OP_VRETURN });
+	assembler.function("fib", 1, { 25 }, recursive);
+
+	engine.load(sym::Locator("bench"), assembler.assemble());
+
+	// Every workload is deterministic, so the instructions of one run give the rate of all
+	auto run = [&engine](const std::string& name, const std::string& function, Value arg) {
+		Value callee = engine.resolve(sym::Locator("bench." + function));
+		uint64_t before = engine.getInstructionCount();
+		bench::keep(engine.invoke(callee, { arg }));
+		double instructions = engine.getInstructionCount() - before;
+		bench::measure(name, instructions, "instr", [&engine, &callee, &arg] {
+			bench::keep(engine.invoke(callee, { arg }));
+		});
+	};
+	run("Int loop", "sum", Value::fromInteger(Value::INT, 1000000));
+	run("Long loop (generic operators)", "sum", Value::fromInteger(Value::LONG, 1000000));
+	run("property loop (inline caches)", "count", Value::fromInteger(Value::INT, 1000000));
+	run("recursive calls", "fib", Value::fromInteger(Value::INT, 25));
+
+	// Building one object of n properties, per property, which stays flat once objects go to dictionary shapes
+	std::vector<std::string> names;
+	for(uint32_t i = 0 ; i < 8000 ; ++i)
+		names.push_back("p" + std::to_string(i));
+	for(uint32_t n : { 1000, 2000, 4000, 8000 })
+		bench::measure("object of " + std::to_string(n) + " properties", n, "props", [&names, n] {
+			Object object;
+			for(uint32_t i = 0 ; i < n ; ++i)
+				object.setProperty(names[i], Value());
+			bench::keep(object.getShape().getSlotCount());
+		});
+
+	runtime_cache_stats_t caches = engine.getInlineCacheStatistics();
+	bench::report("inline cache hit rate", 100.0 * caches.hits / (caches.hits + caches.misses), "%");
+
+	Engine::terminateInstance(*context);
+	return 0;
+}
@@ -0,0 +1,87 @@
+#include "bench.h"
+#include "base/modules/dependencies.h"
+#include "base/modules/manifest.h"
+#include <fstream>
+#include <unistd.h>
+
+using namespace wckt;
+using namespace wckt::base;
+
+static const uint32_t MODULE_COUNT = 200;
+static const uint32_t ASSET_COUNT = 250;
+
+/* Module i depends on modules 2i + 1 and 2i + 2, and declares its assets in packages of 50 */
+static void writeModule(const std::filesystem::path& workspace, uint32_t index)
+{
+	std::filesystem::path directory = workspace / ("m" + std::to_string(index));
+	std::string xml = "<module>\n\t<dependencies>\n";
+	for(uint32_t dep : { 2 * index + 1, 2 * index + 2 })
+		if(dep < MODULE_COUNT)
+			xml += "\t\t<dependency src=\"file://" + (workspace / ("m" + std::to_string(dep)) / "module.xml").string()
+				+ "\" pckg=\"m" + std::to_string(dep) + "\">\n";
+	xml += "\t</dependencies>\n\t<packages>\n\t\t<package name=\"m" + std::to_string(index) + "\">\n";
+	for(uint32_t i = 0 ; i < ASSET_COUNT ; ++i)
+	{
+		std::string package = "p" + std::to_string(i / 50);
+		if(i % 50 == 0)
+			xml += "\t\t\t<package name=\"" + package + "\">\n";
+		std::filesystem::create_directories(directory / "src" / package);
+		std::string asset = "src/" + package + "/asset" + std::to_string(i) + ".wckt";
+		std::ofstream(directory / asset);
+		xml += "\t\t\t\t<asset src=\"file://" + asset + "\">\n";
+		if(i % 50 == 49)
+			xml += "\t\t\t</package>\n";
+	}
+	xml += "\t\t</package>\n\t</packages>\n\t<entry symbol=\"m" + std::to_string(index) + ".main\">\n</module>\n";
+	std::ofstream(directory / "module.xml") << xml;
+}
+
+int main()
+{
+	std::filesystem::path workspace = std::filesystem::temp_directory_path() / ("wckt-bench-manifest-" + std::to_string(::getpid()));
+	for(uint32_t i = 0 ; i < MODULE_COUNT ; ++i)
+		writeModule(workspace, i);
+	URL root("file://" + (workspace / "m0" / "module.xml").string());
+	bench::report("modulefiles of " + std::to_string(ASSET_COUNT) + " assets", MODULE_COUNT, "modules");
+
+	// Paths are canonicalized once per process, so every run after the first finds them cached
+	auto resolve = [&root](const modgenfunc_t& genfunc) {
+		DependencyResolver resolver(root, genfunc);
+		bench::keep(resolver.getModuleRegistry().size());
+	};
+	bench::measure("resolve without manifests", MODULE_COUNT, "modules", [&resolve] {
+		resolve(DependencyResolver::modgenfuncDefault());
+	});
+
+	// Cold runs parse every modulefile and write its manifest to a new cache directory
+	uint32_t run = 0;
+	bench::measure("resolve with cold manifest cache", MODULE_COUNT, "modules", [&resolve, &workspace, &run] {
+		auto cache = std::make_shared<ManifestCache>(workspace / ("cold" + std::to_string(run++)));
+		resolve(DependencyResolver::genCachedFunction(cache));
+	});
+
+	auto cache = std::make_shared<ManifestCache>(workspace / "warm");
+	resolve(DependencyResolver::genCachedFunction(cache));
+	size_t coldMisses = cache->getStatistics().misses;
+	bench::measure("resolve with warm manifest cache", MODULE_COUNT, "modules", [&resolve, &cache] {
+		resolve(DependencyResolver::genCachedFunction(cache));
+	});
+
+	// Touched modulefiles are hashed once and restamped, as a checkout of the workspace would leave them
+	int64_t touches = 0;
+	bench::measure("resolve with touched modulefiles", MODULE_COUNT, "modules", [&resolve, &cache, &workspace, &touches] {
+		for(uint32_t i = 0 ; i < MODULE_COUNT ; ++i)
+		{
+			std::filesystem::path file = workspace / ("m" + std::to_string(i)) / "module.xml";
+			std::filesystem::last_write_time(file, std::filesystem::last_write_time(file) + std::chrono::seconds(++touches));
+		}
+		resolve(DependencyResolver::genCachedFunction(cache));
+	});
+	bench::measure("resolve after restamping", MODULE_COUNT, "modules", [&resolve, &cache] {
+		resolve(DependencyResolver::genCachedFunction(cache));
+	});
+
+	bench::report("manifest cache misses once warm", cache->getStatistics().misses - coldMisses, "misses");
+	std::filesystem::remove_all(workspace);
+	return 0;
+}
@@ -0,0 +1,47 @@
+#include "bench.h"
+#include "base/modules/dependencies.h"
+#include <fstream>
+#include <unistd.h>
+
+using namespace wckt;
+using namespace wckt::base;
+
+/* Modulefile declaring assetCount assets in packages of 100, as generated for large code bases */
+static std::string generateModulefile(uint32_t assetCount)
+{
+	std::string xml = "<module>\n\t<dependencies>\n\t\t<dependency src=\"file://deps/std/module.xml\">\n\t</dependencies>\n\t<packages>\n";
+	for(uint32_t i = 0 ; i < assetCount ; ++i)
+	{
+		if(i % 100 == 0)
+			xml += "\t\t<package name=\"p" + std::to_string(i / 100) + "\" visibility=\"public\">\n";
+		xml += "\t\t\t<asset src=\"file://src/p" + std::to_string(i / 100) + "/asset" + std::to_string(i) + ".wckt\">\n";
+		if(i % 100 == 99 || i + 1 == assetCount)
+			xml += "\t\t</package>\n";
+	}
+	return xml + "\t</packages>\n\t<entry symbol=\"p0.main\">\n</module>\n";
+}
+
+int main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / ("wckt-bench-modulefile-" + std::to_string(::getpid()));
+	std::filesystem::create_directories(directory);
+	modgenfunc_t genfunc = DependencyResolver::modgenfuncDefault();
+
+	// Time per asset stays the same as modulefiles grow, since parsing is linear in their size
+	for(uint32_t assetCount : { 10000, 20000, 40000, 80000 })
+	{
+		std::filesystem::path file = directory / ("module" + std::to_string(assetCount) + ".xml");
+		std::string xml = generateModulefile(assetCount);
+		std::ofstream(file) << xml;
+
+		URL url("file://" + file.string());
+		std::string name = "parse modulefile of " + std::to_string(assetCount) + " assets";
+		double seconds = bench::measure(name, assetCount, "assets", [&genfunc, &url] {
+			bench::keep(genfunc(url));
+		});
+		bench::report(name + " (throughput)", xml.length() / seconds / (1 << 20), "MB/s");
+	}
+
+	std::filesystem::remove_all(directory);
+	return 0;
+}
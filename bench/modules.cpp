@@ -0,0 +1,71 @@
+#include "bench.h"
+#include "base/context.h"
+#include "base/modules/dependencies.h"
+
+using namespace wckt;
+using namespace wckt::base;
+
+static const uint32_t MODULE_COUNT = 500;
+static const uint32_t LEVEL_WIDTH = 50;
+
+static URL moduleURL(uint32_t index)
+{
+	return URL(URL::STRING_PROTOCOL, "module" + std::to_string(index));
+}
+
+/* Modules after the root form levels of LEVEL_WIDTH, each importing the package of three modules of the next level */
+static std::shared_ptr<Module> makeModule(uint32_t index)
+{
+	uint32_t next = index == 0 ? 1 : (index - 1) / LEVEL_WIDTH * LEVEL_WIDTH + LEVEL_WIDTH + 1;
+	std::vector<uint32_t> targets;
+	if(index == 0)
+		for(uint32_t i = 0 ; i < LEVEL_WIDTH ; ++i)
+			targets.push_back(next + i);
+	else
+		for(uint32_t offset : { 0, 1, 7 })
+			targets.push_back(next + ((index - 1) % LEVEL_WIDTH + offset) % LEVEL_WIDTH);
+
+	std::vector<ModuleDependency> dependencies;
+	for(uint32_t dep : targets)
+		if(dep < MODULE_COUNT)
+			dependencies.emplace_back(moduleURL(dep), sym::Locator("lib.m" + std::to_string(dep)),
+				sym::Locator("imports.m" + std::to_string(dep)));
+
+	std::string name = "m" + std::to_string(index);
+	Package lib("lib", VIS_PUBLIC, { Package(name, VIS_PUBLIC,
+		{ Package("a", VIS_PUBLIC), Package("b", VIS_PUBLIC), Package("c", VIS_PUBLIC) }) });
+	return std::make_shared<Module>(moduleURL(index), dependencies, Package("", VIS_PUBLIC, { lib }));
+}
+
+int main()
+{
+	// The graph is held in memory, fetching a modulefile only waits for the latency of reading and parsing it
+	std::unordered_map<URL, std::shared_ptr<Module>, URL::hasher_t> graph;
+	for(uint32_t i = 0 ; i < MODULE_COUNT ; ++i)
+		graph.emplace(moduleURL(i), makeModule(i));
+	DependencyResolver resolver(moduleURL(0), [&graph](const URL& url) { return graph.at(url); }, 1);
+	bench::report("modules in graph", MODULE_COUNT, "modules");
+	bench::report("topological levels", resolver.computeTopologicalLevels().size(), "levels");
+
+	// Waiting on fetches gains from more jobs than cores, declaring packages does not
+	uint32_t maxJobs = std::max(8u, WorkScheduler::getDefaultConcurrency());
+	for(uint32_t latency : { 0, 2 })
+	{
+		modgenfunc_t genfunc = [&graph, latency](const URL& url) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(latency));
+			return std::make_shared<Module>(*graph.at(url));
+		};
+		for(uint32_t jobs = 1 ; ; jobs = std::min(jobs * 2, maxJobs))
+		{
+			std::string name = "load with " + std::to_string(latency) + " ms fetches, " + std::to_string(jobs) + " jobs";
+			bench::measure(name, MODULE_COUNT, "modules", [&genfunc, jobs] {
+				auto context = std::make_shared<EngineContext>();
+				DependencyResolver resolver(moduleURL(0), genfunc, jobs);
+				context->unpackModules(resolver.computeTopologicalLevels(), jobs);
+			});
+			if(jobs == maxJobs)
+				break;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "base/context.h"
+#include "symbol/symbol.h"
+
+using namespace wckt;
+using namespace wckt::sym;
+
+static const size_t SYMBOL_COUNT = 100000;
+
+int main()
+{
+	std::vector<atom_t> atoms, missing;
+	for(size_t i = 0 ; i < SYMBOL_COUNT ; ++i)
+	{
+		atoms.push_back(AtomTable::intern("declared_" + std::to_string(i)));
+		missing.push_back(AtomTable::intern("missing_" + std::to_string(i)));
+	}
+
+	bench::measure("declare symbols", SYMBOL_COUNT, "declarations", [&atoms] {
+		Namespace table;
+		for(atom_t atom : atoms)
+			table.declareSymbol(atom, std::make_unique<Symbol>());
+	});
+
+	Namespace table;
+	for(atom_t atom : atoms)
+		table.declareSymbol(atom, std::make_unique<Symbol>());
+	bench::measure("tryGetSymbol hits", SYMBOL_COUNT, "lookups", [&table, &atoms] {
+		for(atom_t atom : atoms)
+			bench::keep(table.tryGetSymbol(atom));
+	});
+	bench::measure("tryGetSymbol misses", SYMBOL_COUNT, "lookups", [&table, &missing] {
+		for(atom_t atom : missing)
+			bench::keep(table.tryGetSymbol(atom));
+	});
+	// What every miss cost when lookups threw and caught std::out_of_range
+	bench::measure("getSymbol misses (throwing)", SYMBOL_COUNT / 10, "lookups", [&table, &missing] {
+		for(size_t i = 0 ; i < SYMBOL_COUNT / 10 ; ++i)
+		{
+			try { bench::keep(table.getSymbol(missing[i])); }
+			catch(const SymbolResolutionError&) {}
+		}
+	});
+
+	// Locators four packages deep in a module, and the same symbols reached through a reference
+	auto context = std::make_shared<base::EngineContext>();
+	moduleid_t moduleID = context->unpackModule(std::make_shared<base::Module>(base::URL(base::URL::STRING_PROTOCOL, "bench")));
+	std::vector<Locator> locators;
+	for(size_t i = 0 ; i < 1000 ; ++i)
+	{
+		locators.emplace_back(moduleID, "wckt.bench.n" + std::to_string(i % 10) + ".s" + std::to_string(i));
+		locators.back().locateOrDeclare(*context);
+	}
+	Namespace& root = Namespace::assertSymbol(Locator(moduleID, "wckt").locate(*context));
+	root.declareSymbol("alias", std::make_unique<ReferenceSymbol>(Locator(moduleID, "wckt.bench")));
+	std::vector<Locator> references;
+	for(size_t i = 0 ; i < 1000 ; ++i)
+		references.emplace_back(moduleID, "wckt.alias.n" + std::to_string(i % 10) + ".s" + std::to_string(i));
+
+	sym::LocatorCache& cache = context->getLocatorCache();
+	bench::measure("Locator::locate (cached)", 1000, "lookups", [&context, &locators] {
+		for(const Locator& locator : locators)
+			bench::keep(&locator.locate(*context));
+	});
+	bench::measure("Locator::locate (uncached)", 1000, "lookups", [&context, &cache, &locators] {
+		for(const Locator& locator : locators)
+		{
+			cache.clear();
+			bench::keep(&locator.locate(*context));
+		}
+	});
+	bench::measure("Locator::locate via reference (cached)", 1000, "lookups", [&context, &references] {
+		for(const Locator& locator : references)
+			bench::keep(&locator.locate(*context));
+	});
+	bench::measure("Locator::locate via reference (uncached)", 1000, "lookups", [&context, &cache, &references] {
+		for(const Locator& locator : references)
+		{
+			cache.clear();
+			bench::keep(&locator.locate(*context));
+		}
+	});
+	return 0;
+}
@@ -0,0 +1,162 @@
+#include "bench.h"
+#include "base/engine.h"
+#include "base/runtime/bytecode.h"
+
+using namespace wckt;
+using namespace wckt::base;
+
+static const uint32_t CONSTRUCTOR_COUNT = 10000;
+static const uint32_t CONSTRUCTED_COUNT = 100;
+
+static void putU16(std::string& out, uint16_t value)
+{
+	out += (char) (value & 0xff);
+	out += (char) (value >> 8);
+}
+
+static void putU32(std::string& out, uint32_t value)
+{
+	putU16(out, value & 0xffff);
+	putU16(out, value >> 16);
+}
+
+/* Hand-assembled OPP file, whose initializer stores every function as a property of its package */
+struct assembler_t
+{
+	std::string declarations;
+	std::string constants;
+	uint16_t constantCount = 0;
+	std::string pool;
+	std::string init;
+
+	uint16_t utf8(const std::string& value)
+	{
+		this->constants += (char) OPPFile::CUTF8;
+		putU16(this->constants, value.length());
+		this->constants += value;
+		return ++this->constantCount;
+	}
+
+	uint16_t function(uint8_t argCount, uint16_t localCount, const std::string& code)
+	{
+		this->constants += (char) OPPFile::CFNLIT;
+		putU32(this->constants, this->pool.length());
+		putU16(this->constants, 5 + code.length());
+		this->pool += (char) argCount;
+		putU16(this->pool, localCount);
+		putU16(this->pool, 0);
+		this->pool += code;
+		return ++this->constantCount;
+	}
+
+	void function(const std::string& name, uint8_t argCount, uint16_t localCount, const std::string& code)
+	{
+		uint16_t index = function(argCount, localCount, code);
+		this->init += (char) OP_THIS;
+		this->init += (char) OP_CONSTW;
+		putU16(this->init, index);
+		this->init += (char) OP_SETPROPW;
+		putU16(this->init, utf8(name));
+	}
+
+	/* Public constructor without type or generics */
+	void constructor(const std::string& name, uint16_t impl)
+	{
+		this->declarations += (char) OPPFile::DECL_CONSTRUCTOR;
+		this->declarations += '\0';
+		putU16(this->declarations, utf8(name));
+		putU16(this->declarations, 0);
+		putU16(this->declarations, impl);
+		putU32(this->declarations, 0);
+	}
+
+	std::string assemble()
+	{
+		uint16_t initializer = function(0, 0, this->init + (char) OP_RETURN);
+		std::string file;
+		putU16(file, OPPFile::SIGNATURE);
+		putU16(file, OPPFile::MAJOR_VERSION);
+		file += (char) OPPFile::MINOR_VERSION;
+		file += std::string(12, '\0');
+		putU16(file, initializer);
+		putU32(file, this->declarations.length());
+		putU32(file, this->constants.length());
+		return file + this->declarations + this->constants + this->pool;
+	}
+};
+
+/**
+ * File declaring CONSTRUCTOR_COUNT constructors c<i>(v) { this.x = v }, whose bodies are padded to bodySize bytes,
+ * and a function make() constructing an object with each of the first CONSTRUCTED_COUNT
+ */
+static std::string generateFile(uint32_t bodySize)
+{
+	assembler_t assembler;
+	uint16_t x = assembler.utf8("x");
+	std::string body = { (char) OP_THIS, (char) OP_LOAD, 0, (char) OP_SETPROPW };
+	putU16(body, x);
+	while(body.length() + 5 <= bodySize)
+		body += std::string({ (char) OP_ICONST, 1, (char) OP_STORE, 1 });
+	body += (char) OP_RETURN;
+
+	std::string make;
+	for(uint32_t i = 0 ; i < CONSTRUCTOR_COUNT ; ++i)
+	{
+		std::string name = "c" + std::to_string(i);
+		assembler.constructor(name, assembler.function(1, 2, body));
+		if(i >= CONSTRUCTED_COUNT)
+			continue;
+		make += std::string({ (char) OP_NEW, (char) OP_ICONST, (char) i, (char) OP_INVOKECONW });
+		putU16(make, assembler.utf8("bench." + name));
+		make += std::string({ (char) OP_STORE, 0 });
+	}
+	assembler.function("make", 0, 1, make + std::string({ (char) OP_LOAD, 0, (char) OP_VRETURN }));
+	return assembler.assemble();
+}
+
+int main()
+{
+	// Loading only declares constructors, their bodies are decoded and verified on first use
+	for(uint32_t bodySize : { 16, 1024 })
+	{
+		std::string contents = generateFile(bodySize);
+		auto buffer = std::make_shared<StringBuffer>(std::move(contents));
+		std::string suffix = std::to_string(bodySize) + " B bodies";
+		bench::report("OPP file of " + suffix, buffer->getView().length() / 1024.0, "KB");
+
+		auto load = [&buffer] {
+			auto context = std::make_shared<EngineContext>();
+			Engine& engine = Engine::startInstance(context);
+			engine.load(sym::Locator("bench"), std::make_shared<OPPFile>(URL(URL::STRING_PROTOCOL, "bench.opp"), buffer));
+			return context;
+		};
+		bench::measure("open and load, " + suffix, CONSTRUCTOR_COUNT, "constructors", [&load] {
+			Engine::terminateInstance(*load());
+		});
+		bench::measure("load and construct once, " + suffix, CONSTRUCTED_COUNT, "objects", [&load] {
+			auto context = load();
+			Engine& engine = Engine::getInstance(*context);
+			bench::keep(engine.invoke(engine.resolve(sym::Locator("bench.make")), {}));
+			Engine::terminateInstance(*context);
+		});
+
+		auto context = load();
+		Engine& engine = Engine::getInstance(*context);
+		Value make = engine.resolve(sym::Locator("bench.make"));
+		bench::measure("construct with decoded constructors, " + suffix, CONSTRUCTED_COUNT, "objects", [&engine, &make] {
+			bench::keep(engine.invoke(make, {}));
+		});
+		Engine::terminateInstance(*context);
+	}
+
+	// Checking a file against its source costs one pass over the source
+	std::string source(1 << 20, '\0');
+	for(size_t i = 0 ; i < source.length() ; ++i)
+		source[i] = "fn x() { return 1 }\n"[i % 20];
+	auto file = std::make_shared<OPPFile>(URL(URL::STRING_PROTOCOL, "bench.opp"),
+		std::make_shared<StringBuffer>(generateFile(16)));
+	bench::measure("match 1 MB source", 1, "MB", [&file, &source] {
+		bench::keep(file->matchesSource(source));
+	});
+	return 0;
+}
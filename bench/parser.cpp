@@ -0,0 +1,104 @@
+#include "bench.h"
+#include "buildw/parser.h"
+
+using namespace wckt;
+using namespace wckt::build;
+
+/* Generated parse table interface, as declared by the parser */
+extern uint32_t lalraction(uint32_t __row, uint32_t __col);
+extern uint32_t lalrgoto(uint32_t __row, uint32_t __col);
+extern production_t lalrprod(uint32_t __row);
+extern const uint32_t __LALR_ROW_COUNT, __LALR_GOTO_COLUMN_COUNT, __LALR_TABLE_SIZE;
+
+/* The former table layout, dense column-major uint32_t arrays filled at startup, rebuilt from the generated tables */
+static std::vector<uint32_t> denseActions, denseGotos;
+
+static uint32_t denseAction(uint32_t row, uint32_t col)
+{ return denseActions[col * __LALR_ROW_COUNT + row]; }
+
+static uint32_t denseGoto(uint32_t row, uint32_t col)
+{ return denseGotos[col * __LALR_ROW_COUNT + row]; }
+
+/* Runs the parser's automaton alone over the tokens, returning whether they were accepted */
+static bool recognize(std::shared_ptr<std::vector<Token>> tokens, uint32_t (*action)(uint32_t, uint32_t),
+	uint32_t (*_goto)(uint32_t, uint32_t))
+{
+	std::vector<uint32_t> stack = { 0 };
+	TokenIterator iterator(tokens);
+	for(;;)
+	{
+		uint32_t entry = action(stack.back(), iterator.lookAhead().getClass());
+		if(entry <= 1)
+			return entry == 1;
+		if((entry & 0b1) == 0)
+		{
+			stack.push_back((entry >> 1) - 1);
+			iterator.next();
+			continue;
+		}
+		production_t production = lalrprod((entry >> 1) - 1);
+		stack.resize(stack.size() - production.length);
+		stack.push_back(_goto(stack.back(), production.nterm));
+	}
+}
+
+static const char* SNIPPET =
+	"namespace geometry\n"
+	"{\n"
+	"\ttype Shape<T satisfies Point> as Circle | Polygon<T> & Closed;\n"
+	"\ttype Path as (Point[], Float) -> Point?;\n"
+	"\tarea: Float = width * height / 2 + offset.x - scale(points[0], 1.5) << 1;\n"
+	"\tclosed: Bool = count >= 3 && points[0] == points[count - 1] || forced;\n"
+	"}\n";
+
+int main()
+{
+	std::string source;
+	while(source.length() < (1 << 20))
+		source += SNIPPET;
+
+	build_info_t info = {};
+	info.sourceTable = std::make_shared<SourceTable>(base::URL(base::URL::STRING_PROTOCOL, source));
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+
+	services::tokenize(info, &sentinel);
+	size_t tokenCount = info.tokenSequence->size();
+	bench::report("source size", source.length(), "bytes");
+	bench::report("tokens", tokenCount, "tokens");
+
+	bench::measure("parse", tokenCount, "tokens", [&info, &sentinel] {
+		services::parse(info, &sentinel);
+	});
+
+	// Both layouts side by side, the automaton alone shows the lookups without building the tree
+	for(uint32_t col = 0 ; col < MAX_TOKEN_PLUS_ONE ; ++col)
+		for(uint32_t row = 0 ; row < __LALR_ROW_COUNT ; ++row)
+			denseActions.push_back(lalraction(row, col));
+	for(uint32_t col = 0 ; col < __LALR_GOTO_COLUMN_COUNT ; ++col)
+		for(uint32_t row = 0 ; row < __LALR_ROW_COUNT ; ++row)
+			denseGotos.push_back(lalrgoto(row, col));
+	bench::report("parser states", __LALR_ROW_COUNT, "states");
+	bench::report("table size, dense", 4 * (denseActions.size() + denseGotos.size()), "bytes");
+	bench::report("table size, comb", __LALR_TABLE_SIZE, "bytes");
+	if(!recognize(info.tokenSequence, denseAction, denseGoto) || !recognize(info.tokenSequence, lalraction, lalrgoto))
+		std::cerr << "source is not accepted" << std::endl;
+	bench::measure("recognize, dense tables", tokenCount, "tokens", [&info] {
+		bench::keep(recognize(info.tokenSequence, denseAction, denseGoto));
+	});
+	bench::measure("recognize, comb tables", tokenCount, "tokens", [&info] {
+		bench::keep(recognize(info.tokenSequence, lalraction, lalrgoto));
+	});
+
+	// Table lookups alone, over the action row of the start state and every goto column
+	bench::measure("lalraction + lalrgoto lookups", 1e6 * 2, "lookups", [] {
+		uint32_t sum = 0;
+		for(uint32_t i = 0 ; i < 1000000 ; ++i)
+			sum += lalraction(i & 0x3f, i % MAX_TOKEN_PLUS_ONE) + lalrgoto(i & 0x3f, i & 0x7);
+		bench::keep(sum);
+	});
+
+	if(sentinel.hasErrors())
+		std::cerr << "source has syntax errors" << std::endl;
+	sentinel.clear();
+	return 0;
+}
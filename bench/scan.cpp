@@ -0,0 +1,71 @@
+#include "bench.h"
+#include "buildw/scan.h"
+
+using namespace wckt;
+using namespace wckt::build;
+
+/* Per-character loops over the class table, as the scalar fallback runs them */
+static size_t runByTable(const char* data, size_t length, scan::class_t _class)
+{
+	size_t i = 0;
+	while(i < length && scan::is(data[i], _class))
+		i++;
+	return i;
+}
+
+static void newlinesByLoop(const char* data, size_t length, std::vector<size_t>& lineStarts)
+{
+	for(size_t i = 0 ; i < length ; ++i)
+		if(data[i] == '\n')
+			lineStarts.push_back(i + 1);
+}
+
+int main()
+{
+	std::cout << "implementation: " << scan::getImplementationName() << std::endl;
+
+	const std::vector<std::pair<scan::class_t, std::pair<const char*, char>>> classes = {
+		{ scan::WHITESPACE, { "whitespace", ' ' } },
+		{ scan::IDENTIFIER, { "identifier", 'a' } },
+		{ scan::SYMBOL, { "symbol", '+' } }
+	};
+
+	// Runs of every length end in a character of no class, repeated to fill 1 MB
+	for(size_t runLength : { 4, 16, 64, 1024 })
+		for(const auto& entry : classes)
+		{
+			std::string data;
+			while(data.length() < (1 << 20))
+				data += std::string(runLength, entry.second.second) + '\"';
+
+			std::string name = std::string(entry.second.first) + " runs of " + std::to_string(runLength);
+			bench::measure(name, data.length(), "bytes", [&data, &entry] {
+				size_t runs = 0;
+				for(size_t i = 0 ; i < data.length() ; i += scan::run(data.data() + i, data.length() - i, entry.first) + 1)
+					runs++;
+				bench::keep(runs);
+			});
+			bench::measure(name + " (table)", data.length(), "bytes", [&data, &entry] {
+				size_t runs = 0;
+				for(size_t i = 0 ; i < data.length() ; i += runByTable(data.data() + i, data.length() - i, entry.first) + 1)
+					runs++;
+				bench::keep(runs);
+			});
+		}
+
+	// Source-like lines of 40 characters
+	std::string source;
+	while(source.length() < (1 << 24))
+		source += "\tarea = width * height / 2 + offset;\n";
+	std::vector<size_t> lineStarts;
+	lineStarts.reserve(source.length() / 32);
+	bench::measure("newlines", source.length(), "bytes", [&source, &lineStarts] {
+		lineStarts.clear();
+		scan::newlines(source.data(), source.length(), 0, lineStarts);
+	});
+	bench::measure("newlines (loop)", source.length(), "bytes", [&source, &lineStarts] {
+		lineStarts.clear();
+		newlinesByLoop(source.data(), source.length(), lineStarts);
+	});
+	return 0;
+}
@@ -0,0 +1,48 @@
+#include "bench.h"
+#include "buildw/source.h"
+#include <unistd.h>
+
+using namespace wckt;
+using namespace wckt::build;
+
+static const char* LINE = "\tarea: Float = width * height / 2 + offset.x - scale(points[0], 1.5) << 1; // comment\n";
+
+int main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / ("wckt-bench-source-" + std::to_string(::getpid()));
+	std::filesystem::create_directories(directory);
+
+	for(size_t megabytes : { 1, 10, 100 })
+	{
+		std::filesystem::path path = directory / (std::to_string(megabytes) + ".wckt");
+		{
+			std::ofstream out(path, std::ios::binary);
+			for(size_t written = 0 ; written < (megabytes << 20) ; written += std::strlen(LINE))
+				out << LINE;
+		}
+		base::URL url(base::URL::FILE_PROTOCOL, path.string());
+		double bytes = std::filesystem::file_size(path);
+		std::string size = std::to_string(megabytes) + " MB";
+
+		bench::measure("read " + size, bytes, "bytes", [&url] {
+			bench::keep(url.read());
+		});
+		// Mapping alone reads nothing, so every page is touched as the tokenizer would
+		bench::measure("map " + size, bytes, "bytes", [&url] {
+			std::shared_ptr<base::URLBuffer> buffer = url.map();
+			std::string_view view = buffer->getView();
+			uint8_t sum = 0;
+			for(size_t i = 0 ; i < view.length() ; i += 4096)
+				sum += view[i];
+			bench::keep(sum);
+		});
+		// Loading includes indexing the lines
+		bench::measure("load source table of " + size, bytes, "bytes", [&url] {
+			SourceTable table(url);
+			bench::keep(table);
+		});
+	}
+
+	std::filesystem::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include "bench.h"
+#include "buildw/dfa.h"
+#include "buildw/tokenizer.h"
+#include <regex>
+
+using namespace wckt;
+using namespace wckt::build;
+
+static const char* SNIPPET =
+	"namespace geometry\n"
+	"{\n"
+	"\t/* Point in the plane */\n"
+	"\tcontract Point { x: Float; y: Float; }\n"
+	"\ttype Shape as Circle | Polygon;\n"
+	"\tfunction area(shape: Shape) -> Float\n"
+	"\t{\n"
+	"\t\tvar total = 0.0d, i = 0x10, mask = 0b1010us;\n"
+	"\t\tfor(i = 0 ; i < shape.count ; i++) // accumulate\n"
+	"\t\t\ttotal += shape.points[i].x * shape.points[(i + 1) % shape.count].y >> 2;\n"
+	"\t\tif(total <= 0 && !shape.closed || mask !== null) throw \"open shape\";\n"
+	"\t\treturn total / 2.5f;\n"
+	"\t}\n"
+	"}\n";
+
+/* Longest match by constructing every token class regexp, as the tokenizer did before the DFA */
+static size_t matchByRegexps(const std::string& token, Token::class_t& _class)
+{
+	std::smatch maxMatch;
+	_class = Token::__NULL__;
+	for(const auto& entry : Token::REGEXPS)
+	{
+		if(entry.second.empty())
+			continue;
+
+		std::smatch match;
+		std::regex regex(entry.second);
+		if(std::regex_search(token, match, regex, std::regex_constants::match_continuous) && (_class == Token::__NULL__ || match.length() > maxMatch.length()))
+		{
+			maxMatch = match;
+			_class = entry.first;
+		}
+	}
+	return maxMatch.length();
+}
+
+int main()
+{
+	std::string source;
+	while(source.length() < (1 << 20))
+		source += SNIPPET;
+
+	build_info_t info = {};
+	info.sourceTable = std::make_shared<SourceTable>(base::URL(base::URL::STRING_PROTOCOL, source));
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+
+	LexerDFA::standard();
+	services::tokenize(info, &sentinel);
+	size_t tokenCount = info.tokenSequence->size();
+	bench::report("source size", source.length(), "bytes");
+	bench::report("tokens", tokenCount, "tokens");
+
+	bench::measure("tokenize (dfa)", tokenCount, "tokens", [&info, &sentinel] {
+		services::tokenize(info, &sentinel);
+	});
+
+	// Matching alone, over the lexemes of one snippet
+	std::vector<std::string> lexemes;
+	for(const auto& token : *info.tokenSequence)
+	{
+		if(token.getPosition() >= std::strlen(SNIPPET))
+			break;
+		lexemes.push_back(token.getValue(*info.sourceTable));
+	}
+
+	bench::measure("match (dfa)", lexemes.size(), "tokens", [&lexemes] {
+		Token::class_t _class;
+		for(const auto& lexeme : lexemes)
+			bench::keep(LexerDFA::standard().match(lexeme, _class));
+	});
+	bench::measure("match (regexp per class and token)", lexemes.size(), "tokens", [&lexemes] {
+		Token::class_t _class;
+		for(const auto& lexeme : lexemes)
+			bench::keep(matchByRegexps(lexeme, _class));
+	});
+
+	sentinel.clear();
+	return 0;
+}
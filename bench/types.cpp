@@ -0,0 +1,56 @@
+#include "bench.h"
+#include "type/types.h"
+
+using namespace wckt;
+using namespace wckt::type;
+
+/* Chain of types prefix0 to prefix{depth - 1}, each of which refers to the next twice and the last to the first */
+static void defineChain(TypeTable& table, const std::string& prefix, size_t depth, const Type* value)
+{
+	for(size_t i = 0 ; i < depth ; ++i)
+	{
+		const Type* next = table.reference(prefix + std::to_string((i + 1) % depth));
+		table.define(prefix + std::to_string(i), 0, table.contract({}, 0, {
+			{ "left", next }, { "right", table.optional(next) }, { "value", value } }));
+	}
+}
+
+int main()
+{
+	// Defining a type drops every subtype result, so each run compares the chains from scratch
+	for(size_t depth : { 100, 1000, 4000 })
+	{
+		TypeTable table;
+		defineChain(table, "T", depth, table.reference("A"));
+		defineChain(table, "U", depth, table.unite(table.reference("A"), table.reference("B")));
+		const Type* t = table.reference("T0");
+		const Type* u = table.reference("U0");
+
+		std::string name = "subtype of chain of " + std::to_string(depth);
+		bench::measure(name, depth, "levels", [&table, t, u] {
+			table.define("V", 0, t);
+			bench::keep(table.isSubtype(t, u));
+		});
+		bench::measure(name + " (failing)", depth, "levels", [&table, t, u] {
+			table.define("V", 0, t);
+			bench::keep(table.isSubtype(u, t));
+		});
+		bench::report(name + " results", table.getSubtypeCount(), "pairs");
+	}
+
+	// Memoized results and interned types are a hash lookup away
+	TypeTable table;
+	std::vector<const Type*> references;
+	for(size_t i = 0 ; i < 64 ; ++i)
+		references.push_back(table.reference("R" + std::to_string(i)));
+	bench::measure("unite memoized", 64 * 64, "operations", [&table, &references] {
+		for(const Type* a : references)
+			for(const Type* b : references)
+				bench::keep(table.unite(a, b));
+	});
+	bench::measure("intern contract", 1000, "types", [&table, &references] {
+		for(size_t i = 0 ; i < 1000 ; ++i)
+			bench::keep(table.contract({}, 0, { { "x", references[i % 64] }, { "y", references[(i + 1) % 64] } }));
+	});
+	return 0;
+}
@@ -152,6 +152,7 @@ public class Main {
 			SourceWriter writer = new SourceWriter(new File(arguments.getOutputFile()));
 			try { writer.write(grammar, table); }
 			catch(IOException ex) { error("Failed to write source file \'" + arguments.getOutputFile() + "\', please verify file permissions"); }
+			info("Parse tables: " + writer.getCompressedTableSize() + " bytes (" + writer.getDenseTableSize() + " bytes uncompressed)");
 		}
 	}
 	
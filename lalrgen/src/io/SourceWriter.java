@@ -28,21 +28,22 @@ public class SourceWriter {
         " * ---------------------------------------------------------- */",
         "", 
         "#include \"buildw/tokenizer.h\"",
-        "#include \"buildw/parser.h\""
+        "#include \"buildw/parser.h\"",
+        "#include <array>"
     };
 
     private static final String[] SUFFIX_LINES = {
         "",
         "/* Parse table interface */",
         "",
-		"void lalrinit()",
-		"{ static bool _init = false;",
-		"  if(!_init) __init_ACTION_TABLE();",
-		"  _init = true; }",
         "uint32_t lalraction(uint32_t __row, uint32_t __col)",
-        "{ return __ACTION_TABLE[__col][__row]; }",
+        "{ uint32_t __column = __ACTION_COLUMNS[__col];",
+        "  if(__column == __ACTION_NO_COLUMN) return 0;",
+        "  uint32_t __index = __ACTION_BASE[__row] + __column;",
+        "  return __ACTION_CHECK[__index] == __row ? __ACTION_NEXT[__index] : __ACTION_DEFAULT[__row]; }",
         "uint32_t lalrgoto(uint32_t __row, uint32_t __col)",
-        "{ return __GOTO_TABLE[__col][__row]; }",
+        "{ uint32_t __index = __GOTO_BASE[__row] + __col;",
+        "  return __GOTO_CHECK[__index] == __row ? __GOTO_NEXT[__index] : __GOTO_DEFAULT[__row]; }",
         "production_t lalrprod(uint32_t __row)",
         "{ return __PROD_TABLE[__row]; }",
         "",
@@ -55,15 +56,18 @@ public class SourceWriter {
 	private static final String USING_LINE = "using namespace %s;";
 	private static final String[] DEFAULT_USINGS = {"wckt", "wckt::build"};
 	
-    private static final String ACTION_TABLE = "uint32_t __ACTION_TABLE[MAX_TOKEN_PLUS_ONE][%d] = {};";
-	private static final String ACTION_TABLE_ROWS_HEADER = "uint32_t __ACTION_TABLE_ROWS[][%d] = {";
-	private static final String ACTION_TABLE_ROWS_ENTRY = "\t{%s},";
-	private static final String ACTION_TABLE_INIT_HEADER = "void __init_ACTION_TABLE()";
-	private static final String ACTION_TABLE_INIT_BODY = "{ %s }";
-	private static final String ACTION_TABLE_INIT_ENTRY = "memcpy(__ACTION_TABLE[Token::%s], __ACTION_TABLE_ROWS[%d], sizeof(__ACTION_TABLE_ROWS[%d]));";
+	private static final String COLUMN_MAP_HEADER = "constexpr std::array<uint16_t, MAX_TOKEN_PLUS_ONE> __make_ACTION_COLUMNS()";
+	private static final String COLUMN_MAP_BODY = "{ std::array<uint16_t, MAX_TOKEN_PLUS_ONE> __map {};\n  __map.fill(__ACTION_NO_COLUMN);\n  %s\n  return __map; }";
+	private static final String COLUMN_MAP_ENTRY = "__map[Token::%s] = %d;";
+	private static final String COLUMN_MAP_NONE = "constexpr uint16_t __ACTION_NO_COLUMN = 0xffff;";
+	private static final String COLUMN_MAP = "constexpr std::array<uint16_t, MAX_TOKEN_PLUS_ONE> __ACTION_COLUMNS = __make_ACTION_COLUMNS();";
 	
-    private static final String GOTO_TABLE_HEADER = "uint32_t __GOTO_TABLE[%d][%d] = {";
-	private static final String GOTO_TABLE_ENTRY = "\t[%d] = {%s},";
+	private static final String TABLE_ARRAY_HEADER = "constexpr %s __%s[%d] = {";
+	private static final String TABLE_ARRAY_ENTRY = "\t%s,";
+	private static final int TABLE_ARRAY_ENTRIES_PER_LINE = 32;
+	
+	/* Marks unused slots in a check array, must not be a valid row number */
+	private static final int NO_ROW = 0xffff;
 	
     private static final String PROD_TABLE_HEADER = "production_t __PROD_TABLE[%d] = {";
 	private static final String PROD_TABLE_ENTRY_NO_ACTION = "\t[%d] = {.nterm = %d, .length = %d, .action = nullptr},";
@@ -71,11 +75,17 @@ public class SourceWriter {
 	
     private static final String TABLE_FOOTER = "};";
 	
+	private static final String TABLE_STATS_HEADER = "/* Table dimensions and size in bytes, read by benchmarks */";
+	private static final String TABLE_STATS_ENTRY = "extern const uint32_t __LALR_%s = %d;";
+	
 	private static final String PSEM_ACTION_HEADER = "PSEM_ACTION(__psem%d__)";
 	private static final String PSEM_ACTION_BODY = "{%s}";
 	private static final String PSEM_ELEM_DECL = " PMAKE_XELEM(%s, %d)";
 	
     private final File outputFile;
+	
+	private int denseTableSize;
+	private int compressedTableSize;
 
     public SourceWriter(File outputFile) {
         assert outputFile != null;
@@ -85,6 +95,16 @@ public class SourceWriter {
     public File getOutputFile() {
         return outputFile;
     }
+	
+	/* Size in bytes of the action and goto tables in the former dense uint32_t layout */
+	public int getDenseTableSize() {
+		return denseTableSize;
+	}
+	
+	/* Size in bytes of the emitted compressed action and goto tables */
+	public int getCompressedTableSize() {
+		return compressedTableSize;
+	}
 
     public void write(Grammar grammar, LALRParseTable table) throws IOException {
         Map<String, Integer> nterms = new HashMap<>();
@@ -98,27 +118,38 @@ public class SourceWriter {
 		lines.addAll(grammar.getUsingDirectives().stream().map(use -> String.format(USING_LINE, use)).toList());
 		lines.add("");
 		
-		lines.add(String.format(ACTION_TABLE, table.getRowCount()));
-		lines.add(String.format(ACTION_TABLE_ROWS_HEADER, table.getRowCount()));
-		for(int i = 0 ; i < table.getActionColumnCount() ; ++i) {
-			final int _i = i;
-            lines.add(String.format(ACTION_TABLE_ROWS_ENTRY, table.getOrderedRows().stream()
-				.map(row -> String.valueOf(encodeAction(row.getAction(_i)))).collect(Collectors.joining(", "))));
+		int rowCount = table.getRowCount();
+		if(rowCount >= NO_ROW)
+			throw new IllegalStateException("Too many parser states (" + rowCount + ") for 16-bit check entries");
+		
+		int[][] actions = new int[rowCount][table.getActionColumnCount()];
+		int[][] gotos = new int[rowCount][table.getGotoColumnCount()];
+		int rowIndex = 0;
+		for(LALRParseTable.Row row : table.getOrderedRows()) {
+			for(int i = 0 ; i < table.getActionColumnCount() ; ++i)
+				actions[rowIndex][i] = encodeAction(row.getAction(i));
+			for(int i = 0 ; i < table.getGotoColumnCount() ; ++i)
+				gotos[rowIndex][i] = row.getGoto(i);
+			rowIndex++;
 		}
-		lines.add(TABLE_FOOTER);
-		lines.add(ACTION_TABLE_INIT_HEADER);
-		lines.add(String.format(ACTION_TABLE_INIT_BODY, IntStream.range(0, table.getActionColumnCount())
-			.mapToObj(i -> String.format(ACTION_TABLE_INIT_ENTRY, table.getActionColumn(i), i, i)).collect(Collectors.joining("\n  "))));
-        lines.add("");
-
-        lines.add(String.format(GOTO_TABLE_HEADER, table.getGotoColumnCount(), table.getRowCount()));
-        for(int i = 0 ; i < table.getGotoColumnCount() ; ++i) {
-            final int _i = i;
-            lines.add(String.format(GOTO_TABLE_ENTRY, _i, table.getOrderedRows().stream()
-                .map(row -> String.valueOf(row.getGoto(_i))).collect(Collectors.joining(", "))));
-        }
-        lines.add(TABLE_FOOTER);
-        lines.add("");
+		
+		lines.add(COLUMN_MAP_NONE);
+		lines.add(COLUMN_MAP_HEADER);
+		lines.add(String.format(COLUMN_MAP_BODY, IntStream.range(0, table.getActionColumnCount())
+			.mapToObj(i -> String.format(COLUMN_MAP_ENTRY, table.getActionColumn(i), i)).collect(Collectors.joining("\n  "))));
+		lines.add(COLUMN_MAP);
+		lines.add("");
+		
+		CombTable actionTable = new CombTable(actions);
+		CombTable gotoTable = new CombTable(gotos);
+		compressedTableSize = actionTable.write(lines, "ACTION") + gotoTable.write(lines, "GOTO");
+		denseTableSize = 4 * rowCount * (table.getActionColumnCount() + table.getGotoColumnCount());
+		
+		lines.add(TABLE_STATS_HEADER);
+		lines.add(String.format(TABLE_STATS_ENTRY, "ROW_COUNT", rowCount));
+		lines.add(String.format(TABLE_STATS_ENTRY, "GOTO_COLUMN_COUNT", table.getGotoColumnCount()));
+		lines.add(String.format(TABLE_STATS_ENTRY, "TABLE_SIZE", compressedTableSize));
+		lines.add("");
 		
 		boolean addedAction = false;
 		for(int i = 0 ; i < table.getProductionCount() ; ++i) {
@@ -171,7 +202,7 @@ public class SourceWriter {
 		for(int i = 0 ; i < production.getSymbolCount() ; ++i) {
 			Symbol symbol = production.getSymbol(i);
 			if(symbol.isTerminal())
-				sb.append(String.format(PSEM_ELEM_DECL, "ContainerObject<Token>", i));
+				sb.append(String.format(PSEM_ELEM_DECL, "ContainerObject<ShiftedToken>", i));
 			else sb.append(String.format(PSEM_ELEM_DECL, grammar.getActionType(symbol.getValue()), i));
 		}
 		return sb.isEmpty() ? "" : sb.toString() + "\n ";
@@ -188,4 +219,122 @@ public class SourceWriter {
 		return semanticAction;
 	}
 
+	/* Narrowest unsigned integer type holding every value of the array */
+	private static String entryType(int[] values) {
+		int max = Arrays.stream(values).max().orElse(0);
+		return max <= 0xff ? "uint8_t" : max <= 0xffff ? "uint16_t" : "uint32_t";
+	}
+	
+	private static int entrySize(int[] values) {
+		String type = entryType(values);
+		return type.equals("uint8_t") ? 1 : type.equals("uint16_t") ? 2 : 4;
+	}
+	
+	private static int writeArray(List<String> lines, String name, int[] values) {
+		String type = entryType(values);
+		lines.add(String.format(TABLE_ARRAY_HEADER, type, name, values.length));
+		for(int i = 0 ; i < values.length ; i += TABLE_ARRAY_ENTRIES_PER_LINE) {
+			lines.add(String.format(TABLE_ARRAY_ENTRY, Arrays.stream(values, i, Math.min(values.length, i + TABLE_ARRAY_ENTRIES_PER_LINE))
+				.mapToObj(String::valueOf).collect(Collectors.joining(", "))));
+		}
+		lines.add(TABLE_FOOTER);
+		return entrySize(values) * values.length;
+	}
+	
+	/**
+	 * Row displacement (comb-vector) compression of a row-major table. Every row gets a default entry,
+	 * its most frequent value, and only the other entries are overlaid into the shared next/check
+	 * vectors at the row's base offset. Lookups of a row are then contiguous in memory and exact:
+	 * choosing the most frequent value (rather than always a reduction) keeps error detection,
+	 * and thus syntax error messages, unchanged.
+	 */
+	private static class CombTable {
+		
+		private final int[] base;
+		private final int[] defaults;
+		private final int[] next;
+		private final int[] check;
+		
+		public CombTable(int[][] rows) {
+			// There is always a start state, so base and defaults are never empty
+			assert rows.length > 0;
+			int rowCount = rows.length;
+			int columnCount = rows[0].length;
+			base = new int[rowCount];
+			defaults = new int[rowCount];
+			
+			List<List<Integer>> explicit = new ArrayList<>();
+			for(int r = 0 ; r < rowCount ; ++r) {
+				Map<Integer, Integer> frequencies = new HashMap<>();
+				for(int value : rows[r])
+					frequencies.merge(value, 1, Integer::sum);
+				int best = 0, bestCount = -1;
+				for(Map.Entry<Integer, Integer> entry : frequencies.entrySet()) {
+					if(entry.getValue() > bestCount || (entry.getValue() == bestCount && entry.getKey() < best)) {
+						best = entry.getKey();
+						bestCount = entry.getValue();
+					}
+				}
+				defaults[r] = best;
+				
+				List<Integer> columns = new ArrayList<>();
+				for(int c = 0 ; c < columnCount ; ++c)
+					if(rows[r][c] != best)
+						columns.add(c);
+				explicit.add(columns);
+			}
+			
+			// Densest rows first, so the sparse ones can fill the remaining gaps
+			List<Integer> order = new ArrayList<>(IntStream.range(0, rowCount).boxed().toList());
+			order.sort((a, b) -> explicit.get(b).size() != explicit.get(a).size()
+				? explicit.get(b).size() - explicit.get(a).size() : a - b);
+			
+			List<Integer> nextList = new ArrayList<>();
+			List<Integer> checkList = new ArrayList<>();
+			for(int r : order) {
+				List<Integer> columns = explicit.get(r);
+				int offset = 0;
+				while(!fits(checkList, columns, offset))
+					offset++;
+				base[r] = offset;
+				for(int c : columns) {
+					while(checkList.size() <= offset + c) {
+						nextList.add(0);
+						checkList.add(NO_ROW);
+					}
+					nextList.set(offset + c, rows[r][c]);
+					checkList.set(offset + c, r);
+				}
+			}
+			
+			// Pad so that base + column never indexes past the end, and to at least one unmatched entry
+			// when every row is its default, as zero-length arrays are ill-formed
+			int length = Math.max(1, columnCount + Arrays.stream(base).max().orElse(0));
+			while(checkList.size() < length) {
+				nextList.add(0);
+				checkList.add(NO_ROW);
+			}
+			next = nextList.stream().mapToInt(Integer::intValue).toArray();
+			check = checkList.stream().mapToInt(Integer::intValue).toArray();
+		}
+		
+		private static boolean fits(List<Integer> checkList, List<Integer> columns, int offset) {
+			for(int c : columns)
+				if(offset + c < checkList.size() && checkList.get(offset + c) != NO_ROW)
+					return false;
+			return true;
+		}
+		
+		/* Appends the table arrays to the source lines and returns their total size in bytes */
+		public int write(List<String> lines, String name) {
+			int size = writeArray(lines, name + "_BASE", base);
+			size += writeArray(lines, name + "_DEFAULT", defaults);
+			size += writeArray(lines, name + "_NEXT", next);
+			size += writeArray(lines, name + "_CHECK", check);
+			lines.add("");
+			return size;
+		}
+		
+	}
+
 }
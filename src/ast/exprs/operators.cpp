@@ -13,7 +13,7 @@ static const std::map<std::string, BinaryOperatorExpression::operator_t> BINARY_
     {"<=", BinaryOperatorExpression::LTE}, {"===", BinaryOperatorExpression::SEQ}, {"!==", BinaryOperatorExpression::SNE}
 };
 
-BinaryOperatorExpression::BinaryOperatorExpression(UPTR(Expression)&& left, UPTR(Expression)&& right, const Token& token)
+BinaryOperatorExpression::BinaryOperatorExpression(UPTR(Expression)&& left, UPTR(Expression)&& right, const ShiftedToken& token)
 : left(std::move(left)), right(std::move(right)), opStr(token.getValue()), op(BINARY_OPERATORS.at(token.getValue())) {}
 
 Expression& BinaryOperatorExpression::getLeft() const
@@ -44,7 +44,7 @@ static const std::map<std::string, UnaryOperatorExpression::operator_t> UNARY_PO
     {"++", UnaryOperatorExpression::POST_INC}, {"--", UnaryOperatorExpression::POST_DEC}
 };
 
-UnaryOperatorExpression::UnaryOperatorExpression(UPTR(Expression)&& operand, const build::Token& token, bool post)
+UnaryOperatorExpression::UnaryOperatorExpression(UPTR(Expression)&& operand, const build::ShiftedToken& token, bool post)
 : operand(std::move(operand)), opStr((post ? "post " : "pre ") + token.getValue()),
   op(post ? UNARY_POST_OPERATORS.at(token.getValue()) : UNARY_PRE_OPERATORS.at(token.getValue())) {}
 
@@ -76,7 +76,7 @@ static const std::map<std::string, AssignmentExpression::operator_t> ASSIGNMENT_
     {":>>=", AssignmentExpression::REG}
 };
 
-AssignmentExpression::AssignmentExpression(UPTR(Expression)&& left, UPTR(Expression)&& right, const Token& token)
+AssignmentExpression::AssignmentExpression(UPTR(Expression)&& left, UPTR(Expression)&& right, const ShiftedToken& token)
 : left(std::move(left)), right(std::move(right)), opStr(token.getValue()), op(ASSIGNMENT_OPERATORS.at(token.getValue())) {}
 
 Expression& AssignmentExpression::getLeft() const
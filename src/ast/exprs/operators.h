@@ -22,7 +22,7 @@ namespace wckt::ast
 			operator_t op;
 			
 		public:
-			BinaryOperatorExpression(UPTR(Expression)&& left, UPTR(Expression)&& right, const build::Token& token);
+			BinaryOperatorExpression(UPTR(Expression)&& left, UPTR(Expression)&& right, const build::ShiftedToken& token);
 			
 			Expression& getLeft() const;
 			Expression& getRight() const;
@@ -50,7 +50,7 @@ namespace wckt::ast
 			operator_t op;
 		
 		public:
-			UnaryOperatorExpression(UPTR(Expression)&& operand, const build::Token& token, bool post);
+			UnaryOperatorExpression(UPTR(Expression)&& operand, const build::ShiftedToken& token, bool post);
 			
 			Expression& getOperand() const;
 			std::string getOpStr() const;
@@ -79,7 +79,7 @@ namespace wckt::ast
 			operator_t op;
 			
 		public:
-			AssignmentExpression(UPTR(Expression)&& left, UPTR(Expression)&& right, const build::Token& token);
+			AssignmentExpression(UPTR(Expression)&& left, UPTR(Expression)&& right, const build::ShiftedToken& token);
 			
 			Expression& getLeft() const;
 			Expression& getRight() const;
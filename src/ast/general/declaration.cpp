@@ -16,6 +16,13 @@ void DeclarationSet::addDeclaration(UPTR(Declaration)&& declaration)
 		this->declarations.push_back(std::move(declaration));
 }
 
+std::vector<UPTR(Declaration)> DeclarationSet::releaseDeclarations()
+{
+	std::vector<UPTR(Declaration)> declarations = std::move(this->declarations);
+	this->declarations.clear();
+	return declarations;
+}
+
 std::string DeclarationSet::toString() const
 { return "DeclarationSet"; }
 
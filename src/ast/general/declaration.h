@@ -23,6 +23,7 @@ namespace wckt::ast
 			const std::vector<UPTR(Declaration)>& getDeclarations() const;
 			
 			void addDeclaration(UPTR(Declaration)&& declaration);
+			std::vector<UPTR(Declaration)> releaseDeclarations();
 			
 			std::string toString() const override;
 			std::vector<const ParseObject*> getElements() const override;
@@ -19,6 +19,13 @@ void TranslationUnit::insertImportStatement(UPTR(ast::ImportStatement)&& stateme
 		this->importStatements.insert(this->importStatements.begin(), std::move(statement));
 }
 
+std::vector<UPTR(ast::ImportStatement)> TranslationUnit::releaseImportStatements()
+{
+	std::vector<UPTR(ast::ImportStatement)> statements = std::move(this->importStatements);
+	this->importStatements.clear();
+	return statements;
+}
+
 std::string TranslationUnit::toString() const
 { return "TranslationUnit"; }
 
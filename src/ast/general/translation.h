@@ -19,6 +19,7 @@ namespace wckt::build
 			ast::DeclarationSet& getDeclarations() const;
 			
 			void insertImportStatement(UPTR(ast::ImportStatement)&& statement);
+			std::vector<UPTR(ast::ImportStatement)> releaseImportStatements();
 			
 			std::string toString() const override;
 			std::vector<const ParseObject*> getElements() const override;
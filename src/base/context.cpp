@@ -1,6 +1,7 @@
 #include "base/context.h"
 #include "base/modules/xmlrules.h"
 #include "include/exception.h"
+#include "include/scheduler.h"
 
 using namespace wckt;
 using namespace wckt::base;
@@ -12,7 +13,7 @@ static inline void ensureNotNpos(ARG_moduleid_t id)
 }
 
 UnpackedModule::UnpackedModule(EngineContext* context, std::shared_ptr<Module> source, moduleid_t moduleID)
-: context(context), symbolTable(moduleID)
+: context(context), symbolTable(std::make_shared<sym::Namespace>(moduleID))
 {
 	this->source = source;
 }
@@ -24,12 +25,12 @@ std::shared_ptr<Module> UnpackedModule::getSource() const
 
 const sym::Namespace& UnpackedModule::getSymbolTable() const
 {
-	return this->symbolTable;
+	return *this->symbolTable;
 }
 
 sym::Namespace& UnpackedModule::getSymbolTable()
 {
-	return this->symbolTable;
+	return *this->symbolTable;
 }
 
 static void declarePackage(sym::Namespace& _namespace, const Package& package)
@@ -43,7 +44,7 @@ static void declarePackage(sym::Namespace& _namespace, const Package& package)
 void UnpackedModule::declarePackages()
 {
 	for(const auto& package : this->source->getRootPackage().getChildren())
-		declarePackage(this->symbolTable, package);
+		declarePackage(*this->symbolTable, package);
 }
 
 void UnpackedModule::declareDependencies()
@@ -57,10 +58,8 @@ void UnpackedModule::declareDependencies()
 		sym::Namespace& src = sym::Namespace::assertSymbol(_src);
 		sym::Namespace& dst = sym::Namespace::assertSymbol(_dst);
 
-		for(const auto& entry : src.getSymbols())
-		{
-			dst.declareSymbol(entry.first, std::make_unique<sym::ReferenceSymbol>(entry.second->getLocator()));
-		}
+		// The target is mounted rather than copied entry by entry, so importing costs the same for any size
+		dst.mount(std::static_pointer_cast<sym::Namespace>(src.shared_from_this()));
 	}
 }
 
@@ -95,11 +94,43 @@ uint32_t EngineContext::unpackModule(std::shared_ptr<Module> module)
 	return moduleID;
 }
 
+void EngineContext::unpackModules(const std::vector<std::vector<std::shared_ptr<Module>>>& levels, uint32_t jobs)
+{
+	WorkScheduler scheduler(jobs);
+	for(const auto& level : levels)
+	{
+		std::vector<moduleid_t> moduleIDs;
+		for(std::shared_ptr<Module> module : level)
+			moduleIDs.push_back(unpackModule(module));
+		
+		std::vector<std::exception_ptr> exceptions(moduleIDs.size());
+		std::vector<WorkScheduler::task_t> tasks;
+		for(size_t i = 0 ; i < moduleIDs.size() ; ++i)
+		{
+			tasks.push_back([&exceptions, i, &module = getModule(moduleIDs[i])]() {
+				try
+				{ module.declarePackages(); }
+				catch(...)
+				{ exceptions[i] = std::current_exception(); }
+			});
+		}
+		scheduler.run(std::move(tasks));
+		
+		for(size_t i = 0 ; i < moduleIDs.size() ; ++i)
+		{
+			if(exceptions[i])
+				std::rethrow_exception(exceptions[i]);
+			getModule(moduleIDs[i]).declareDependencies();
+		}
+	}
+}
+
 void EngineContext::deleteModule(ARG_moduleid_t moduleID)
 {
 	UnpackedModule& module = getModule(moduleID);
-	this->registeredModules.erase(moduleID);
 	this->moduleFinder.erase(module.getSource()->getModulefile());
+	this->registeredModules.erase(moduleID);
+	this->locatorCache.clear();
 }
 
 void EngineContext::deleteModule(const URL& url)
@@ -107,6 +138,7 @@ void EngineContext::deleteModule(const URL& url)
 	moduleid_t moduleID = findModuleID(url);
 	this->registeredModules.erase(moduleID);
 	this->moduleFinder.erase(url);
+	this->locatorCache.clear();
 }
 
 bool EngineContext::hasModule(ARG_moduleid_t moduleID) const
@@ -152,3 +184,8 @@ UnpackedModule& EngineContext::getModule(const URL& url)
 {
 	return getModule(findModuleID(url));
 }
+
+sym::LocatorCache& EngineContext::getLocatorCache() const
+{
+	return this->locatorCache;
+}
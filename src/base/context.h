@@ -4,6 +4,7 @@
 #include "base/modules/module.h"
 #include "base/modules/xmlrules.h"
 #include "symbol/symbol.h"
+#include "symbol/cache.h"
 
 #include "base/context_incl.h"
 
@@ -14,7 +15,7 @@ namespace wckt::base
 		private:
 			EngineContext* context;
 			std::shared_ptr<Module> source;
-			sym::Namespace symbolTable;
+			std::shared_ptr<sym::Namespace> symbolTable;
 
 			UnpackedModule(EngineContext* context, std::shared_ptr<Module> source, moduleid_t moduleID);
 		public:
@@ -37,6 +38,8 @@ namespace wckt::base
 			uint32_t contextID;
 			std::map<moduleid_t, UnpackedModule> registeredModules;
 			std::unordered_map<URL, moduleid_t, URL::hasher_t> moduleFinder;
+			/* Filled by lookups through const contexts too, since it does not change what they resolve to */
+			mutable sym::LocatorCache locatorCache;
 			
 			moduleid_t nextModuleID;
 
@@ -47,6 +50,13 @@ namespace wckt::base
 			uint32_t getContextID() const;
 
 			RET_moduleid_t unpackModule(std::shared_ptr<Module> module);
+			/**
+			 * Unpacks and declares modules level by level, as grouped by DependencyResolver::computeTopologicalLevels.
+			 * Declaring packages only touches the module's own symbol table, so it runs on up to jobs threads within
+			 * a level. Declaring dependencies resolves locators through the shared locator cache and mounts into
+			 * other modules' namespaces, so it stays sequential. Rethrows the first error of a level.
+			 */
+			void unpackModules(const std::vector<std::vector<std::shared_ptr<Module>>>& levels, uint32_t jobs);
 			void deleteModule(ARG_moduleid_t moduleID);
 			void deleteModule(const URL& url);
 			
@@ -57,5 +67,7 @@ namespace wckt::base
 			const UnpackedModule& getModule(const URL& url) const;
 			UnpackedModule& getModule(ARG_moduleid_t moduleID);
 			UnpackedModule& getModule(const URL& url);
+
+			sym::LocatorCache& getLocatorCache() const;
     };
 }
@@ -1,4 +1,5 @@
 #include "base/engine.h"
+#include "base/runtime/bytecode.h"
 #include "include/exception.h"
 
 using namespace wckt;
@@ -7,13 +8,16 @@ using namespace wckt::base;
 std::map<uint32_t, std::unique_ptr<Engine>> Engine::instances;
 std::map<uint32_t, std::shared_ptr<EngineContext>> Engine::contexts;
 
+const size_t Engine::STACK_SIZE = 1 << 16;
+const uint32_t Engine::MAX_CALL_DEPTH = 1024;
+
 static inline void ensureInstance(const std::map<uint32_t, std::unique_ptr<Engine>>& instances, uint32_t contextID)
 {
 	if(instances.find(contextID) == instances.end())
 		throw ElementNotFoundError("No suitable instance found");
 }
 
-const Engine& Engine::startInstance(std::shared_ptr<EngineContext> context)
+Engine& Engine::startInstance(std::shared_ptr<EngineContext> context)
 {
 	if(instances.find(context->getContextID()) != instances.end())
 		throw BadStateError("Instance already running with this context");
@@ -25,13 +29,13 @@ const Engine& Engine::startInstance(std::shared_ptr<EngineContext> context)
 	return *instances[context->getContextID()];
 }
 
-const Engine& Engine::getInstance(uint32_t contextID)
+Engine& Engine::getInstance(uint32_t contextID)
 {
 	ensureInstance(instances, contextID);
 	return *instances[contextID];
 }
 
-const Engine& Engine::getInstance(const EngineContext& context)
+Engine& Engine::getInstance(const EngineContext& context)
 {
 	ensureInstance(instances, context.getContextID());
 	return *instances[context.getContextID()];
@@ -65,11 +69,343 @@ const EngineContext& Engine::getContext(uint32_t contextID)
 }
 
 Engine::Engine(const EngineContext& context)
+: statics(std::make_shared<Object>()), stack(new Value[STACK_SIZE]), callDepth(0), instructionCount(0),
+	inlineCacheStatistics{ 0, 0 }, satisfactionStatistics{ 0, 0 }
 {
 	this->contextID = context.getContextID();
+	this->sp = this->stack.get();
 }
 
 uint32_t Engine::getContextID() const
 {
 	return this->contextID;
 }
+
+/* Dotted signature of a locator, empty for the root of the module */
+static std::string getSignature(const sym::Locator& locator)
+{
+	return locator.length() == 0 ? "" : locator.toString();
+}
+
+static std::string join(const std::string& locator, std::string_view name)
+{
+	return locator.empty() ? std::string(name) : locator + "." + std::string(name);
+}
+
+std::shared_ptr<Object> Engine::getScope(std::string_view locator)
+{
+	std::shared_ptr<Object> scope = this->statics;
+	while(!locator.empty())
+	{
+		size_t pos = std::min(locator.find('.'), locator.length());
+		std::string_view name = locator.substr(0, pos);
+		locator.remove_prefix(std::min(pos + 1, locator.length()));
+
+		const Value* value = scope->findProperty(name);
+		if(value == nullptr || value->isNull())
+		{
+			auto child = std::make_shared<Object>();
+			scope->setProperty(name, Value::fromObject(child));
+			scope = child;
+		}
+		else if(value->getKind() == Value::OBJECT)
+			scope = value->getObjectPtr();
+		else throw ExecutionError("Static symbol " + std::string(name) + " is not a package or namespace");
+	}
+	return scope;
+}
+
+Value Engine::lookup(std::string_view locator) const
+{
+	Value value = Value::fromObject(this->statics);
+	for(std::string_view rest = locator ; !rest.empty() ; )
+	{
+		size_t pos = std::min(rest.find('.'), rest.length());
+		const Value* property = value.getKind() == Value::OBJECT ? value.getObject().findProperty(rest.substr(0, pos)) : nullptr;
+		if(property == nullptr)
+			throw ExecutionError("No static symbol " + std::string(locator));
+		value = *property;
+		rest.remove_prefix(std::min(pos + 1, rest.length()));
+	}
+	return value;
+}
+
+void Engine::declare(uint32_t assetIndex, const std::vector<opp_declaration_t>& declarations, Object& scope, const std::string& locator)
+{
+	const OPPFile& file = *this->assets[assetIndex]->file;
+	for(const auto& decl : declarations)
+	{
+		std::string name = decl.name == 0 ? "" : std::string(file.getUTF8(decl.name));
+		std::string declLocator = join(locator, name);
+		switch(decl.signature)
+		{
+			case OPPFile::DECL_TYPE:
+				this->types[declLocator] = { assetIndex, &decl, declLocator };
+				break;
+
+			case OPPFile::DECL_CONTRACT:
+			case OPPFile::DECL_TEMPLATE:
+			case OPPFile::DECL_PARTIAL_TEMPLATE:
+				this->types[declLocator] = { assetIndex, &decl, declLocator };
+				[[fallthrough]];
+			case OPPFile::DECL_NAMESPACE:
+			{
+				std::shared_ptr<Object> child = std::make_shared<Object>();
+				const Value* existing = scope.findProperty(name);
+				if(existing != nullptr && existing->getKind() == Value::OBJECT)
+					child = existing->getObjectPtr();
+				else scope.setProperty(name, Value::fromObject(child));
+				declare(assetIndex, decl.children, *child, declLocator);
+				break;
+			}
+
+			case OPPFile::DECL_CONSTRUCTOR:
+			case OPPFile::DECL_SWITCH_CONSTRUCTOR:
+			{
+				// Template constructors are unnamed and registered at the template's locator
+				std::string target = decl.name == 0 ? locator : declLocator;
+				runtime_constructor_t constructor = { .decoded = false, .assetIndex = assetIndex, .locator = target,
+					.origin = decl.name == 0 ? locator : "", .slotCount = 0 };
+
+				// Cases are only decoded when the constructor is first invoked
+				if(decl.signature == OPPFile::DECL_CONSTRUCTOR)
+				{
+					constructor.impls.push_back(decl.impl);
+					constructor.types.push_back(decl.type);
+				}
+				else for(const auto& _case : decl.children)
+				{
+					constructor.impls.push_back(_case.impl);
+					constructor.types.push_back(_case.type);
+				}
+				this->constructors[target] = std::move(constructor);
+				break;
+			}
+
+			case OPPFile::DECL_STATIC_PROPERTY:
+				scope.setProperty(name, Value());
+				break;
+		}
+	}
+}
+
+const Function& Engine::getFunction(uint32_t assetIndex, uint16_t index, const std::string& name)
+{
+	runtime_asset_t& asset = *this->assets[assetIndex];
+	if(index >= asset.functions.size())
+		throw FormatError("No constant #" + std::to_string(index) + " in OPP file " + asset.file->getURL().toString());
+	if(asset.functions[index] == nullptr)
+		asset.functions[index] = std::make_unique<Function>(*asset.file, assetIndex, index, name);
+	return *asset.functions[index];
+}
+
+Value Engine::getConstant(uint32_t assetIndex, uint16_t index)
+{
+	runtime_asset_t& asset = *this->assets[assetIndex];
+	const OPPFile& file = *asset.file;
+
+	// Literals and functions are decoded once, static symbols may be reassigned and are looked up every time
+	if(file.getConstantSignature(index) == OPPFile::CUTF8)
+		return lookup(file.getUTF8(index));
+	if(!asset.literals[index].isNull())
+		return asset.literals[index];
+
+	Value value;
+	switch(file.getConstantSignature(index))
+	{
+		case OPPFile::CFNLIT:
+			value = Value::fromFunction(getFunction(assetIndex, index, "<function #" + std::to_string(index) + ">"));
+			break;
+		case OPPFile::CUINTLIT:	value = Value::fromInteger(Value::UINT, file.getLiteralBits(index)); break;
+		case OPPFile::CINTLIT:	value = Value::fromInteger(Value::INT, file.getLiteralBits(index)); break;
+		case OPPFile::CULNGLIT:	value = Value::fromInteger(Value::ULONG, file.getLiteralBits(index)); break;
+		case OPPFile::CLNGLIT:	value = Value::fromInteger(Value::LONG, file.getLiteralBits(index)); break;
+		case OPPFile::CFLTLIT:
+		{
+			uint32_t raw = (uint32_t) file.getLiteralBits(index);
+			float real;
+			std::memcpy(&real, &raw, sizeof(real));
+			value = Value::fromReal(Value::FLOAT, real);
+			break;
+		}
+		case OPPFile::CDBLLIT:
+		{
+			uint64_t raw = file.getLiteralBits(index);
+			double real;
+			std::memcpy(&real, &raw, sizeof(real));
+			value = Value::fromReal(Value::DOUBLE, real);
+			break;
+		}
+		case OPPFile::CSTRLIT:	value = Value::fromString(file.getStringLiteral(index)); break;
+		default:
+			throw FormatError("Constant #" + std::to_string(index) + " of OPP file " + file.getURL().toString() + " cannot be loaded");
+	}
+	asset.literals[index] = value;
+	return value;
+}
+
+runtime_constructor_t& Engine::getConstructor(std::string_view locator)
+{
+	auto it = this->constructors.find(locator);
+	if(it == this->constructors.end())
+		throw ExecutionError("No constructor " + std::string(locator));
+
+	runtime_constructor_t& constructor = it->second;
+	if(!constructor.decoded)
+	{
+		// Verified as a whole so a failed case leaves the constructor undecoded
+		std::vector<const Function*> cases;
+		for(uint16_t impl : constructor.impls)
+		{
+			const Function& function = getFunction(constructor.assetIndex, impl, constructor.locator);
+			if(!cases.empty() && cases[0]->getArgCount() != function.getArgCount())
+				throw FormatError("Cases of constructor " + constructor.locator + " in OPP file "
+					+ this->assets[constructor.assetIndex]->file->getURL().toString() + " take different numbers of arguments");
+			cases.push_back(&function);
+		}
+		constructor.cases = std::move(cases);
+		constructor.decoded = true;
+	}
+	return constructor;
+}
+
+bool Engine::call(const Value& callee, Value* args, uint8_t argc, Value& result)
+{
+	if(callee.getKind() == Value::OBJECT)
+	{
+		const Value* call = callee.getObject().findProperty("call");
+		if(call == nullptr || call->getKind() != Value::FUNCTION)
+			throw ExecutionError("Object is not callable");
+		return call->getReceiver() == nullptr
+			? this->call(Value::fromFunction(call->getFunction(), callee.getObjectPtr()), args, argc, result)
+			: this->call(*call, args, argc, result);
+	}
+	if(callee.getKind() != Value::FUNCTION)
+		throw ExecutionError(Value::getKindName(callee.getKind()) + " value is not callable");
+
+	const Function& function = callee.getFunction();
+	if(argc != function.getArgCount())
+		throw ExecutionError("Function " + function.getName() + " takes " + std::to_string(function.getArgCount())
+			+ " arguments, but " + std::to_string(argc) + " were given");
+
+	Value self = callee.getReceiver() == nullptr ? Value() : Value::fromObject(callee.getReceiver());
+	if(!function.isNative())
+		return execute(function, self, args, result);
+
+	bool produced;
+	try
+	{
+		produced = function.getNative()(*this, self, args, result);
+	}
+	catch(...)
+	{
+		std::fill(args, args + argc, Value());
+		this->sp = args;
+		throw;
+	}
+	std::fill(args, args + argc, Value());
+	this->sp = args;
+	return produced;
+}
+
+void Engine::load(const sym::Locator& pckg, std::shared_ptr<const OPPFile> file)
+{
+	uint32_t assetIndex = this->assets.size();
+	auto asset = std::make_unique<runtime_asset_t>();
+	asset->file = file;
+	asset->pckg = getSignature(pckg);
+	asset->literals.resize(file->getConstantCount() + 1);
+	asset->functions.resize(file->getConstantCount() + 1);
+	asset->typeBase = this->assets.empty() ? 0
+		: this->assets.back()->typeBase + this->assets.back()->file->getConstantCount() + 1;
+	this->assets.push_back(std::move(asset));
+
+	// New declarations may change how type references resolve
+	this->satisfactionCache.clear();
+
+	const std::string& locator = this->assets[assetIndex]->pckg;
+	std::shared_ptr<Object> scope = getScope(locator);
+	declare(assetIndex, file->getDeclarations(), *scope, locator);
+
+	// The static initializer runs with the package as this
+	if(file->getInitializer() != 0)
+		invoke(Value::fromFunction(getFunction(assetIndex, file->getInitializer(), join(locator, "<init>")), scope), {});
+}
+
+void Engine::load(const sym::Locator& pckg, std::shared_ptr<const OPPFile> file, const URL& source)
+{
+	std::shared_ptr<URLBuffer> buffer = source.map();
+	if(!file->matchesSource(buffer->getView()))
+		throw BadStateError("OPP file " + file->getURL().toString() + " was not compiled from " + source.toString()
+			+ ", it needs to be compiled again");
+	load(pckg, file);
+}
+
+void Engine::defineNative(const sym::Locator& locator, uint8_t argCount, native_fn_t native)
+{
+	if(locator.length() == 0)
+		throw BadArgumentError("Native functions must be named");
+
+	std::vector<std::string> pckgs = locator.getPackages();
+	std::string name = pckgs.back();
+	pckgs.pop_back();
+
+	this->natives.push_back(std::make_unique<Function>(getSignature(locator), argCount, native));
+	getScope(getSignature(sym::Locator(pckgs)))->setProperty(name, Value::fromFunction(*this->natives.back()));
+}
+
+Value Engine::resolve(const sym::Locator& locator) const
+{
+	return lookup(getSignature(locator));
+}
+
+Value Engine::invoke(const Value& callee, const std::vector<Value>& args)
+{
+	if(args.size() > UINT8_MAX)
+		throw BadArgumentError("Too many arguments");
+	if(this->sp + args.size() > this->stack.get() + STACK_SIZE)
+		throw ExecutionError("Stack overflow");
+
+	Value* base = this->sp;
+	std::copy(args.begin(), args.end(), base);
+	this->sp = base + args.size();
+
+	Value result;
+	try
+	{
+		this->call(callee, base, args.size(), result);
+	}
+	catch(...)
+	{
+		// Frames clean up their own slots, only the arguments may be left if the call was rejected
+		std::fill(base, base + args.size(), Value());
+		this->sp = base;
+		throw;
+	}
+	return result;
+}
+
+Value Engine::run(const sym::Locator& entry)
+{
+	return invoke(resolve(entry), {});
+}
+
+Value Engine::run(const EntryComponent& entry)
+{
+	return run(entry.getLocator());
+}
+
+uint64_t Engine::getInstructionCount() const
+{
+	return this->instructionCount;
+}
+
+runtime_cache_stats_t Engine::getInlineCacheStatistics() const
+{
+	return this->inlineCacheStatistics;
+}
+
+runtime_cache_stats_t Engine::getSatisfactionStatistics() const
+{
+	return this->satisfactionStatistics;
+}
@@ -2,9 +2,84 @@
 
 #include "include/definitions.h"
 #include "base/context.h"
+#include "base/modules/module.h"
+#include "base/runtime/opp.h"
+#include "base/runtime/value.h"
+#include <set>
 
 namespace wckt::base
 {
+	/* Runtime state of a loaded OPP file */
+	typedef struct
+	{
+		std::shared_ptr<const OPPFile> file;
+		/* Locator of the package the asset declares its static symbols in */
+		std::string pckg;
+		/* Literal constants, decoded on first use */
+		std::vector<Value> literals;
+		/* Function literals, verified on first use */
+		std::vector<std::unique_ptr<Function>> functions;
+		/* Global ID of the asset's constant #0, type constants are identified by adding their index */
+		uint32_t typeBase;
+	} runtime_asset_t;
+
+	/* Constructor declared in a loaded asset */
+	typedef struct
+	{
+		/* Implementation of every case, which all take the same number of arguments, empty until decoded */
+		std::vector<const Function*> cases;
+		/* CFNLIT of every case, decoded into cases by getConstructor */
+		std::vector<uint16_t> impls;
+		/* Whether cases were decoded, which leaves them empty for switch constructors without cases */
+		bool decoded;
+		/* CTYPE of every case, used to select the case matching the arguments */
+		std::vector<uint16_t> types;
+		uint32_t assetIndex;
+		std::string locator;
+		/* Locator of the template this constructor initializes, or empty */
+		std::string origin;
+		/* Slot count of the last object initialized, preallocated for the next since they share a shape */
+		uint32_t slotCount;
+	} runtime_constructor_t;
+
+	/* Type, contract or template declared in a loaded asset */
+	typedef struct
+	{
+		uint32_t assetIndex;
+		const opp_declaration_t* declaration;
+		std::string locator;
+	} runtime_type_t;
+
+	/* Check of a value left to satisfies once the shape of the object holding it was checked */
+	typedef struct
+	{
+		enum : uint8_t
+		{
+			/* The property in slot satisfies a CTYPE of an asset */
+			SLOT_TYPE,
+			/* The property in slot is a function taking argc arguments */
+			SLOT_CALLABLE,
+			/* The object itself satisfies a CTYPE of an asset, as for type declarations and extended types */
+			OBJECT_TYPE,
+			/* The object or one of its properties is a function taking argc arguments */
+			OBJECT_CASE
+		} kind;
+		uint8_t argc;
+		uint16_t type;
+		uint32_t slot;
+		uint32_t assetIndex;
+	} runtime_check_t;
+
+	/* Alternatives of a type left for objects of a shape, each a list of checks which must all hold, empty if none is */
+	typedef std::vector<std::vector<runtime_check_t>> runtime_plan_t;
+
+	/* Hit and miss counts of a runtime cache */
+	typedef struct
+	{
+		uint64_t hits;
+		uint64_t misses;
+	} runtime_cache_stats_t;
+
     class Engine
     {
         private:
@@ -12,10 +87,14 @@ namespace wckt::base
 			static std::map<uint32_t, std::shared_ptr<EngineContext>> contexts;
 			
 		public:
-			static const Engine& startInstance(std::shared_ptr<EngineContext> context);
+			/* Operand stack slots shared by every frame, and maximum nesting of calls */
+			static const size_t STACK_SIZE;
+			static const uint32_t MAX_CALL_DEPTH;
+			
+			static Engine& startInstance(std::shared_ptr<EngineContext> context);
 			
-			static const Engine& getInstance(uint32_t contextID);
-			static const Engine& getInstance(const EngineContext& context);
+			static Engine& getInstance(uint32_t contextID);
+			static Engine& getInstance(const EngineContext& context);
 			
 			static void terminateInstance(uint32_t contextID);
 			static void terminateInstance(const EngineContext& context);
@@ -27,11 +106,87 @@ namespace wckt::base
 		private:
 			uint32_t contextID;
 			
+			/* Root of the static symbols, whose properties are the top-level packages */
+			std::shared_ptr<Object> statics;
+			std::vector<std::unique_ptr<runtime_asset_t>> assets;
+			std::vector<std::unique_ptr<Function>> natives;
+			std::map<std::string, runtime_constructor_t, std::less<>> constructors;
+			std::map<std::string, runtime_type_t, std::less<>> types;
+			
+			std::unique_ptr<Value[]> stack;
+			Value* sp;
+			uint32_t callDepth;
+			uint64_t instructionCount;
+			runtime_cache_stats_t inlineCacheStatistics;
+			/* What objects of a shape need to satisfy a type, by shape ID in the upper and type ID in the lower half */
+			std::unordered_map<uint64_t, std::shared_ptr<const runtime_plan_t>> satisfactionCache;
+			runtime_cache_stats_t satisfactionStatistics;
+			
 			Engine(const EngineContext& context);
 			
+			/* Static object at a dotted locator, declaring missing packages and namespaces */
+			std::shared_ptr<Object> getScope(std::string_view locator);
+			Value lookup(std::string_view locator) const;
+			void declare(uint32_t assetIndex, const std::vector<opp_declaration_t>& declarations, Object& scope, const std::string& locator);
+			
+			const Function& getFunction(uint32_t assetIndex, uint16_t index, const std::string& name);
+			Value getConstant(uint32_t assetIndex, uint16_t index);
+			runtime_constructor_t& getConstructor(std::string_view locator);
+			/* First case of a constructor whose argument types are satisfied by args */
+			const Function* selectCase(const runtime_constructor_t& constructor, const Value* args);
+			
+			/* Calls callee with the argc values at args, which must be the top of the operand stack */
+			bool call(const Value& callee, Value* args, uint8_t argc, Value& result);
+			/* Interpreter loop, args are the first local slots of the new frame */
+			bool execute(const Function& function, const Value& self, Value* args, Value& result);
+			Value invokeOperator(uint8_t opcode, Value* operands);
+			bool isTruthy(const Value& value);
+			Value getProperty(const Value& value, std::string_view name) const;
+			
+			typedef struct
+			{
+				/* Pairs of object and type identities assumed to hold while checking recursive types */
+				std::set<std::pair<const void*, const void*>> assumptions;
+			} satisfaction_state_t;
+			
+			bool satisfiesType(const Value& value, uint32_t assetIndex, uint16_t type, satisfaction_state_t& state);
+			/* Primitives and functions are checked unit by unit, objects through the plan of their shape */
+			bool satisfiesUnits(const Value& value, uint32_t assetIndex, std::string_view units, satisfaction_state_t& state);
+			bool satisfiesReference(const Value& value, uint32_t assetIndex, std::string_view locator, satisfaction_state_t& state);
+			std::shared_ptr<const runtime_plan_t> getPlan(const Shape& shape, uint32_t assetIndex, uint16_t type);
+			/* Appends the checks of a conjunction of units to checks, returns false if the shape rules it out */
+			bool planUnits(const Shape& shape, uint32_t assetIndex, std::string_view units, std::vector<runtime_check_t>& checks);
+			bool planReference(const Shape& shape, std::string_view locator, std::vector<runtime_check_t>& checks);
+			bool runCheck(const Value& value, const runtime_check_t& check, satisfaction_state_t& state);
+			
 		public:
 			~Engine() = default;
 			
 			uint32_t getContextID() const;
+			
+			/* Declares the static symbols of an asset in its package and runs its static initializer */
+			void load(const sym::Locator& pckg, std::shared_ptr<const OPPFile> file);
+			/* Same, but throws BadStateError without loading anything if the file was not compiled from source */
+			void load(const sym::Locator& pckg, std::shared_ptr<const OPPFile> file, const URL& source);
+			/* Declares a native function as a static property */
+			void defineNative(const sym::Locator& locator, uint8_t argCount, native_fn_t native);
+			
+			/* Value of a static symbol, throws ExecutionError if there is none */
+			Value resolve(const sym::Locator& locator) const;
+			/* Invokes a callable value, returns null for void functions */
+			Value invoke(const Value& callee, const std::vector<Value>& args);
+			/* Invokes the function at a static locator (usually the module entry point) without arguments */
+			Value run(const sym::Locator& entry);
+			Value run(const EntryComponent& entry);
+			
+			/* Whether a value satisfies a CTYPE constant of a loaded asset */
+			bool satisfies(const Value& value, uint32_t assetIndex, uint16_t type);
+			
+			/* Number of instructions executed so far, e.g. to measure instructions per second */
+			uint64_t getInstructionCount() const;
+			/* Hit and miss counts of getprop and setprop inline caches, to check hot code stays monomorphic */
+			runtime_cache_stats_t getInlineCacheStatistics() const;
+			/* Hit and miss counts of the cache of shape-level satisfies and checktype plans */
+			runtime_cache_stats_t getSatisfactionStatistics() const;
     };
 }
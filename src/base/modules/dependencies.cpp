@@ -1,9 +1,9 @@
 #include "base/modules/dependencies.h"
+#include "base/modules/manifest.h"
 #include "base/xmlparser.h"
 #include "error/error.h"
-#include <queue>
-#include <list>
 #include <unordered_set>
+#include <algorithm>
 
 using namespace wckt;
 using namespace wckt::base;
@@ -43,26 +43,87 @@ modgenfunc_t DependencyResolver::genModuleBuilderFunction(std::shared_ptr<Module
 	};
 }
 
-static void resolveDependencies(std::shared_ptr<Module> module, DependencyResolver::modulemap_t& modulemap, const modgenfunc_t& genfunc)
+modgenfunc_t DependencyResolver::genCachedFunction(std::shared_ptr<ManifestCache> cache, const modgenfunc_t& genfunc)
 {
-	err::ErrorSentinel sentinel(nullptr, err::ErrorSentinel::THROW, [module](err::PTR_ErrorContextLayer ptr) {
-		return _MAKE_ERR(DependencyContextLayer, std::move(ptr), module->getModulefile());
-	});
+	return [cache, genfunc](const URL& url) {
+		return cache->getModule(url, genfunc);
+	};
+}
+
+namespace
+{
+	typedef struct
+	{
+		URL url;
+		/* Module whose dependency led to the URL, for the error context */
+		const Module* dependent;
+		std::shared_ptr<Module> module;
+		std::exception_ptr exception;
+	} fetch_t;
+	
+	typedef std::unordered_map<const Module*, const Module*> dependentmap_t;
+}
+
+/* Rethrows the error of a failed fetch with the chain of modules that led to it, as the depth-first resolver did */
+[[noreturn]] static void raiseFetchError(const fetch_t& fetch, const dependentmap_t& dependents)
+{
+	err::PTR_ErrorContextLayer error;
+	try
+	{ std::rethrow_exception(fetch.exception); }
+	catch(const IOError& e) { error = _MAKE_STD_ERR(e.what()); }
+	catch(err::WickitError& e) { error = e.releaseTop(); }
 	
-	for(const auto& dep : module->getDependencies())
+	for(const Module* module = fetch.dependent ; module ; module = dependents.at(module))
+		error = _MAKE_ERR(DependencyContextLayer, std::move(error), module->getModulefile());
+	throw err::WickitError(std::move(error));
+}
+
+/**
+ * Discovers dependencies breadth first. Each wave fetches every URL that the previous wave depends on
+ * and that is not registered yet, one task per URL, and the results are registered on the calling thread
+ * once the wave is done so the registry needs no lock.
+ */
+static void resolveDependencies(std::shared_ptr<Module> root, DependencyResolver::modulemap_t& modulemap,
+	const modgenfunc_t& genfunc, uint32_t jobs)
+{
+	WorkScheduler scheduler(jobs);
+	dependentmap_t dependents = { { root.get(), nullptr } };
+	
+	std::vector<std::shared_ptr<Module>> wave = { root };
+	while(!wave.empty())
 	{
-		if(modulemap.find(dep.getModuleURL()) == modulemap.end())
+		std::vector<fetch_t> fetches;
+		std::unordered_set<URL, URL::hasher_t> pending;
+		for(const auto& module : wave)
+			for(const auto& dep : module->getDependencies())
+				if(modulemap.find(dep.getModuleURL()) == modulemap.end() && pending.insert(dep.getModuleURL()).second)
+					fetches.push_back({ dep.getModuleURL(), module.get(), nullptr, nullptr });
+		
+		std::vector<WorkScheduler::task_t> tasks;
+		for(fetch_t& fetch : fetches)
 		{
-			sentinel.guard<IOError>([&genfunc, &modulemap, &dep](err::ErrorSentinel&) {
-				std::shared_ptr<Module> newModule = genfunc(dep.getModuleURL());
-				modulemap[dep.getModuleURL()] = newModule;
-				resolveDependencies(newModule, modulemap, genfunc);
+			tasks.push_back([&fetch, &genfunc]() {
+				try
+				{ fetch.module = genfunc(fetch.url); }
+				catch(...)
+				{ fetch.exception = std::current_exception(); }
 			});
 		}
+		scheduler.run(std::move(tasks));
+		
+		wave.clear();
+		for(fetch_t& fetch : fetches)
+		{
+			if(fetch.exception)
+				raiseFetchError(fetch, dependents);
+			modulemap[fetch.url] = fetch.module;
+			dependents[fetch.module.get()] = fetch.dependent;
+			wave.push_back(fetch.module);
+		}
 	}
 }
 
-DependencyResolver::DependencyResolver(const URL& moduleURL, const modgenfunc_t& genfunc)
+DependencyResolver::DependencyResolver(const URL& moduleURL, const modgenfunc_t& genfunc, uint32_t jobs)
 {
 	err::ErrorSentinel sentinel(nullptr, err::ErrorSentinel::THROW, err::ErrorSentinel::NO_CONTEXT_FN);
 	
@@ -70,17 +131,17 @@ DependencyResolver::DependencyResolver(const URL& moduleURL, const modgenfunc_t&
 	{
 		std::shared_ptr<Module> module = genfunc(moduleURL);
 		this->moduleRegistry[moduleURL] = module;
-		resolveDependencies(module, this->moduleRegistry, genfunc);
+		resolveDependencies(module, this->moduleRegistry, genfunc, jobs);
 	}
 	catch(err::WickitError& e) { sentinel.raise(e.releaseTop()); }
 	catch(const IOError& e) { sentinel.raise(e); }
 }
 
-DependencyResolver::DependencyResolver(const Module& module, const URL& moduleOrigin, const modgenfunc_t& genfunc)
+DependencyResolver::DependencyResolver(const Module& module, const URL& moduleOrigin, const modgenfunc_t& genfunc, uint32_t jobs)
 {
 	std::shared_ptr<Module> modulePtr = std::make_shared<Module>(module);
 	this->moduleRegistry[moduleOrigin] = modulePtr;
-	resolveDependencies(modulePtr, this->moduleRegistry, genfunc);
+	resolveDependencies(modulePtr, this->moduleRegistry, genfunc, jobs);
 }
 
 const DependencyResolver::modulemap_t& DependencyResolver::getModuleRegistry() const
@@ -88,72 +149,99 @@ const DependencyResolver::modulemap_t& DependencyResolver::getModuleRegistry() c
 	return this->moduleRegistry;
 }
 
-std::vector<std::shared_ptr<Module>> DependencyResolver::computeTopologicalOrder() const
+/* Follows unsorted dependencies from an unsorted module until one repeats, as each has at least one */
+static std::vector<URL> findCycle(const std::vector<std::shared_ptr<Module>>& modules,
+	const std::vector<std::vector<uint32_t>>& dependencies, const std::vector<uint32_t>& unresolved)
 {
-	// Define data structures
-	struct unready_node_t
-	{
-		std::shared_ptr<Module> module;
-		std::unordered_set<std::shared_ptr<Module>> deps;
-	};
-	
-	std::queue<std::shared_ptr<Module>> ready;
-	std::list<unready_node_t> unready;
+	const uint32_t unvisited = (uint32_t) -1;
+	std::vector<uint32_t> position(modules.size(), unvisited);
+	std::vector<uint32_t> path;
 	
-	std::vector<std::shared_ptr<Module>> topologicalOrder;
+	uint32_t i = std::find_if(unresolved.begin(), unresolved.end(), [](uint32_t count) { return count > 0; }) - unresolved.begin();
+	while(position[i] == unvisited)
+	{
+		position[i] = path.size();
+		path.push_back(i);
+		i = *std::find_if(dependencies[i].begin(), dependencies[i].end(), [&unresolved](uint32_t dep) { return unresolved[dep] > 0; });
+	}
 	
-	// Initialization
+	std::vector<URL> cycle;
+	for(size_t k = position[i] ; k < path.size() ; ++k)
+		cycle.push_back(modules[path[k]]->getModulefile());
+	cycle.push_back(modules[i]->getModulefile());
+	return cycle;
+}
+
+std::vector<std::vector<std::shared_ptr<Module>>> DependencyResolver::computeTopologicalLevels() const
+{
+	// Index modules, with edges both to their dependencies and back from them
+	std::vector<std::shared_ptr<Module>> modules;
+	std::unordered_map<const Module*, uint32_t> indices;
 	for(const auto& entry : this->moduleRegistry)
 	{
-		if(entry.second->getDependencies().size() == 0)
-			ready.push(entry.second);
-		else
+		indices.emplace(entry.second.get(), modules.size());
+		modules.push_back(entry.second);
+	}
+	
+	std::vector<std::vector<uint32_t>> dependencies(modules.size());
+	std::vector<std::vector<uint32_t>> dependents(modules.size());
+	/* Dependencies of each module not sorted yet */
+	std::vector<uint32_t> unresolved(modules.size(), 0);
+	for(uint32_t i = 0 ; i < modules.size() ; ++i)
+	{
+		for(const auto& dep : modules[i]->getDependencies())
 		{
-			unready_node_t node;
-			node.module = entry.second;
-			for(const auto& dep : entry.second->getDependencies())
-				node.deps.insert(this->moduleRegistry.at(dep.getModuleURL()));
-			unready.push_back(node);
+			uint32_t j = indices.at(this->moduleRegistry.at(dep.getModuleURL()).get());
+			dependencies[i].push_back(j);
+			dependents[j].push_back(i);
+			unresolved[i]++;
 		}
 	}
 	
-	// Algorithm
-	while(!ready.empty())
+	// Kahn's algorithm, one level at a time, so a module lands one level past its deepest dependency
+	std::vector<std::vector<std::shared_ptr<Module>>> levels;
+	std::vector<uint32_t> level, next;
+	for(uint32_t i = 0 ; i < modules.size() ; ++i)
+		if(unresolved[i] == 0)
+			level.push_back(i);
+	
+	size_t sorted = 0;
+	while(!level.empty())
 	{
-		// Take next ready node
-		std::shared_ptr<Module> next = ready.front();
-		ready.pop();
-		
-		// Insert it at tail of topological order
-		topologicalOrder.push_back(next);
-		
-		// Remove node as dependency from all unready nodes
-		for(auto it = unready.begin() ; it != unready.end() ;)
+		levels.emplace_back();
+		for(uint32_t i : level)
 		{
-			unready_node_t& node = *it;
-			if(node.deps.find(next) != node.deps.end())
-			{
-				node.deps.erase(next);
-				// If the node has no more dependencies, move it to ready
-				if(node.deps.empty())
-				{
-					ready.push(node.module);
-					it = unready.erase(it);
-				}
-				else ++it;
-			}
-			else ++it;
+			levels.back().push_back(modules[i]);
+			for(uint32_t j : dependents[i])
+				if(--unresolved[j] == 0)
+					next.push_back(j);
 		}
+		sorted += level.size();
+		level.swap(next);
+		next.clear();
 	}
 	
-	// Cyclic dependency check
-	if(!unready.empty())
-		throw CyclicDependencyError();
-	
-	// Return output
+	if(sorted < modules.size())
+		throw CyclicDependencyError(findCycle(modules, dependencies, unresolved));
+	return levels;
+}
+
+std::vector<std::shared_ptr<Module>> DependencyResolver::computeTopologicalOrder() const
+{
+	std::vector<std::shared_ptr<Module>> topologicalOrder;
+	for(auto& level : computeTopologicalLevels())
+		topologicalOrder.insert(topologicalOrder.end(), level.begin(), level.end());
 	return topologicalOrder;
 }
 
-CyclicDependencyError::CyclicDependencyError()
-: APIError("Module dependency tree contains cyclic dependencies")
+static std::string cycleString(const std::vector<URL>& cycle)
+{
+	std::string str;
+	for(const auto& url : cycle)
+		str += (str.empty() ? "" : " -> ") + url.toString();
+	return str;
+}
+
+CyclicDependencyError::CyclicDependencyError(const std::vector<URL>& cycle)
+: APIError("Module dependency tree contains a cycle: " + cycleString(cycle)), cycle(cycle)
 {}
@@ -5,16 +5,21 @@
 #include "base/modules/module.h"
 #include "base/modules/xmlrules.h"
 #include "include/exception.h"
+#include "include/scheduler.h"
 
 namespace wckt::base
 {
 	typedef std::function<std::shared_ptr<Module>(const URL&)> modgenfunc_t;
 	
+	class ManifestCache;
+	
 	class DependencyResolver
 	{
 		public:
 			static modgenfunc_t modgenfuncDefault();
 			static modgenfunc_t genModuleBuilderFunction(std::shared_ptr<ModuleBuilder> builder);
+			/* Goes through the manifest cache, only calling genfunc for modulefiles without a valid manifest */
+			static modgenfunc_t genCachedFunction(std::shared_ptr<ManifestCache> cache, const modgenfunc_t& genfunc = modgenfuncDefault());
 			
 			typedef std::unordered_map<URL, std::shared_ptr<Module>, URL::hasher_t> modulemap_t;
 			
@@ -22,18 +27,27 @@ namespace wckt::base
 			modulemap_t moduleRegistry;
 			
 		public:
-			DependencyResolver(const URL& moduleURL, const modgenfunc_t& genfunc = modgenfuncDefault());
-			DependencyResolver(const Module& module, const URL& moduleOrigin, const modgenfunc_t& genfunc = modgenfuncDefault());
+			/* Modulefiles are fetched and parsed on up to jobs threads, so genfunc must be safe to call concurrently */
+			DependencyResolver(const URL& moduleURL, const modgenfunc_t& genfunc = modgenfuncDefault(),
+				uint32_t jobs = WorkScheduler::getDefaultConcurrency());
+			DependencyResolver(const Module& module, const URL& moduleOrigin, const modgenfunc_t& genfunc = modgenfuncDefault(),
+				uint32_t jobs = WorkScheduler::getDefaultConcurrency());
 			~DependencyResolver() = default;
 			
 			const modulemap_t& getModuleRegistry() const;
 			
+			/* Both throw a CyclicDependencyError naming one cycle if there is any */
 			std::vector<std::shared_ptr<Module>> computeTopologicalOrder() const;
+			/* Modules grouped so that each only depends on modules of earlier levels, in topological order */
+			std::vector<std::vector<std::shared_ptr<Module>>> computeTopologicalLevels() const;
 	};
 	
 	struct CyclicDependencyError : public APIError
 	{
-		CyclicDependencyError();
+		/* Modulefiles along the cycle, each depending on the next, the first one repeated at the end */
+		const std::vector<URL> cycle;
+		
+		CyclicDependencyError(const std::vector<URL>& cycle);
 		~CyclicDependencyError() = default;
 	};
 }
@@ -0,0 +1,385 @@
+#include "base/modules/manifest.h"
+#include "include/checksum.h"
+#include "include/exception.h"
+#include <thread>
+
+#ifdef _WIN32
+	#include <process.h>
+	#define getpid _getpid
+#else
+	#include <unistd.h>
+#endif
+
+using namespace wckt;
+using namespace wckt::base;
+
+#define MANIFEST_SIGNATURE	0x4e414d57	/* "WMAN" */
+
+namespace
+{
+	typedef struct
+	{
+		uint32_t signature;
+		uint16_t majorVersion;
+		uint16_t minorVersion;
+		modulefile_stamp_t modulefile;
+		uint64_t bodyLength;
+	} manifest_header_t;
+
+	enum component_kind_t : uint8_t
+	{
+		COMPONENT_BUILD,
+		COMPONENT_ENTRY
+	};
+
+	/* Thrown when the manifest format cannot represent a module, which is then left uncached */
+	_MAKE_API_ERROR(UncacheableModuleError)
+
+	/**
+	 * Appends the body of a manifest. URLs are written as their protocol and source, and whether their
+	 * parent is the modulefile, as relative URLs of modulefiles always are. Reading them back against the
+	 * modulefile being loaded resolves them exactly as parsing the modulefile again would.
+	 */
+	struct writer_t
+	{
+		const URL& modulefile;
+		std::string data;
+
+		void u8(uint8_t value) { this->data.push_back((char) value); }
+		void u32(uint32_t value) { this->data.append((const char*) &value, sizeof(value)); }
+
+		void string(std::string_view value)
+		{
+			if(value.length() > UINT32_MAX)
+				throw UncacheableModuleError("String too long for a manifest");
+			u32(value.length());
+			this->data.append(value);
+		}
+
+		void url(const URL& value)
+		{
+			if(value.getParent() != nullptr && *value.getParent() != this->modulefile)
+				throw UncacheableModuleError("URL relative to another resource than its modulefile");
+			string(value.isVoid() ? "" : URL::getProtocolName(value.getProtocol()));
+			string(value.getSource());
+			u8(value.getParent() != nullptr);
+		}
+
+		void locator(const sym::Locator& value)
+		{
+			u32(value.length());
+			for(atom_t atom : value.getAtoms())
+				string(AtomTable::getString(atom));
+		}
+
+		void package(const Package& value)
+		{
+			string(value.getName());
+			u8(value.getVisibility().getValue());
+			u32(value.getChildren().size());
+			for(const auto& child : value.getChildren())
+				package(child);
+			u32(value.getAssets().size());
+			for(const auto& asset : value.getAssets())
+				url(asset);
+		}
+
+		void module(const Module& value)
+		{
+			u32(value.getDependencies().size());
+			for(const auto& dep : value.getDependencies())
+			{
+				url(dep.getModuleURL());
+				locator(dep.getTarget());
+				locator(dep.getContainer());
+				u8(dep.isBundle());
+			}
+
+			package(value.getRootPackage());
+
+			u32(value.getComponents().size());
+			for(const auto& entry : value.getComponents())
+			{
+				string(entry.first);
+				if(const BuildComponent* build = dynamic_cast<const BuildComponent*>(entry.second.get()))
+				{
+					u8(COMPONENT_BUILD);
+					u32(build->getMountPoints().size());
+					for(const auto& mount : build->getMountPoints())
+					{
+						locator(mount.first);
+						url(mount.second);
+					}
+				}
+				else if(const EntryComponent* entryComponent = dynamic_cast<const EntryComponent*>(entry.second.get()))
+				{
+					u8(COMPONENT_ENTRY);
+					locator(entryComponent->getLocator());
+				}
+				else throw UncacheableModuleError("Unknown component \'" + entry.first + "\'");
+			}
+		}
+	};
+
+	/* Bounds-checked cursor over the body of a manifest */
+	struct reader_t
+	{
+		const URL& modulefile;
+		std::shared_ptr<URL> parent;
+		std::string_view data;
+		size_t pos;
+
+		const char* take(size_t count)
+		{
+			if(count > this->data.length() - this->pos)
+				throw FormatError("Truncated manifest of " + this->modulefile.toString());
+			this->pos += count;
+			return this->data.data() + this->pos - count;
+		}
+
+		uint8_t u8() { return *take(1); }
+
+		uint32_t u32()
+		{
+			uint32_t value;
+			std::memcpy(&value, take(sizeof(value)), sizeof(value));
+			return value;
+		}
+
+		/* Element count, checked against the bytes left so corrupt counts never allocate much */
+		uint32_t count()
+		{
+			uint32_t value = u32();
+			if(value > this->data.length() - this->pos)
+				throw FormatError("Invalid count in manifest of " + this->modulefile.toString());
+			return value;
+		}
+
+		std::string_view string()
+		{
+			uint32_t length = u32();
+			return std::string_view(take(length), length);
+		}
+
+		URL url()
+		{
+			std::string protocol(string());
+			std::string source(string());
+			std::shared_ptr<URL> parent = u8() ? this->parent : nullptr;
+			if(protocol.empty())
+				return URL();
+
+			auto it = URL::knownProtocols.find(protocol);
+			if(it == URL::knownProtocols.end())
+				throw FormatError("Unknown protocol in manifest of " + this->modulefile.toString());
+			return URL(it->second, source, parent);
+		}
+
+		sym::Locator locator()
+		{
+			std::vector<std::string> pckgs(count());
+			for(auto& pckg : pckgs)
+				pckg = string();
+			return sym::Locator(pckgs);
+		}
+
+		Package package()
+		{
+			std::string name(string());
+			uint8_t visibility = u8();
+			if(visibility > type::Visibility::PUBLIC)
+				throw FormatError("Invalid visibility in manifest of " + this->modulefile.toString());
+
+			std::vector<Package> children(count());
+			for(auto& child : children)
+				child = package();
+			std::vector<URL> assets(count());
+			for(auto& asset : assets)
+				asset = url();
+			return Package(name, type::Visibility((type::Visibility::level_t) visibility), children, assets);
+		}
+
+		std::shared_ptr<Module> module()
+		{
+			std::vector<ModuleDependency> dependencies;
+			for(uint32_t i = u32() ; i > 0 ; --i)
+			{
+				URL moduleURL = url();
+				sym::Locator target = locator();
+				sym::Locator container = locator();
+				dependencies.emplace_back(moduleURL, target, container, u8() != 0);
+			}
+
+			Package rootPackage = package();
+
+			std::map<std::string, std::unique_ptr<ModuleComponent>> components;
+			for(uint32_t i = u32() ; i > 0 ; --i)
+			{
+				std::string name(string());
+				switch(u8())
+				{
+					case COMPONENT_BUILD:
+					{
+						std::map<sym::Locator, URL> mountPoints;
+						for(uint32_t j = u32() ; j > 0 ; --j)
+						{
+							sym::Locator mountLocator = locator();
+							mountPoints[mountLocator] = url();
+						}
+						components[name] = std::make_unique<BuildComponent>(mountPoints);
+						break;
+					}
+					case COMPONENT_ENTRY:
+						components[name] = std::make_unique<EntryComponent>(locator());
+						break;
+					default:
+						throw FormatError("Unknown component in manifest of " + this->modulefile.toString());
+				}
+			}
+
+			return std::make_shared<Module>(this->modulefile, dependencies, rootPackage, components);
+		}
+	};
+}
+
+static uint64_t hashModulefile(const URL& modulefile)
+{
+	std::shared_ptr<URLBuffer> buffer = modulefile.map();
+	std::string_view contents = buffer->getView();
+	return fnv1a64(contents.data(), contents.length());
+}
+
+ManifestCache::ManifestCache(const std::filesystem::path& directory)
+: directory(directory), hits(0), misses(0)
+{}
+
+std::filesystem::path ManifestCache::getDirectory() const
+{
+	return this->directory;
+}
+
+std::filesystem::path ManifestCache::getEntryPath(const URL& modulefile) const
+{
+	std::string_view key = modulefile.getKey();
+	std::stringstream ss;
+	ss << std::hex << fnv1a64(key.data(), key.length()) << std::dec << "-v" << WCKT_MAJ_VER << "." << WCKT_MIN_VER << ".wman";
+	return this->directory / ss.str();
+}
+
+std::shared_ptr<Module> ManifestCache::loadModule(const URL& modulefile, modulefile_stamp_t& stamp) const
+{
+	std::error_code ec;
+	std::filesystem::path path = getEntryPath(modulefile);
+	if(!std::filesystem::is_regular_file(path, ec))
+		return nullptr;
+
+	// Large manifests are mapped, and decoded straight from the mapping
+	std::shared_ptr<URLBuffer> buffer = URL(URL::FILE_PROTOCOL, path.string()).map();
+	std::string_view data = buffer->getView();
+
+	manifest_header_t header;
+	if(data.length() < sizeof(header))
+		return nullptr;
+	std::memcpy(&header, data.data(), sizeof(header));
+	if(header.signature != MANIFEST_SIGNATURE || header.majorVersion != WCKT_MAJ_VER || header.minorVersion != WCKT_MIN_VER
+		|| header.bodyLength != data.length() - sizeof(header) || header.modulefile.length != stamp.length)
+		return nullptr;
+
+	// A modulefile touched without being changed still matches by contents
+	if(header.modulefile.time != stamp.time)
+	{
+		stamp.hash = hashModulefile(modulefile);
+		if(header.modulefile.hash != stamp.hash)
+			return nullptr;
+	}
+
+	reader_t reader = { modulefile, std::make_shared<URL>(modulefile), data.substr(sizeof(header)), 0 };
+	std::shared_ptr<Module> module = reader.module();
+	return reader.pos == reader.data.length() ? module : nullptr;
+}
+
+void ManifestCache::storeModule(const Module& module, const modulefile_stamp_t& stamp) const
+{
+	URL modulefile = module.getModulefile();
+	writer_t writer = { modulefile };
+	try
+	{ writer.module(module); }
+	catch(const UncacheableModuleError&)
+	{ return; }
+
+	manifest_header_t header = {
+		.signature = MANIFEST_SIGNATURE,
+		.majorVersion = WCKT_MAJ_VER,
+		.minorVersion = WCKT_MIN_VER,
+		.modulefile = stamp,
+		.bodyLength = writer.data.length()
+	};
+
+	// Write to a private file first so concurrent engines never see a partial manifest, named after the process
+	// as well as the thread since thread IDs of different processes may be equal
+	std::filesystem::path path = getEntryPath(modulefile);
+	std::stringstream tmpName;
+	tmpName << path.filename().string() << ".tmp" << getpid() << "-" << std::this_thread::get_id();
+	std::filesystem::path tmpPath = this->directory / tmpName.str();
+
+	std::error_code ec;
+	std::filesystem::create_directories(this->directory, ec);
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		out.write((const char*) &header, sizeof(header));
+		out.write(writer.data.data(), writer.data.length());
+		if(!out)
+		{
+			out.close();
+			std::filesystem::remove(tmpPath, ec);
+			return;
+		}
+	}
+	std::filesystem::rename(tmpPath, path, ec);
+	if(ec)
+		std::filesystem::remove(tmpPath, ec);
+}
+
+std::shared_ptr<Module> ManifestCache::getModule(const URL& modulefile, const modgenfunc_t& genfunc)
+{
+	std::error_code ec;
+	std::filesystem::path path = modulefile.getKey();
+	modulefile_stamp_t stamp = { .length = 0, .time = 0, .hash = 0 };
+	if(modulefile.getProtocol() == URL::FILE_PROTOCOL)
+	{
+		stamp.length = std::filesystem::file_size(path, ec);
+		if(!ec)
+			stamp.time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+	}
+	if(modulefile.getProtocol() != URL::FILE_PROTOCOL || ec)
+	{
+		this->misses++;
+		return genfunc(modulefile);
+	}
+
+	try
+	{
+		if(std::shared_ptr<Module> module = loadModule(modulefile, stamp))
+		{
+			// Touched without being changed, restamped so the next start need not hash it again
+			if(stamp.hash != 0)
+				storeModule(*module, stamp);
+			this->hits++;
+			return module;
+		}
+	}
+	catch(const APIError&) {}
+	this->misses++;
+
+	// Stamped before parsing, so a modulefile changed meanwhile fails validation next time
+	if(stamp.hash == 0)
+		stamp.hash = hashModulefile(modulefile);
+	std::shared_ptr<Module> module = genfunc(modulefile);
+	storeModule(*module, stamp);
+	return module;
+}
+
+manifest_stats_t ManifestCache::getStatistics() const
+{
+	return { .hits = this->hits, .misses = this->misses };
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "base/modules/module.h"
+#include "base/modules/dependencies.h"
+#include <atomic>
+
+namespace wckt::base
+{
+	typedef struct
+	{
+		size_t hits;
+		size_t misses;
+	} manifest_stats_t;
+
+	/* State of a modulefile when it was read, recorded by manifests to validate them */
+	typedef struct
+	{
+		uint64_t length;
+		int64_t time;
+		uint64_t hash;
+	} modulefile_stamp_t;
+
+	/**
+	 * On-disk cache of parsed modulefiles, one binary manifest per modulefile holding its dependencies,
+	 * package tree, assets and components. Manifests are keyed by the modulefile's canonical path and the
+	 * compiler version, and are valid while the modulefile keeps the length and either the modification
+	 * time or the 64-bit hash they record, and are restamped with the new time when only the hash still
+	 * matches. Only file modulefiles whose components are all built in are cached. Cache failures are
+	 * treated as misses, and all methods may be called concurrently.
+	 */
+	class ManifestCache
+	{
+		private:
+			std::filesystem::path directory;
+
+			std::atomic<size_t> hits;
+			std::atomic<size_t> misses;
+
+			std::filesystem::path getEntryPath(const URL& modulefile) const;
+
+			/* Hashes the modulefile into the stamp, whose hash is 0 until then, only if its time differs */
+			std::shared_ptr<Module> loadModule(const URL& modulefile, modulefile_stamp_t& stamp) const;
+			void storeModule(const Module& module, const modulefile_stamp_t& stamp) const;
+
+		public:
+			ManifestCache(const std::filesystem::path& directory);
+			ManifestCache(const ManifestCache&) = delete;
+			~ManifestCache() = default;
+
+			std::filesystem::path getDirectory() const;
+
+			/* Returns the cached module, or generates it and caches the result on a miss */
+			std::shared_ptr<Module> getModule(const URL& modulefile, const modgenfunc_t& genfunc);
+
+			manifest_stats_t getStatistics() const;
+	};
+}
@@ -41,7 +41,7 @@ _APPLY_TAG_RULE(AssetTag::)
 	return ptr;
 }
 
-MODXML_IMPLRULE(PackageTag, "package", _INIT(_REQ("name"), _OPT("visibility", "public")), _INIT(AssetTag::ptr()), ptr->_getChildren().push_back(ptr))
+MODXML_IMPLRULE(PackageTag, "package", _INIT(_REQ("name"), _OPT("visibility", "public")), _INIT(AssetTag::ptr()), ptr->addChild(ptr))
 _APPLY_TAG_RULE(PackageTag::)
 {
 	std::vector<Package> packages;
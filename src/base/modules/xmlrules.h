@@ -11,8 +11,10 @@
 								};
 #define MODXML_IMPLRULE(_Name, _Str, _Args, _Chld, _Action)											\
 													std::shared_ptr<_Name> _Name::ptr()				\
-													{ static auto ptr {std::make_shared<_Name>()};	\
-													  _Action; return ptr; }						\
+													{ static auto ptr {[] {							\
+														auto ptr = std::make_shared<_Name>();		\
+														_Action; return ptr; }()};					\
+													  return ptr; }									\
 													_Name::_Name(): TagRule(_Str, _Args, _Chld) {}
 
 namespace wckt::base
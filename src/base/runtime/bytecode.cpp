@@ -0,0 +1,10 @@
+#include "base/runtime/bytecode.h"
+
+using namespace wckt;
+using namespace wckt::base;
+
+#define __OPCODE_OPERANDS(_Name, _Op, _Len)		_Len,
+#define __OPCODE_MNEMONIC(_Name, _Op, _Len)		#_Name,
+
+const uint8_t wckt::base::OPCODE_OPERANDS[MAX_OPCODE_PLUS_ONE] = { FOREACH_OPCODE(__OPCODE_OPERANDS) };
+const char* const wckt::base::OPCODE_MNEMONICS[MAX_OPCODE_PLUS_ONE] = { FOREACH_OPCODE(__OPCODE_MNEMONIC) };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "include/definitions.h"
+
+/* Mnemonic, opcode and number of operand bytes, in opcode order (see documentation/bytecode.md) */
+#define FOREACH_OPCODE(_Fn)								\
+		_Fn(NOP,				0x00,		0)			\
+		_Fn(NULL,				0x01,		0)			\
+		_Fn(NEW,				0x02,		0)			\
+		_Fn(STORE,				0x03,		1)			\
+		_Fn(STOREW,				0x04,		2)			\
+		_Fn(LOAD,				0x05,		1)			\
+		_Fn(LOADW,				0x06,		2)			\
+		_Fn(CONST,				0x07,		1)			\
+		_Fn(CONSTW,				0x08,		2)			\
+		_Fn(INVOKE,				0x09,		1)			\
+		_Fn(GETPROP,			0x0a,		1)			\
+		_Fn(GETPROPW,			0x0b,		2)			\
+		_Fn(SETPROP,			0x0c,		1)			\
+		_Fn(SETPROPW,			0x0d,		2)			\
+		_Fn(INVOKECON,			0x0e,		1)			\
+		_Fn(INVOKECONW,			0x0f,		2)			\
+		_Fn(THIS,				0x10,		0)			\
+		_Fn(GOTO,				0x11,		1)			\
+		_Fn(GOTOW,				0x12,		2)			\
+		_Fn(SATISFIES,			0x13,		1)			\
+		_Fn(SATISFIESW,			0x14,		2)			\
+		_Fn(CHECKTYPE,			0x15,		1)			\
+		_Fn(CHECKTYPEW,			0x16,		2)			\
+		_Fn(ADD,				0x17,		0)			\
+		_Fn(SUB,				0x18,		0)			\
+		_Fn(MUL,				0x19,		0)			\
+		_Fn(DIV,				0x1a,		0)			\
+		_Fn(MOD,				0x1b,		0)			\
+		_Fn(AND,				0x1c,		0)			\
+		_Fn(OR,					0x1d,		0)			\
+		_Fn(XOR,				0x1e,		0)			\
+		_Fn(SHL,				0x1f,		0)			\
+		_Fn(SHR,				0x20,		0)			\
+		_Fn(LNOT,				0x21,		0)			\
+		_Fn(NOT,				0x22,		0)			\
+		_Fn(POS,				0x23,		0)			\
+		_Fn(NEG,				0x24,		0)			\
+		_Fn(EQU,				0x25,		0)			\
+		_Fn(NEQ,				0x26,		0)			\
+		_Fn(GRT,				0x27,		0)			\
+		_Fn(LST,				0x28,		0)			\
+		_Fn(GTE,				0x29,		0)			\
+		_Fn(LTE,				0x2a,		0)			\
+		_Fn(ADDEQ,				0x2b,		0)			\
+		_Fn(SUBEQ,				0x2c,		0)			\
+		_Fn(MULEQ,				0x2d,		0)			\
+		_Fn(DIVEQ,				0x2e,		0)			\
+		_Fn(MODEQ,				0x2f,		0)			\
+		_Fn(ANDEQ,				0x30,		0)			\
+		_Fn(OREQ,				0x31,		0)			\
+		_Fn(XOREQ,				0x32,		0)			\
+		_Fn(SHLEQ,				0x33,		0)			\
+		_Fn(SHREQ,				0x34,		0)			\
+		_Fn(INC,				0x35,		0)			\
+		_Fn(DEC,				0x36,		0)			\
+		_Fn(INDEX,				0x37,		0)			\
+		_Fn(REFEQU,				0x38,		0)			\
+		_Fn(REFNEQ,				0x39,		0)			\
+		_Fn(GOTOIF,				0x3a,		1)			\
+		_Fn(GOTOIFW,			0x3b,		2)			\
+		_Fn(GOTOIFTRUTHY,		0x3c,		1)			\
+		_Fn(GOTOIFTRUTHYW,		0x3d,		2)			\
+		_Fn(GOTOIFNULL,			0x3e,		1)			\
+		_Fn(GOTOIFNULLW,		0x3f,		2)			\
+		_Fn(GOTOIFNONNULL,		0x40,		1)			\
+		_Fn(GOTOIFNONNULLW,		0x41,		2)			\
+		_Fn(UBCONST,			0x42,		1)			\
+		_Fn(BCONST,				0x43,		1)			\
+		_Fn(USCONST,			0x44,		1)			\
+		_Fn(USCONSTW,			0x45,		2)			\
+		_Fn(SCONST,				0x46,		1)			\
+		_Fn(SCONSTW,			0x47,		2)			\
+		_Fn(UCONST,				0x48,		1)			\
+		_Fn(UCONSTW,			0x49,		2)			\
+		_Fn(ICONST,				0x4a,		1)			\
+		_Fn(ICONSTW,			0x4b,		2)			\
+		_Fn(ULCONST,			0x4c,		1)			\
+		_Fn(ULCONSTW,			0x4d,		2)			\
+		_Fn(LCONST,				0x4e,		1)			\
+		_Fn(LCONSTW,			0x4f,		2)			\
+		_Fn(BLCONST_TRUE,		0x50,		0)			\
+		_Fn(BLCONST_FALSE,		0x51,		0)			\
+		_Fn(CHCONST,			0x52,		1)			\
+		_Fn(CHCONSTW,			0x53,		2)			\
+		_Fn(DUP,				0x54,		0)			\
+		_Fn(RETURN,				0x55,		0)			\
+		_Fn(VRETURN,			0x56,		0)
+
+#define MAX_OPCODE_PLUS_ONE		0x57
+
+/* Operator invocation opcodes, which fetch an operator property from the left-most operand */
+#define FIRST_OPERATOR_OPCODE	0x17
+#define LAST_OPERATOR_OPCODE	0x37
+
+#define __DECLARE_OPCODE_ENUM_VALUE(_Name, _Op, _Len)	OP_##_Name = _Op,
+
+namespace wckt::base
+{
+	enum opcode_t : uint8_t
+	{ FOREACH_OPCODE(__DECLARE_OPCODE_ENUM_VALUE) };
+
+	/* Number of operand bytes following each opcode */
+	extern const uint8_t OPCODE_OPERANDS[MAX_OPCODE_PLUS_ONE];
+	extern const char* const OPCODE_MNEMONICS[MAX_OPCODE_PLUS_ONE];
+
+	/* Multi-byte fields of OPP files are little-endian */
+	inline uint16_t readU16(const uint8_t* data)
+	{ return (uint16_t) (data[0] | data[1] << 8); }
+
+	inline uint32_t readU32(const uint8_t* data)
+	{ return (uint32_t) readU16(data) | (uint32_t) readU16(data + 2) << 16; }
+
+	inline uint64_t readU64(const uint8_t* data)
+	{ return (uint64_t) readU32(data) | (uint64_t) readU32(data + 4) << 32; }
+}
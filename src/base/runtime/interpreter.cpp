@@ -0,0 +1,747 @@
+#include "base/engine.h"
+#include "base/runtime/bytecode.h"
+#include "include/exception.h"
+#include <cmath>
+
+using namespace wckt;
+using namespace wckt::base;
+
+/* Property names of the operator invocation opcodes, indexed from FIRST_OPERATOR_OPCODE */
+static const char* const OPERATOR_NAMES[] = {
+	"operator+", "operator-", "operator*", "operator/", "operator%", "operator&", "operator|", "operator^",
+	"operator<<", "operator>>", "operator!", "operator~", "operator\\+", "operator\\-", "operator==", "operator!=",
+	"operator>", "operator<", "operator>=", "operator<=", "operator+=", "operator-=", "operator*=", "operator/=",
+	"operator%=", "operator&=", "operator|=", "operator^=", "operator<<=", "operator>>=", "operator++", "operator--",
+	"operator[]"
+};
+
+static inline bool isUnaryOperator(uint8_t op)
+{
+	return (op >= OP_LNOT && op <= OP_NEG) || op == OP_INC || op == OP_DEC;
+}
+
+[[noreturn]] static void unsupportedOperator(uint8_t op, const Value& left, const Value& right)
+{
+	throw ExecutionError("Operator " + std::string(OPERATOR_NAMES[op - FIRST_OPERATOR_OPCODE]) + " is not defined for "
+		+ Value::getKindName(left.getKind()) + (isUnaryOperator(op) ? "" : " and " + Value::getKindName(right.getKind())));
+}
+
+/* Integral operators, computed in 64 bits and truncated to the kind of the left operand */
+static Value integralOperator(uint8_t op, const Value& left, const Value& right)
+{
+	Value::kind_t kind = left.getKind();
+	bool isUnsigned = kind == Value::ULONG;
+	uint64_t a = left.getInteger(), b = right.isIntegral() || right.isReal() ? right.toInteger() : 0;
+	if(!isUnaryOperator(op) && !right.isIntegral() && !right.isReal())
+		unsupportedOperator(op, left, right);
+
+	switch(op)
+	{
+		case OP_ADD:
+		case OP_ADDEQ:	return Value::fromInteger(kind, a + b);
+		case OP_SUB:
+		case OP_SUBEQ:	return Value::fromInteger(kind, a - b);
+		case OP_MUL:
+		case OP_MULEQ:	return Value::fromInteger(kind, a * b);
+		case OP_DIV:
+		case OP_DIVEQ:
+		case OP_MOD:
+		case OP_MODEQ:
+		{
+			if(b == 0)
+				throw ExecutionError("Division by zero");
+			bool div = op == OP_DIV || op == OP_DIVEQ;
+			if(isUnsigned)
+				return Value::fromInteger(kind, div ? a / b : a % b);
+			// INT64_MIN / -1 overflows, its wrapped quotient is INT64_MIN and its remainder 0
+			if((int64_t) b == -1)
+				return Value::fromInteger(kind, div ? 0 - a : 0);
+			return Value::fromInteger(kind, div ? (int64_t) a / (int64_t) b : (int64_t) a % (int64_t) b);
+		}
+		case OP_AND:
+		case OP_ANDEQ:	return Value::fromInteger(kind, a & b);
+		case OP_OR:
+		case OP_OREQ:	return Value::fromInteger(kind, a | b);
+		case OP_XOR:
+		case OP_XOREQ:	return Value::fromInteger(kind, a ^ b);
+		case OP_SHL:
+		case OP_SHLEQ:	return Value::fromInteger(kind, a << (b & 63));
+		case OP_SHR:
+		case OP_SHREQ:	return Value::fromInteger(kind, isUnsigned ? a >> (b & 63) : (uint64_t) ((int64_t) a >> (b & 63)));
+		case OP_NOT:	return Value::fromInteger(kind, ~a);
+		case OP_POS:	return left;
+		case OP_NEG:	return Value::fromInteger(kind, 0 - a);
+		case OP_INC:	return Value::fromInteger(kind, a + 1);
+		case OP_DEC:	return Value::fromInteger(kind, a - 1);
+		case OP_EQU:	return Value::fromBool(a == b);
+		case OP_NEQ:	return Value::fromBool(a != b);
+		case OP_GRT:	return Value::fromBool(isUnsigned ? a > b : (int64_t) a > (int64_t) b);
+		case OP_LST:	return Value::fromBool(isUnsigned ? a < b : (int64_t) a < (int64_t) b);
+		case OP_GTE:	return Value::fromBool(isUnsigned ? a >= b : (int64_t) a >= (int64_t) b);
+		case OP_LTE:	return Value::fromBool(isUnsigned ? a <= b : (int64_t) a <= (int64_t) b);
+		default:		unsupportedOperator(op, left, right);
+	}
+}
+
+static Value realOperator(uint8_t op, const Value& left, const Value& right)
+{
+	Value::kind_t kind = left.getKind();
+	double a = left.getReal(), b = right.isIntegral() || right.isReal() ? right.toReal() : 0;
+	if(!isUnaryOperator(op) && !right.isIntegral() && !right.isReal())
+		unsupportedOperator(op, left, right);
+
+	switch(op)
+	{
+		case OP_ADD:
+		case OP_ADDEQ:	return Value::fromReal(kind, a + b);
+		case OP_SUB:
+		case OP_SUBEQ:	return Value::fromReal(kind, a - b);
+		case OP_MUL:
+		case OP_MULEQ:	return Value::fromReal(kind, a * b);
+		case OP_DIV:
+		case OP_DIVEQ:	return Value::fromReal(kind, a / b);
+		case OP_MOD:
+		case OP_MODEQ:	return Value::fromReal(kind, std::fmod(a, b));
+		case OP_POS:	return left;
+		case OP_NEG:	return Value::fromReal(kind, -a);
+		case OP_INC:	return Value::fromReal(kind, a + 1);
+		case OP_DEC:	return Value::fromReal(kind, a - 1);
+		case OP_EQU:	return Value::fromBool(a == b);
+		case OP_NEQ:	return Value::fromBool(a != b);
+		case OP_GRT:	return Value::fromBool(a > b);
+		case OP_LST:	return Value::fromBool(a < b);
+		case OP_GTE:	return Value::fromBool(a >= b);
+		case OP_LTE:	return Value::fromBool(a <= b);
+		default:		unsupportedOperator(op, left, right);
+	}
+}
+
+static Value stringOperator(uint8_t op, const Value& left, const Value& right)
+{
+	const std::u16string& a = left.getString();
+	if(op == OP_INDEX && right.isIntegral())
+	{
+		if(right.toInteger() < 0 || (uint64_t) right.toInteger() >= a.length())
+			throw ExecutionError("String index " + right.toString() + " out of range");
+		return Value::fromInteger(Value::CHAR, a[right.toInteger()]);
+	}
+	if((op == OP_ADD || op == OP_ADDEQ) && right.getKind() == Value::CHAR)
+		return Value::fromString(a + (char16_t) right.getInteger());
+	if(right.getKind() != Value::STRING)
+		unsupportedOperator(op, left, right);
+
+	const std::u16string& b = right.getString();
+	switch(op)
+	{
+		case OP_ADD:
+		case OP_ADDEQ:	return Value::fromString(a + b);
+		case OP_EQU:	return Value::fromBool(a == b);
+		case OP_NEQ:	return Value::fromBool(a != b);
+		case OP_GRT:	return Value::fromBool(a > b);
+		case OP_LST:	return Value::fromBool(a < b);
+		case OP_GTE:	return Value::fromBool(a >= b);
+		case OP_LTE:	return Value::fromBool(a <= b);
+		default:		unsupportedOperator(op, left, right);
+	}
+}
+
+static Value boolOperator(uint8_t op, const Value& left, const Value& right)
+{
+	if(op == OP_LNOT)
+		return Value::fromBool(!left.getBool());
+	if(right.getKind() != Value::BOOL)
+		unsupportedOperator(op, left, right);
+
+	bool a = left.getBool(), b = right.getBool();
+	switch(op)
+	{
+		case OP_AND:
+		case OP_ANDEQ:	return Value::fromBool(a && b);
+		case OP_OR:
+		case OP_OREQ:	return Value::fromBool(a || b);
+		case OP_XOR:
+		case OP_XOREQ:	return Value::fromBool(a != b);
+		case OP_EQU:	return Value::fromBool(a == b);
+		case OP_NEQ:	return Value::fromBool(a != b);
+		default:		unsupportedOperator(op, left, right);
+	}
+}
+
+Value Engine::invokeOperator(uint8_t op, Value* operands)
+{
+	const Value& left = operands[0];
+	const Value& right = isUnaryOperator(op) ? left : operands[1];
+	switch(left.getKind())
+	{
+		case Value::OBJECT:
+		{
+			const char* name = OPERATOR_NAMES[op - FIRST_OPERATOR_OPCODE];
+			const Value* property = left.getObject().findProperty(name);
+			if(property == nullptr)
+				unsupportedOperator(op, left, right);
+
+			Value callee = property->getKind() == Value::FUNCTION && property->getReceiver() == nullptr
+				? Value::fromFunction(property->getFunction(), left.getObjectPtr()) : *property;
+			Value result;
+			call(callee, operands + 1, isUnaryOperator(op) ? 0 : 1, result);
+			return result;
+		}
+		case Value::BOOL:
+			return boolOperator(op, left, right);
+		case Value::STRING:
+			return stringOperator(op, left, right);
+		case Value::FLOAT:
+		case Value::DOUBLE:
+			return realOperator(op, left, right);
+		case Value::NONE:
+		case Value::FUNCTION:
+			if(op == OP_EQU || op == OP_NEQ)
+				return Value::fromBool((left == right) == (op == OP_EQU));
+			unsupportedOperator(op, left, right);
+		default:
+			return integralOperator(op, left, right);
+	}
+}
+
+bool Engine::isTruthy(const Value& value)
+{
+	switch(value.getKind())
+	{
+		case Value::NONE:	return false;
+		case Value::BOOL:	return value.getBool();
+		case Value::OBJECT:
+		{
+			// Objects decide their own truthiness through a truthy() property
+			const Value* truthy = value.getObject().findProperty("truthy");
+			if(truthy == nullptr || truthy->getKind() != Value::FUNCTION)
+				return true;
+			Value callee = truthy->getReceiver() == nullptr ? Value::fromFunction(truthy->getFunction(), value.getObjectPtr()) : *truthy;
+			Value result;
+			return !call(callee, this->sp, 0, result) || result.getKind() != Value::BOOL || result.getBool();
+		}
+		default:			return true;
+	}
+}
+
+Value Engine::getProperty(const Value& value, std::string_view name) const
+{
+	switch(value.getKind())
+	{
+		case Value::OBJECT:
+		{
+			const Value* property = value.getObject().findProperty(name);
+			if(property == nullptr)
+				return Value();
+			// Functions read from an object are bound to it
+			if(property->getKind() == Value::FUNCTION && property->getReceiver() == nullptr)
+				return Value::fromFunction(property->getFunction(), value.getObjectPtr());
+			return *property;
+		}
+		case Value::FUNCTION:
+			if(name == "call")
+				return value;
+			break;
+		case Value::STRING:
+			if(name == "length")
+				return Value::fromInteger(Value::INT, value.getString().length());
+			break;
+		default:
+			break;
+	}
+	throw ExecutionError("Cannot get property " + std::string(name) + " of " + Value::getKindName(value.getKind()) + " value");
+}
+
+/* Slot of the property in objects of a shape, and the shape setprop transitions them to, or npos on a miss */
+static inline uint32_t probeCache(const inline_cache_t& cache, uint32_t shape, const Shape*& transition)
+{
+	for(size_t i = 0 ; i < INLINE_CACHE_SIZE ; ++i)
+	{
+		if(cache.shapes[i] == shape)
+		{
+			transition = cache.transitions[i];
+			return cache.slots[i];
+		}
+	}
+	return Shape::npos;
+}
+
+/* Records a shape in a free entry, megamorphic instructions keep the shapes they saw first */
+static inline void fillCache(inline_cache_t& cache, uint32_t shape, uint32_t slot, const Shape* transition)
+{
+	for(size_t i = 0 ; i < INLINE_CACHE_SIZE ; ++i)
+	{
+		if(cache.shapes[i] == 0)
+		{
+			cache.shapes[i] = shape;
+			cache.slots[i] = slot;
+			cache.transitions[i] = transition;
+			return;
+		}
+	}
+}
+
+/* Pops the top of the operand stack, leaving the slot null */
+static inline Value take(Value*& sp)
+{
+	Value value = std::move(*--sp);
+	*sp = Value();
+	return value;
+}
+
+[[noreturn]] static void stackFault(const Function& function, const char* reason)
+{
+	throw ExecutionError(std::string(reason) + " in function " + function.getName());
+}
+
+#define REQUIRE(_Count)		if(sp - operands < (_Count)) stackFault(function, "Stack underflow")
+#define PUSH(_Value)		do { if(sp == limit) stackFault(function, "Stack overflow"); *sp++ = _Value; } while(0)
+
+/* Computed goto dispatch where supported, a switch in a loop otherwise */
+#if defined(__GNUC__) || defined(__clang__)
+#define __DECLARE_OPCODE_LABEL(_Name, _Op, _Len)	&&L_##_Name,
+#define DISPATCH()			do { ++executed; goto *LABELS[*ip]; } while(0)
+#define CASE(_Name)			L_##_Name:
+#define INTERPRETER_LOOP	static void* const LABELS[MAX_OPCODE_PLUS_ONE] = { FOREACH_OPCODE(__DECLARE_OPCODE_LABEL) }; \
+							DISPATCH();
+#else
+#define DISPATCH()			do { ++executed; goto dispatch; } while(0)
+#define CASE(_Name)			case OP_##_Name:
+#define INTERPRETER_LOOP	dispatch: switch(*ip)
+#endif
+
+/* Narrow and wide variants of an instruction, which take a 1 and 2-byte operand */
+#define CASE_WIDE(_Name, ...)												\
+		CASE(_Name)															\
+		{																	\
+			[[maybe_unused]] const uint16_t operand = ip[1];				\
+			[[maybe_unused]] const int64_t signedOperand = (int8_t) ip[1];	\
+			[[maybe_unused]] const uint8_t* const next = ip + 2;			\
+			__VA_ARGS__														\
+		}																	\
+		CASE(_Name##W)														\
+		{																	\
+			[[maybe_unused]] const uint16_t operand = readU16(ip + 1);		\
+			[[maybe_unused]] const int64_t signedOperand = (int16_t) operand;	\
+			[[maybe_unused]] const uint8_t* const next = ip + 3;			\
+			__VA_ARGS__														\
+		}
+
+/* Operator invocation through invokeOperator(), which replaces the operands with the result */
+#define OPERATOR_CALL(_Name, _Argc)												\
+			Value* args = sp - (_Argc + 1);										\
+			this->sp = sp;														\
+			Value value = invokeOperator(OP_##_Name, args);						\
+			while(sp != args)													\
+				*--sp = Value();												\
+			*sp++ = std::move(value);											\
+			++ip;																\
+			DISPATCH();
+
+#define GENERIC_OPERATOR(_Name, _Argc)											\
+		CASE(_Name)																\
+		{																		\
+			REQUIRE(_Argc + 1);													\
+			OPERATOR_CALL(_Name, _Argc)											\
+		}
+
+/* Operator with a fast path for Int operands a and b */
+#define INT_FAST_OPERATOR(_Name, _Argc, _Expr)									\
+		CASE(_Name)																\
+		{																		\
+			REQUIRE(_Argc + 1);													\
+			if(sp[-1].getKind() == Value::INT && sp[-1 - _Argc].getKind() == Value::INT)	\
+			{																	\
+				[[maybe_unused]] int64_t a = sp[-1 - _Argc].getInteger(), b = sp[-1].getInteger();	\
+				if(_Argc == 1)													\
+					*--sp = Value();											\
+				sp[-1] = _Expr;													\
+				++ip;															\
+				DISPATCH();														\
+			}																	\
+			OPERATOR_CALL(_Name, _Argc)											\
+		}
+
+#define INT_OPERATOR(_Name, _Expr)			INT_FAST_OPERATOR(_Name, 1, Value::fromInteger(Value::INT, _Expr))
+#define BOOL_OPERATOR(_Name, _Expr)			INT_FAST_OPERATOR(_Name, 1, Value::fromBool(_Expr))
+
+bool Engine::execute(const Function& function, const Value& self, Value* args, Value& result)
+{
+	Value* const limit = this->stack.get() + STACK_SIZE;
+	if(this->callDepth >= MAX_CALL_DEPTH || function.getLocalCount() > limit - args)
+		stackFault(function, "Stack overflow");
+
+	// Arguments are the first local slots, the rest are null since every slot above the stack pointer is
+	Value* const locals = args;
+	Value* const operands = args + function.getLocalCount();
+	Value* sp = operands;
+	uint64_t executed = 0;
+
+	/* Releases the frame's slots and accounts its instructions, whether it returns or unwinds */
+	struct frame_t
+	{
+		Engine& engine;
+		Value* base;
+		Value*& sp;
+		uint64_t& executed;
+
+		~frame_t()
+		{
+			std::fill(this->base, this->sp, Value());
+			this->engine.sp = this->base;
+			this->engine.callDepth--;
+			this->engine.instructionCount += this->executed;
+		}
+	};
+	++this->callDepth;
+	frame_t frame = { *this, args, sp, executed };
+
+	const uint32_t assetIndex = function.getAssetIndex();
+	const OPPFile& file = function.getFile();
+	const uint8_t* ip = function.getCode();
+
+	INTERPRETER_LOOP
+	{
+		CASE(NOP)
+		{
+			++ip;
+			DISPATCH();
+		}
+		CASE(NULL)
+		{
+			PUSH(Value());
+			++ip;
+			DISPATCH();
+		}
+		CASE(NEW)
+		{
+			PUSH(Value::fromObject(std::make_shared<Object>()));
+			++ip;
+			DISPATCH();
+		}
+		CASE_WIDE(STORE,
+		{
+			REQUIRE(1);
+			locals[operand] = take(sp);
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(LOAD,
+		{
+			PUSH(locals[operand]);
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(CONST,
+		{
+			PUSH(getConstant(assetIndex, operand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE(INVOKE)
+		{
+			uint8_t argc = ip[1];
+			REQUIRE(argc + 1);
+			Value* callArgs = sp - argc;
+			Value callee = std::move(callArgs[-1]);
+			callArgs[-1] = Value();
+
+			this->sp = sp;
+			Value returned;
+			bool produced = call(callee, callArgs, argc, returned);
+			sp = callArgs - 1;
+			if(produced)
+				*sp++ = std::move(returned);
+			ip += 2;
+			DISPATCH();
+		}
+		CASE_WIDE(GETPROP,
+		{
+			REQUIRE(1);
+			if(sp[-1].getKind() != Value::OBJECT)
+			{
+				sp[-1] = getProperty(sp[-1], file.getUTF8(operand));
+				ip = next;
+				DISPATCH();
+			}
+
+			const Object& object = sp[-1].getObject();
+			inline_cache_t& cache = function.getInlineCache(ip);
+			const Shape* transition;
+			uint32_t slot = probeCache(cache, object.getShape().getID(), transition);
+			if(slot != Shape::npos)
+				this->inlineCacheStatistics.hits++;
+			else
+			{
+				this->inlineCacheStatistics.misses++;
+				slot = object.getShape().find(file.getUTF8(operand));
+				if(slot != Shape::npos && !object.getShape().isDictionary())
+					fillCache(cache, object.getShape().getID(), slot, nullptr);
+			}
+
+			Value property = slot == Shape::npos ? Value() : object.getSlot(slot);
+			if(property.getKind() == Value::FUNCTION && property.getReceiver() == nullptr)
+				property = Value::fromFunction(property.getFunction(), sp[-1].getObjectPtr());
+			sp[-1] = std::move(property);
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(SETPROP,
+		{
+			REQUIRE(2);
+			if(sp[-2].getKind() != Value::OBJECT)
+				throw ExecutionError("Cannot set property " + std::string(file.getUTF8(operand)) + " of "
+					+ Value::getKindName(sp[-2].getKind()) + " value");
+
+			Object& object = sp[-2].getObject();
+			inline_cache_t& cache = function.getInlineCache(ip);
+			const Shape* transition;
+			uint32_t shape = object.getShape().getID();
+			uint32_t slot = probeCache(cache, shape, transition);
+			if(slot != Shape::npos)
+				this->inlineCacheStatistics.hits++;
+			else
+			{
+				this->inlineCacheStatistics.misses++;
+				// Dictionary shapes change in place, so objects past the threshold are left to setProperty
+				const Shape& current = object.getShape();
+				slot = current.find(file.getUTF8(operand));
+				transition = slot == Shape::npos && current.canTransition() ? &current.withProperty(file.getUTF8(operand)) : nullptr;
+				if(transition != nullptr)
+					slot = current.getSlotCount();
+				if(slot != Shape::npos && !current.isDictionary())
+					fillCache(cache, shape, slot, transition);
+			}
+
+			if(transition != nullptr)
+				object.addSlot(*transition, take(sp));
+			else if(slot != Shape::npos)
+				object.setSlot(slot, take(sp));
+			else object.setProperty(file.getUTF8(operand), take(sp));
+			take(sp);
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(INVOKECON,
+		{
+			runtime_constructor_t& constructor = getConstructor(file.getUTF8(operand));
+			if(constructor.cases.empty())
+				throw ExecutionError("Constructor " + std::string(file.getUTF8(operand)) + " has no cases");
+			uint8_t argc = constructor.cases[0]->getArgCount();
+			REQUIRE(argc + 1);
+			Value* conArgs = sp - argc;
+			const Value& target = conArgs[-1];
+			if(target.getKind() != Value::OBJECT)
+				throw ExecutionError("Constructor " + std::string(file.getUTF8(operand)) + " cannot initialize a "
+					+ Value::getKindName(target.getKind()) + " value");
+
+			const Function* selected = selectCase(constructor, conArgs);
+			Object& object = target.getObject();
+			object.reserveSlots(constructor.slotCount);
+			this->sp = sp;
+			Value ignored;
+			call(Value::fromFunction(*selected, target.getObjectPtr()), conArgs, argc, ignored);
+			sp = conArgs;
+			if(!constructor.origin.empty())
+				object.addOrigin(constructor.origin);
+			constructor.slotCount = object.getShape().getSlotCount();
+			ip = next;
+			DISPATCH();
+		})
+		CASE(THIS)
+		{
+			PUSH(self);
+			++ip;
+			DISPATCH();
+		}
+		CASE_WIDE(GOTO,
+		{
+			ip = function.getBranch(operand);
+			DISPATCH();
+		})
+		CASE_WIDE(SATISFIES,
+		{
+			REQUIRE(1);
+			sp[-1] = Value::fromBool(satisfies(sp[-1], assetIndex, operand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(CHECKTYPE,
+		{
+			REQUIRE(1);
+			if(!satisfies(sp[-1], assetIndex, operand))
+				throw ExecutionError(Value::getKindName(sp[-1].getKind()) + " value does not satisfy type #"
+					+ std::to_string(operand) + " in function " + function.getName());
+			ip = next;
+			DISPATCH();
+		})
+
+		INT_OPERATOR(ADD, a + b)
+		INT_OPERATOR(SUB, a - b)
+		INT_OPERATOR(MUL, a * b)
+		GENERIC_OPERATOR(DIV, 1)
+		GENERIC_OPERATOR(MOD, 1)
+		INT_OPERATOR(AND, a & b)
+		INT_OPERATOR(OR, a | b)
+		INT_OPERATOR(XOR, a ^ b)
+		GENERIC_OPERATOR(SHL, 1)
+		GENERIC_OPERATOR(SHR, 1)
+		GENERIC_OPERATOR(LNOT, 0)
+		GENERIC_OPERATOR(NOT, 0)
+		GENERIC_OPERATOR(POS, 0)
+		GENERIC_OPERATOR(NEG, 0)
+		BOOL_OPERATOR(EQU, a == b)
+		BOOL_OPERATOR(NEQ, a != b)
+		BOOL_OPERATOR(GRT, a > b)
+		BOOL_OPERATOR(LST, a < b)
+		BOOL_OPERATOR(GTE, a >= b)
+		BOOL_OPERATOR(LTE, a <= b)
+		INT_OPERATOR(ADDEQ, a + b)
+		INT_OPERATOR(SUBEQ, a - b)
+		INT_OPERATOR(MULEQ, a * b)
+		GENERIC_OPERATOR(DIVEQ, 1)
+		GENERIC_OPERATOR(MODEQ, 1)
+		INT_OPERATOR(ANDEQ, a & b)
+		INT_OPERATOR(OREQ, a | b)
+		INT_OPERATOR(XOREQ, a ^ b)
+		GENERIC_OPERATOR(SHLEQ, 1)
+		GENERIC_OPERATOR(SHREQ, 1)
+		INT_FAST_OPERATOR(INC, 0, Value::fromInteger(Value::INT, a + 1))
+		INT_FAST_OPERATOR(DEC, 0, Value::fromInteger(Value::INT, a - 1))
+		GENERIC_OPERATOR(INDEX, 1)
+
+		CASE(REFEQU)
+		{
+			REQUIRE(2);
+			bool equal = sp[-2] == sp[-1];
+			take(sp);
+			sp[-1] = Value::fromBool(equal);
+			++ip;
+			DISPATCH();
+		}
+		CASE(REFNEQ)
+		{
+			REQUIRE(2);
+			bool equal = sp[-2] == sp[-1];
+			take(sp);
+			sp[-1] = Value::fromBool(!equal);
+			++ip;
+			DISPATCH();
+		}
+		CASE_WIDE(GOTOIF,
+		{
+			REQUIRE(1);
+			Value condition = take(sp);
+			if(condition.getKind() != Value::BOOL)
+				throw ExecutionError("Branch condition must be a Bool in function " + function.getName());
+			ip = condition.getBool() ? function.getBranch(operand) : next;
+			DISPATCH();
+		})
+		CASE_WIDE(GOTOIFTRUTHY,
+		{
+			REQUIRE(1);
+			Value condition = take(sp);
+			this->sp = sp;
+			ip = isTruthy(condition) ? function.getBranch(operand) : next;
+			DISPATCH();
+		})
+		CASE_WIDE(GOTOIFNULL,
+		{
+			REQUIRE(1);
+			ip = take(sp).isNull() ? function.getBranch(operand) : next;
+			DISPATCH();
+		})
+		CASE_WIDE(GOTOIFNONNULL,
+		{
+			REQUIRE(1);
+			ip = !take(sp).isNull() ? function.getBranch(operand) : next;
+			DISPATCH();
+		})
+		CASE(UBCONST)
+		{
+			PUSH(Value::fromInteger(Value::UBYTE, ip[1]));
+			ip += 2;
+			DISPATCH();
+		}
+		CASE(BCONST)
+		{
+			PUSH(Value::fromInteger(Value::BYTE, (int8_t) ip[1]));
+			ip += 2;
+			DISPATCH();
+		}
+		CASE_WIDE(USCONST,
+		{
+			PUSH(Value::fromInteger(Value::USHORT, operand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(SCONST,
+		{
+			PUSH(Value::fromInteger(Value::SHORT, signedOperand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(UCONST,
+		{
+			PUSH(Value::fromInteger(Value::UINT, operand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(ICONST,
+		{
+			PUSH(Value::fromInteger(Value::INT, signedOperand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(ULCONST,
+		{
+			PUSH(Value::fromInteger(Value::ULONG, operand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE_WIDE(LCONST,
+		{
+			PUSH(Value::fromInteger(Value::LONG, signedOperand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE(BLCONST_TRUE)
+		{
+			PUSH(Value::fromBool(true));
+			++ip;
+			DISPATCH();
+		}
+		CASE(BLCONST_FALSE)
+		{
+			PUSH(Value::fromBool(false));
+			++ip;
+			DISPATCH();
+		}
+		CASE_WIDE(CHCONST,
+		{
+			PUSH(Value::fromInteger(Value::CHAR, operand));
+			ip = next;
+			DISPATCH();
+		})
+		CASE(DUP)
+		{
+			REQUIRE(1);
+			Value top = sp[-1];
+			PUSH(std::move(top));
+			++ip;
+			DISPATCH();
+		}
+		CASE(RETURN)
+		{
+			return false;
+		}
+		CASE(VRETURN)
+		{
+			REQUIRE(1);
+			result = take(sp);
+			return true;
+		}
+	}
+
+	// Unreachable, functions are verified to end with a return or a jump
+	throw CorruptStateError("Execution ran past the end of function " + function.getName());
+}
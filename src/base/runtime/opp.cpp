@@ -0,0 +1,330 @@
+#include "base/runtime/opp.h"
+#include "base/runtime/bytecode.h"
+#include "include/exception.h"
+#include "include/checksum.h"
+
+using namespace wckt;
+using namespace wckt::base;
+
+const uint16_t OPPFile::SIGNATURE = 0xef01;
+const size_t OPPFile::HEADER_SIZE = 0x1b;
+/* 2.0 added the function header and the argument count of invoke */
+const uint16_t OPPFile::MAJOR_VERSION = 2;
+const uint8_t OPPFile::MINOR_VERSION = 0;
+
+namespace
+{
+	/* Bounds-checked cursor over a table of the file */
+	struct reader_t
+	{
+		const OPPFile& file;
+		const uint8_t* data;
+		size_t pos;
+		size_t end;
+
+		const uint8_t* take(size_t count)
+		{
+			if(count > this->end - this->pos)
+				throw FormatError("Truncated table in OPP file " + this->file.getURL().toString());
+			this->pos += count;
+			return this->data + this->pos - count;
+		}
+
+		uint8_t u8() { return *take(1); }
+		uint16_t u16() { return readU16(take(2)); }
+		uint32_t u32() { return readU32(take(4)); }
+
+		/* Reader over the next count bytes, which this reader skips */
+		reader_t sub(size_t count)
+		{
+			size_t start = this->pos;
+			take(count);
+			return { this->file, this->data, start, start + count };
+		}
+	};
+}
+
+static void readGenerics(reader_t& reader, opp_declaration_t& decl)
+{
+	reader_t table = reader.sub(reader.u32());
+	while(table.pos < table.end)
+		decl.generics.push_back(table.u16());
+}
+
+static void readConstructor(reader_t& reader, opp_declaration_t& decl)
+{
+	decl.access = reader.u8();
+	decl.name = reader.u16();
+	decl.type = reader.u16();
+	decl.impl = reader.u16();
+	readGenerics(reader, decl);
+}
+
+static std::vector<opp_declaration_t> readDeclarations(reader_t reader)
+{
+	std::vector<opp_declaration_t> declarations;
+	while(reader.pos < reader.end)
+	{
+		opp_declaration_t decl = { .signature = reader.u8() };
+		switch(decl.signature)
+		{
+			case OPPFile::DECL_TYPE:
+				decl.access = reader.u8();
+				decl.name = reader.u16();
+				decl.type = reader.u16();
+				readGenerics(reader, decl);
+				break;
+
+			case OPPFile::DECL_NAMESPACE:
+				decl.access = reader.u8();
+				decl.name = reader.u16();
+				decl.children = readDeclarations(reader.sub(reader.u32()));
+				break;
+
+			case OPPFile::DECL_CONTRACT:
+			case OPPFile::DECL_TEMPLATE:
+			case OPPFile::DECL_PARTIAL_TEMPLATE:
+			{
+				decl.access = reader.u8();
+				decl.name = reader.u16();
+				decl.extends = reader.u16();
+				uint32_t lenGenerics = reader.u32(), lenProperties = reader.u32(), lenDeclarations = reader.u32();
+
+				reader_t generics = reader.sub(lenGenerics);
+				while(generics.pos < generics.end)
+					decl.generics.push_back(generics.u16());
+
+				reader_t properties = reader.sub(lenProperties);
+				while(properties.pos < properties.end)
+				{
+					bool partial = decl.signature == OPPFile::DECL_PARTIAL_TEMPLATE && properties.data[properties.pos] == 0xef;
+					if(partial)
+						properties.u8();
+					decl.properties.push_back({ .access = properties.u8(), .name = properties.u16(), .type = properties.u16(),
+						.partial = partial });
+				}
+
+				decl.children = readDeclarations(reader.sub(lenDeclarations));
+				break;
+			}
+
+			case OPPFile::DECL_CONSTRUCTOR:
+				readConstructor(reader, decl);
+				break;
+
+			case OPPFile::DECL_SWITCH_CONSTRUCTOR:
+			{
+				decl.access = reader.u8();
+				decl.name = reader.u16();
+				reader_t cases = reader.sub(reader.u32());
+				while(cases.pos < cases.end)
+				{
+					opp_declaration_t _case = { .signature = OPPFile::DECL_CONSTRUCTOR };
+					readConstructor(cases, _case);
+					decl.children.push_back(std::move(_case));
+				}
+				break;
+			}
+
+			case OPPFile::DECL_STATIC_PROPERTY:
+				decl.access = reader.u8();
+				decl.name = reader.u16();
+				decl.type = reader.u16();
+				break;
+
+			default:
+				throw FormatError("Invalid declaration signature in OPP file " + reader.file.getURL().toString());
+		}
+		declarations.push_back(std::move(decl));
+	}
+	return declarations;
+}
+
+OPPFile::OPPFile(const URL& url)
+: OPPFile(url, url.map())
+{}
+
+OPPFile::OPPFile(const URL& url, std::shared_ptr<URLBuffer> buffer)
+: url(url), buffer(buffer), contents(buffer->getView())
+{
+	reader_t header = { *this, (const uint8_t*) this->contents.data(), 0, this->contents.length() };
+	if(this->contents.length() < HEADER_SIZE || header.u16() != SIGNATURE)
+		throw FormatError("Not an OPP file: " + url.toString());
+
+	this->majorVersion = header.u16();
+	this->minorVersion = header.u8();
+	if(this->majorVersion != MAJOR_VERSION || this->minorVersion > MINOR_VERSION)
+		throw FormatError("OPP file " + url.toString() + " has an unsupported format version "
+			+ std::to_string(this->majorVersion) + "." + std::to_string(this->minorVersion));
+
+	this->timestamp = readU64(header.take(8));
+	this->sourceChecksum = header.u32();
+	this->initializer = header.u16();
+	uint32_t lenDeclarations = header.u32(), lenConstants = header.u32();
+
+	this->declarations = readDeclarations(header.sub(lenDeclarations));
+	reader_t constants = header.sub(lenConstants);
+	indexConstants(constants.pos, constants.end);
+	this->poolOffset = header.pos;
+
+	if(this->initializer != 0)
+		getFunctionLiteral(this->initializer);
+}
+
+void OPPFile::indexConstants(size_t start, size_t end)
+{
+	reader_t reader = { *this, (const uint8_t*) this->contents.data(), start, end };
+	this->constants.push_back(0);
+	while(reader.pos < reader.end)
+	{
+		if(this->constants.size() > UINT16_MAX)
+			throw FormatError("Too many constants in OPP file " + this->url.toString());
+		this->constants.push_back(reader.pos);
+
+		switch(reader.u8())
+		{
+			case CUTF8:
+			case CSTRLIT:
+				reader.take(reader.u16());
+				break;
+			case CTYPE:
+			case COPTTYPE:
+				reader.take(reader.u32());
+				break;
+			case CFNLIT:
+				reader.take(6);
+				break;
+			case CUINTLIT:
+			case CINTLIT:
+			case CFLTLIT:
+				reader.take(4);
+				break;
+			case CULNGLIT:
+			case CLNGLIT:
+			case CDBLLIT:
+				reader.take(8);
+				break;
+			default:
+				throw FormatError("Invalid constant signature in OPP file " + this->url.toString());
+		}
+	}
+}
+
+const uint8_t* OPPFile::getConstant(uint16_t index, const_sig_t signature) const
+{
+	if(getConstantSignature(index) != signature)
+		throw FormatError("Constant #" + std::to_string(index) + " of OPP file " + this->url.toString() + " has the wrong type");
+	return (const uint8_t*) this->contents.data() + this->constants[index] + 1;
+}
+
+URL OPPFile::getURL() const
+{
+	return this->url;
+}
+
+uint16_t OPPFile::getMajorVersion() const
+{
+	return this->majorVersion;
+}
+
+uint8_t OPPFile::getMinorVersion() const
+{
+	return this->minorVersion;
+}
+
+uint64_t OPPFile::getTimestamp() const
+{
+	return this->timestamp;
+}
+
+uint32_t OPPFile::getSourceChecksum() const
+{
+	return this->sourceChecksum;
+}
+
+bool OPPFile::matchesSource(std::string_view source) const
+{
+	return crc32(source.data(), source.length()) == this->sourceChecksum;
+}
+
+uint16_t OPPFile::getInitializer() const
+{
+	return this->initializer;
+}
+
+const std::vector<opp_declaration_t>& OPPFile::getDeclarations() const
+{
+	return this->declarations;
+}
+
+uint16_t OPPFile::getConstantCount() const
+{
+	return this->constants.size() - 1;
+}
+
+OPPFile::const_sig_t OPPFile::getConstantSignature(uint16_t index) const
+{
+	if(index == 0 || index >= this->constants.size())
+		throw FormatError("No constant #" + std::to_string(index) + " in OPP file " + this->url.toString());
+	return (const_sig_t) this->contents[this->constants[index]];
+}
+
+std::string_view OPPFile::getUTF8(uint16_t index) const
+{
+	const uint8_t* entry = getConstant(index, CUTF8);
+	return std::string_view((const char*) entry + 2, readU16(entry));
+}
+
+std::u16string OPPFile::getStringLiteral(uint16_t index) const
+{
+	const uint8_t* entry = getConstant(index, CSTRLIT);
+	std::u16string value(readU16(entry) / 2, u'\0');
+	for(size_t i = 0 ; i < value.length() ; ++i)
+		value[i] = readU16(entry + 2 + 2 * i);
+	return value;
+}
+
+opp_fnlit_t OPPFile::getFunctionLiteral(uint16_t index) const
+{
+	const uint8_t* entry = getConstant(index, CFNLIT);
+	opp_fnlit_t fnlit = { .offset = readU32(entry), .length = readU16(entry + 4) };
+	if(fnlit.offset > this->contents.length() - this->poolOffset
+		|| fnlit.length > this->contents.length() - this->poolOffset - fnlit.offset)
+		throw FormatError("Function #" + std::to_string(index) + " exceeds the bytecode pool of OPP file " + this->url.toString());
+	return fnlit;
+}
+
+uint64_t OPPFile::getLiteralBits(uint16_t index) const
+{
+	const_sig_t signature = getConstantSignature(index);
+	const uint8_t* entry = (const uint8_t*) this->contents.data() + this->constants[index] + 1;
+	switch(signature)
+	{
+		case CUINTLIT:
+		case CINTLIT:
+		case CFLTLIT:
+			return readU32(entry);
+		case CULNGLIT:
+		case CLNGLIT:
+		case CDBLLIT:
+			return readU64(entry);
+		default:
+			throw FormatError("Constant #" + std::to_string(index) + " of OPP file " + this->url.toString() + " is not a numeric literal");
+	}
+}
+
+std::string_view OPPFile::getType(uint16_t index, bool& optional) const
+{
+	const_sig_t signature = getConstantSignature(index);
+	if(signature != CTYPE && signature != COPTTYPE)
+		throw FormatError("Constant #" + std::to_string(index) + " of OPP file " + this->url.toString() + " is not a type");
+
+	const uint8_t* entry = (const uint8_t*) this->contents.data() + this->constants[index] + 1;
+	optional = signature == COPTTYPE;
+	return std::string_view((const char*) entry + 4, readU32(entry));
+}
+
+std::string_view OPPFile::getFunction(const opp_fnlit_t& fnlit) const
+{
+	return this->contents.substr(this->poolOffset + fnlit.offset, fnlit.length);
+}
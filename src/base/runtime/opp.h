@@ -0,0 +1,134 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "base/url.h"
+
+namespace wckt::base
+{
+	/* Function in the bytecode pool */
+	typedef struct
+	{
+		uint32_t offset;
+		uint16_t length;
+	} opp_fnlit_t;
+
+	/* Contract or template property */
+	typedef struct
+	{
+		uint8_t access;
+		uint16_t name;
+		uint16_t type;
+		/* Prefixed by `ef` in a partial template */
+		bool partial;
+	} opp_property_t;
+
+	struct opp_declaration_t
+	{
+		uint8_t signature;
+		uint8_t access;
+		/* CUTF8 name, or 0 for template constructors */
+		uint16_t name;
+		/* CTYPE of type declarations, static properties and constructors */
+		uint16_t type;
+		/* CTYPE extended by contracts and templates, or 0 if none */
+		uint16_t extends;
+		/* CFNLIT implementing constructors */
+		uint16_t impl;
+		std::vector<uint16_t> generics;
+		std::vector<opp_property_t> properties;
+		/* Declarations nested in namespaces, contracts and templates, or cases of switch constructors */
+		std::vector<opp_declaration_t> children;
+	};
+
+	/**
+	 * Compiled asset file, see documentation/bytecode.md. The file is mapped in memory, its header and
+	 * declaration table are decoded up front and constants are located through an offset index.
+	 */
+	class OPPFile
+	{
+		public:
+			static const uint16_t SIGNATURE;
+			static const size_t HEADER_SIZE;
+			/* Version of the file format, files of another major or a later minor version are rejected */
+			static const uint16_t MAJOR_VERSION;
+			static const uint8_t MINOR_VERSION;
+
+			enum decl_sig_t : uint8_t
+			{
+				DECL_TYPE = 0x00,
+				DECL_NAMESPACE = 0x01,
+				DECL_CONTRACT = 0x02,
+				DECL_CONSTRUCTOR = 0x03,
+				DECL_SWITCH_CONSTRUCTOR = 0x04,
+				DECL_TEMPLATE = 0x05,
+				DECL_PARTIAL_TEMPLATE = 0x06,
+				DECL_STATIC_PROPERTY = 0x07
+			};
+
+			enum const_sig_t : uint8_t
+			{
+				CUTF8 = 0x00,
+				CTYPE = 0x01,
+				COPTTYPE = 0x02,
+				CFNLIT = 0x03,
+				CUINTLIT = 0x04,
+				CINTLIT = 0x05,
+				CULNGLIT = 0x06,
+				CLNGLIT = 0x07,
+				CFLTLIT = 0x08,
+				CDBLLIT = 0x09,
+				CSTRLIT = 0x0a
+			};
+
+		private:
+			URL url;
+			std::shared_ptr<URLBuffer> buffer;
+			std::string_view contents;
+
+			uint16_t majorVersion;
+			uint8_t minorVersion;
+			uint64_t timestamp;
+			uint32_t sourceChecksum;
+			uint16_t initializer;
+
+			std::vector<opp_declaration_t> declarations;
+			/* Offset of every constant entry in the file, index 0 stands for none */
+			std::vector<uint32_t> constants;
+			size_t poolOffset;
+
+			void indexConstants(size_t start, size_t end);
+			const uint8_t* getConstant(uint16_t index, const_sig_t signature) const;
+
+		public:
+			OPPFile(const URL& url);
+			OPPFile(const URL& url, std::shared_ptr<URLBuffer> buffer);
+			OPPFile(const OPPFile&) = delete;
+			~OPPFile() = default;
+
+			URL getURL() const;
+			uint16_t getMajorVersion() const;
+			uint8_t getMinorVersion() const;
+			uint64_t getTimestamp() const;
+			uint32_t getSourceChecksum() const;
+			/* Whether the file was compiled from this source, by its checksum */
+			bool matchesSource(std::string_view source) const;
+			/* CFNLIT initializing static properties, or 0 if none */
+			uint16_t getInitializer() const;
+
+			const std::vector<opp_declaration_t>& getDeclarations() const;
+
+			/* Number of constants, valid indices range from 1 to this count */
+			uint16_t getConstantCount() const;
+			const_sig_t getConstantSignature(uint16_t index) const;
+			std::string_view getUTF8(uint16_t index) const;
+			std::u16string getStringLiteral(uint16_t index) const;
+			opp_fnlit_t getFunctionLiteral(uint16_t index) const;
+			/* Raw little-endian value of a numeric literal */
+			uint64_t getLiteralBits(uint16_t index) const;
+			/* Disjunction sub-table of a CTYPE entry, and whether the type is optional */
+			std::string_view getType(uint16_t index, bool& optional) const;
+
+			/* Instructions of a function in the bytecode pool */
+			std::string_view getFunction(const opp_fnlit_t& fnlit) const;
+	};
+}
@@ -0,0 +1,388 @@
+#include "base/engine.h"
+#include "base/runtime/bytecode.h"
+#include "include/exception.h"
+
+using namespace wckt;
+using namespace wckt::base;
+
+/* Entries of the satisfaction cache before it is flushed */
+#define SATISFACTION_CACHE_LIMIT	(1 << 16)
+
+namespace
+{
+	/* Bounds-checked cursor over a sub-table of a CTYPE entry */
+	struct type_reader_t
+	{
+		const OPPFile& file;
+		std::string_view data;
+		size_t pos;
+
+		bool done() const { return this->pos >= this->data.length(); }
+
+		const uint8_t* take(size_t count)
+		{
+			if(count > this->data.length() - this->pos)
+				throw FormatError("Truncated type in OPP file " + this->file.getURL().toString());
+			this->pos += count;
+			return (const uint8_t*) this->data.data() + this->pos - count;
+		}
+
+		uint8_t u8() { return *take(1); }
+		uint16_t u16() { return readU16(take(2)); }
+		uint32_t u32() { return readU32(take(4)); }
+
+		std::string_view sub(size_t count)
+		{
+			return std::string_view((const char*) take(count), count);
+		}
+	};
+
+	enum unit_sig_t : uint8_t
+	{
+		UNIT_CONTRACT = 0x00,
+		UNIT_FUNCTION = 0x01,
+		UNIT_SWITCH_FUNCTION = 0x02,
+		UNIT_REFERENCE = 0x03,
+		UNIT_GENERIC = 0x04
+	};
+
+	/* Type references that name primitive kinds rather than declared types */
+	const std::map<std::string_view, Value::kind_t> BUILTIN_TYPES = {
+		{ "Bool", Value::BOOL }, { "UByte", Value::UBYTE }, { "Byte", Value::BYTE }, { "UShort", Value::USHORT },
+		{ "Short", Value::SHORT }, { "UInt", Value::UINT }, { "Int", Value::INT }, { "ULong", Value::ULONG },
+		{ "Long", Value::LONG }, { "Float", Value::FLOAT }, { "Double", Value::DOUBLE }, { "Char", Value::CHAR },
+		{ "String", Value::STRING }
+	};
+}
+
+/* Whether a value can be invoked with argc arguments, directly or through its call property */
+static bool isCallable(const Value& value, uint8_t argc)
+{
+	if(value.getKind() == Value::FUNCTION)
+		return value.getFunction().getArgCount() == argc;
+	if(value.getKind() != Value::OBJECT)
+		return false;
+	const Value* call = value.getObject().findProperty("call");
+	return call != nullptr && call->getKind() == Value::FUNCTION && call->getFunction().getArgCount() == argc;
+}
+
+/* Whether an object has a function property taking argc arguments, as for switch functions */
+static bool hasCase(const Value& value, uint8_t argc)
+{
+	if(isCallable(value, argc))
+		return true;
+	if(value.getKind() != Value::OBJECT)
+		return false;
+	for(const auto& name : value.getObject().getPropertyNames())
+		if(isCallable(*value.getObject().findProperty(name), argc))
+			return true;
+	return false;
+}
+
+bool Engine::satisfies(const Value& value, uint32_t assetIndex, uint16_t type)
+{
+	satisfaction_state_t state;
+	return satisfiesType(value, assetIndex, type, state);
+}
+
+bool Engine::satisfiesType(const Value& value, uint32_t assetIndex, uint16_t type, satisfaction_state_t& state)
+{
+	const OPPFile& file = *this->assets[assetIndex]->file;
+	bool optional;
+	std::string_view disjunctions = file.getType(type, optional);
+	if(value.isNull())
+		return optional;
+
+	if(value.getKind() != Value::OBJECT)
+	{
+		bool satisfied = false;
+		for(type_reader_t reader = { file, disjunctions, 0 } ; !satisfied && !reader.done() ; )
+			satisfied = satisfiesUnits(value, assetIndex, reader.sub(reader.u32()), state);
+		return satisfied;
+	}
+
+	// Origins and which properties exist are checked once per shape, only the values of properties are left
+	const Object& object = value.getObject();
+	std::shared_ptr<const runtime_plan_t> plan = getPlan(object.getShape(), assetIndex, type);
+	if(plan->empty() || plan->front().empty())
+		return !plan->empty();
+
+	// Recursive types hold coinductively, an object already being checked against this type is assumed to satisfy it
+	std::pair<const void*, const void*> key = { &object, disjunctions.data() };
+	if(!state.assumptions.insert(key).second)
+		return true;
+
+	bool satisfied = false;
+	for(auto alternative = plan->begin() ; !satisfied && alternative != plan->end() ; ++alternative)
+	{
+		satisfied = true;
+		for(auto check = alternative->begin() ; satisfied && check != alternative->end() ; ++check)
+			satisfied = runCheck(value, *check, state);
+	}
+	state.assumptions.erase(key);
+	return satisfied;
+}
+
+bool Engine::satisfiesUnits(const Value& value, uint32_t assetIndex, std::string_view units, satisfaction_state_t& state)
+{
+	const OPPFile& file = *this->assets[assetIndex]->file;
+	for(type_reader_t reader = { file, units, 0 } ; !reader.done() ; )
+	{
+		switch(reader.u8())
+		{
+			case UNIT_CONTRACT:
+				return false;
+
+			case UNIT_FUNCTION:
+			{
+				reader.u16();
+				uint32_t lenArguments = reader.u32(), lenGenerics = reader.u32();
+				reader.take(lenArguments + (size_t) lenGenerics);
+				if(!isCallable(value, lenArguments / 2))
+					return false;
+				break;
+			}
+
+			case UNIT_SWITCH_FUNCTION:
+			{
+				for(type_reader_t cases = { file, reader.sub(reader.u32()), 0 } ; !cases.done() ; )
+				{
+					cases.u16();
+					uint32_t lenArguments = cases.u32(), lenGenerics = cases.u32();
+					cases.take(lenArguments + (size_t) lenGenerics);
+					if(!hasCase(value, lenArguments / 2))
+						return false;
+				}
+				break;
+			}
+
+			case UNIT_REFERENCE:
+			{
+				std::string_view locator = file.getUTF8(reader.u16());
+				reader.take(reader.u32());
+				if(!satisfiesReference(value, assetIndex, locator, state))
+					return false;
+				break;
+			}
+
+			case UNIT_GENERIC:
+				// Generic arguments are erased at runtime
+				reader.u32();
+				break;
+
+			default:
+				throw FormatError("Invalid type unit signature in OPP file " + file.getURL().toString());
+		}
+	}
+	return true;
+}
+
+bool Engine::satisfiesReference(const Value& value, uint32_t assetIndex, std::string_view locator, satisfaction_state_t& state)
+{
+	auto it = this->types.find(locator);
+	if(it == this->types.end())
+	{
+		auto builtin = BUILTIN_TYPES.find(locator);
+		if(builtin == BUILTIN_TYPES.end())
+			throw ExecutionError("No type " + std::string(locator));
+		return value.getKind() == builtin->second;
+	}
+
+	// Contracts and templates are only satisfied by objects
+	const runtime_type_t& type = it->second;
+	return type.declaration->signature == OPPFile::DECL_TYPE
+		&& satisfiesType(value, type.assetIndex, type.declaration->type, state);
+}
+
+std::shared_ptr<const runtime_plan_t> Engine::getPlan(const Shape& shape, uint32_t assetIndex, uint16_t type)
+{
+	uint64_t cacheKey = (uint64_t) shape.getID() << 32 | (this->assets[assetIndex]->typeBase + type);
+	auto cached = this->satisfactionCache.find(cacheKey);
+	if(cached != this->satisfactionCache.end())
+	{
+		this->satisfactionStatistics.hits++;
+		return cached->second;
+	}
+	this->satisfactionStatistics.misses++;
+
+	const OPPFile& file = *this->assets[assetIndex]->file;
+	bool optional;
+	auto plan = std::make_shared<runtime_plan_t>();
+	for(type_reader_t reader = { file, file.getType(type, optional), 0 } ; !reader.done() ; )
+	{
+		std::vector<runtime_check_t> checks;
+		if(!planUnits(shape, assetIndex, reader.sub(reader.u32()), checks))
+			continue;
+
+		// An alternative without checks always holds, the others are never needed
+		if(checks.empty())
+		{
+			plan->assign(1, {});
+			break;
+		}
+		plan->push_back(std::move(checks));
+	}
+
+	// Plans are shared, so one still being run survives the cache being flushed by a nested check
+	// Dictionary shapes change in place, their plans are not kept
+	if(shape.isDictionary())
+		return plan;
+	if(this->satisfactionCache.size() >= SATISFACTION_CACHE_LIMIT)
+		this->satisfactionCache.clear();
+	this->satisfactionCache.emplace(cacheKey, plan);
+	return plan;
+}
+
+bool Engine::planUnits(const Shape& shape, uint32_t assetIndex, std::string_view units, std::vector<runtime_check_t>& checks)
+{
+	const OPPFile& file = *this->assets[assetIndex]->file;
+	for(type_reader_t reader = { file, units, 0 } ; !reader.done() ; )
+	{
+		switch(reader.u8())
+		{
+			case UNIT_CONTRACT:
+			{
+				// Missing properties are null, which only optional types allow
+				for(type_reader_t properties = { file, reader.sub(reader.u32()), 0 } ; !properties.done() ; )
+				{
+					uint32_t slot = shape.find(file.getUTF8(properties.u16()));
+					uint16_t type = properties.u16();
+					bool optional;
+					file.getType(type, optional);
+					if(slot != Shape::npos)
+						checks.push_back({ .kind = runtime_check_t::SLOT_TYPE, .type = type, .slot = slot, .assetIndex = assetIndex });
+					else if(!optional)
+						return false;
+				}
+				break;
+			}
+
+			case UNIT_FUNCTION:
+			{
+				reader.u16();
+				uint32_t lenArguments = reader.u32(), lenGenerics = reader.u32();
+				reader.take(lenArguments + (size_t) lenGenerics);
+				uint32_t slot = shape.find("call");
+				if(slot == Shape::npos)
+					return false;
+				checks.push_back({ .kind = runtime_check_t::SLOT_CALLABLE, .argc = (uint8_t) (lenArguments / 2), .slot = slot });
+				break;
+			}
+
+			case UNIT_SWITCH_FUNCTION:
+			{
+				for(type_reader_t cases = { file, reader.sub(reader.u32()), 0 } ; !cases.done() ; )
+				{
+					cases.u16();
+					uint32_t lenArguments = cases.u32(), lenGenerics = cases.u32();
+					cases.take(lenArguments + (size_t) lenGenerics);
+					if(shape.getSlotCount() == 0)
+						return false;
+					checks.push_back({ .kind = runtime_check_t::OBJECT_CASE, .argc = (uint8_t) (lenArguments / 2) });
+				}
+				break;
+			}
+
+			case UNIT_REFERENCE:
+			{
+				std::string_view locator = file.getUTF8(reader.u16());
+				reader.take(reader.u32());
+				if(!planReference(shape, locator, checks))
+					return false;
+				break;
+			}
+
+			case UNIT_GENERIC:
+				reader.u32();
+				break;
+
+			default:
+				throw FormatError("Invalid type unit signature in OPP file " + file.getURL().toString());
+		}
+	}
+	return true;
+}
+
+bool Engine::planReference(const Shape& shape, std::string_view locator, std::vector<runtime_check_t>& checks)
+{
+	auto it = this->types.find(locator);
+	if(it == this->types.end())
+	{
+		if(BUILTIN_TYPES.find(locator) == BUILTIN_TYPES.end())
+			throw ExecutionError("No type " + std::string(locator));
+		return false;
+	}
+
+	const runtime_type_t& type = it->second;
+	const opp_declaration_t& decl = *type.declaration;
+	if(decl.signature == OPPFile::DECL_TYPE)
+	{
+		checks.push_back({ .kind = runtime_check_t::OBJECT_TYPE, .type = decl.type, .assetIndex = type.assetIndex });
+		return true;
+	}
+
+	// Templates are nominal, only objects initialized by their constructor satisfy them
+	if(decl.signature != OPPFile::DECL_CONTRACT && !shape.hasOrigin(type.locator))
+		return false;
+	if(decl.extends != 0)
+		checks.push_back({ .kind = runtime_check_t::OBJECT_TYPE, .type = decl.extends, .assetIndex = type.assetIndex });
+
+	const OPPFile& file = *this->assets[type.assetIndex]->file;
+	for(const auto& property : decl.properties)
+	{
+		uint32_t slot = shape.find(file.getUTF8(property.name));
+		if(slot != Shape::npos)
+			checks.push_back({ .kind = runtime_check_t::SLOT_TYPE, .type = property.type, .slot = slot, .assetIndex = type.assetIndex });
+		else if(!property.partial)
+			return false;
+	}
+	return true;
+}
+
+bool Engine::runCheck(const Value& value, const runtime_check_t& check, satisfaction_state_t& state)
+{
+	const Object& object = value.getObject();
+	switch(check.kind)
+	{
+		case runtime_check_t::SLOT_TYPE:
+			return satisfiesType(object.getSlot(check.slot), check.assetIndex, check.type, state);
+		case runtime_check_t::SLOT_CALLABLE:
+		{
+			const Value& call = object.getSlot(check.slot);
+			return call.getKind() == Value::FUNCTION && call.getFunction().getArgCount() == check.argc;
+		}
+		case runtime_check_t::OBJECT_TYPE:
+			return satisfiesType(value, check.assetIndex, check.type, state);
+		case runtime_check_t::OBJECT_CASE:
+			return hasCase(value, check.argc);
+	}
+	return false;
+}
+
+const Function* Engine::selectCase(const runtime_constructor_t& constructor, const Value* args)
+{
+	if(constructor.cases.size() == 1)
+		return constructor.cases[0];
+
+	const OPPFile& file = *this->assets[constructor.assetIndex]->file;
+	for(size_t i = 0 ; i < constructor.cases.size() ; ++i)
+	{
+		// Cases are declared with a function type, whose first unit gives the argument types
+		bool optional;
+		type_reader_t disjunctions = { file, file.getType(constructor.types[i], optional), 0 };
+		type_reader_t units = { file, disjunctions.sub(disjunctions.u32()), 0 };
+		if(units.u8() != UNIT_FUNCTION)
+			throw FormatError("Constructor case of non-function type in OPP file " + file.getURL().toString());
+		units.u16();
+		type_reader_t arguments = { file, units.sub(units.u32()), 0 };
+
+		satisfaction_state_t state;
+		bool matches = true;
+		uint8_t argc = constructor.cases[i]->getArgCount();
+		for(uint8_t arg = 0 ; matches && arg < argc && !arguments.done() ; ++arg)
+			matches = satisfiesType(args[arg], constructor.assetIndex, arguments.u16(), state);
+		if(matches)
+			return constructor.cases[i];
+	}
+	throw ExecutionError("No case of constructor " + constructor.cases[0]->getName() + " matches its arguments");
+}
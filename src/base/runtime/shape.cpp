@@ -0,0 +1,129 @@
+#include "base/runtime/shape.h"
+#include "include/exception.h"
+#include <mutex>
+
+using namespace wckt;
+using namespace wckt::base;
+
+const uint32_t Shape::npos = (uint32_t) -1;
+const uint32_t Shape::DICTIONARY_THRESHOLD = 64;
+std::atomic<uint32_t> Shape::nextID = 1;
+
+/* Guards the transitions of every shape of the tree */
+static std::mutex transitionLock;
+
+const Shape& Shape::root()
+{
+	static const Shape root(nullptr);
+	return root;
+}
+
+Shape::Shape(const Shape* parent)
+: id(nextID++), parent(parent), dictionary(false)
+{
+	if(parent == nullptr)
+		return;
+
+	this->names = parent->names;
+	this->slots = parent->slots;
+	this->origins = parent->origins;
+}
+
+uint32_t Shape::getID() const
+{
+	return this->id;
+}
+
+const Shape* Shape::getParent() const
+{
+	return this->parent;
+}
+
+uint32_t Shape::getSlotCount() const
+{
+	return this->names.size();
+}
+
+const std::vector<std::string>& Shape::getPropertyNames() const
+{
+	return this->names;
+}
+
+uint32_t Shape::find(std::string_view name) const
+{
+	auto it = this->slots.find(name);
+	return it == this->slots.end() ? npos : it->second;
+}
+
+bool Shape::canTransition() const
+{
+	return !this->dictionary && this->names.size() < DICTIONARY_THRESHOLD;
+}
+
+const Shape& Shape::withProperty(std::string_view name) const
+{
+	if(this->dictionary)
+		throw BadStateError("Dictionary shapes have no transitions");
+
+	std::lock_guard<std::mutex> guard(transitionLock);
+	auto it = this->transitions.find(name);
+	if(it == this->transitions.end())
+	{
+		std::unique_ptr<Shape> shape(new Shape(this));
+		shape->slots.emplace(std::string(name), shape->names.size());
+		shape->names.push_back(std::string(name));
+		it = this->transitions.emplace(std::string(name), std::move(shape)).first;
+	}
+	return *it->second;
+}
+
+bool Shape::hasOrigin(std::string_view origin) const
+{
+	return std::find(this->origins.begin(), this->origins.end(), origin) != this->origins.end();
+}
+
+const Shape& Shape::withOrigin(std::string_view origin) const
+{
+	if(hasOrigin(origin))
+		return *this;
+	if(this->dictionary)
+		throw BadStateError("Dictionary shapes have no transitions");
+
+	std::lock_guard<std::mutex> guard(transitionLock);
+	auto it = this->originTransitions.find(origin);
+	if(it == this->originTransitions.end())
+	{
+		std::unique_ptr<Shape> shape(new Shape(this));
+		shape->origins.push_back(std::string(origin));
+		it = this->originTransitions.emplace(std::string(origin), std::move(shape)).first;
+	}
+	return *it->second;
+}
+
+bool Shape::isDictionary() const
+{
+	return this->dictionary;
+}
+
+std::unique_ptr<Shape> Shape::toDictionary() const
+{
+	std::unique_ptr<Shape> shape(new Shape(this));
+	shape->dictionary = true;
+	return shape;
+}
+
+void Shape::addProperty(std::string_view name)
+{
+	if(!this->dictionary)
+		throw BadStateError("Only dictionary shapes change in place");
+	this->slots.emplace(std::string(name), this->names.size());
+	this->names.push_back(std::string(name));
+}
+
+void Shape::addOrigin(std::string_view origin)
+{
+	if(!this->dictionary)
+		throw BadStateError("Only dictionary shapes change in place");
+	if(!hasOrigin(origin))
+		this->origins.push_back(std::string(origin));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "include/definitions.h"
+#include <atomic>
+
+namespace wckt::base
+{
+	/**
+	 * Hidden class of runtime objects, giving the slot of every property in the order they were added and
+	 * the templates which initialized them. Shapes form a transition tree from the empty root shape, so
+	 * objects which gain the same properties and origins in the same order (such as those created by the
+	 * same template constructor) share a shape, and its ID identifies their layout in inline caches.
+	 *
+	 * Every shape of the tree holds its own copy of the slots, which is cheap for the few properties of most
+	 * objects. Objects gaining more than DICTIONARY_THRESHOLD properties, such as large static packages or
+	 * objects used as maps, leave the tree for a dictionary shape of their own, which they change in place
+	 * and which is never recorded in caches. The tree is shared by every engine and its transitions are
+	 * locked, a shape's slots never change once it is in the tree.
+	 */
+	class Shape
+	{
+		public:
+			static const uint32_t npos;
+			/* Number of properties past which objects get a dictionary shape */
+			static const uint32_t DICTIONARY_THRESHOLD;
+
+			/* Shape of objects without properties, such as those pushed by `new` */
+			static const Shape& root();
+
+		private:
+			static std::atomic<uint32_t> nextID;
+
+			uint32_t id;
+			const Shape* parent;
+			bool dictionary;
+			std::vector<std::string> names;
+			std::map<std::string, uint32_t, std::less<>> slots;
+			/* Locators of the templates whose constructors initialized objects of this shape */
+			std::vector<std::string> origins;
+			mutable std::map<std::string, std::unique_ptr<Shape>, std::less<>> transitions;
+			mutable std::map<std::string, std::unique_ptr<Shape>, std::less<>> originTransitions;
+
+			Shape(const Shape* parent);
+
+		public:
+			Shape(const Shape&) = delete;
+			~Shape() = default;
+
+			uint32_t getID() const;
+			const Shape* getParent() const;
+			uint32_t getSlotCount() const;
+			const std::vector<std::string>& getPropertyNames() const;
+
+			/* Slot of a property, or npos */
+			uint32_t find(std::string_view name) const;
+			/* Whether objects may transition to withProperty, false for dictionary shapes and those at the threshold */
+			bool canTransition() const;
+			/* Shape with a property appended in the next slot, shared by every object making this transition */
+			const Shape& withProperty(std::string_view name) const;
+
+			bool hasOrigin(std::string_view origin) const;
+			/* Shape with the same slots and an added origin */
+			const Shape& withOrigin(std::string_view origin) const;
+
+			bool isDictionary() const;
+			/* Dictionary shape with the same slots and origins, owned by a single object */
+			std::unique_ptr<Shape> toDictionary() const;
+			/* Appends a property to a dictionary shape */
+			void addProperty(std::string_view name);
+			/* Adds an origin to a dictionary shape */
+			void addOrigin(std::string_view origin);
+	};
+}
@@ -0,0 +1,461 @@
+#include "base/runtime/value.h"
+#include "base/runtime/bytecode.h"
+#include "include/exception.h"
+
+using namespace wckt;
+using namespace wckt::base;
+
+String::String(std::u16string&& value)
+: value(std::move(value))
+{}
+
+const std::u16string& String::getValue() const
+{
+	return this->value;
+}
+
+std::string Value::getKindName(kind_t kind)
+{
+	static const char* const NAMES[] = {
+		"null", "Bool", "UByte", "Byte", "UShort", "Short", "UInt", "Int", "ULong", "Long", "Float", "Double", "Char",
+		"String", "object", "function"
+	};
+	return NAMES[kind];
+}
+
+Value::Value()
+: kind(NONE), integer(0)
+{}
+
+Value Value::fromBool(bool value)
+{
+	Value result;
+	result.kind = BOOL;
+	result.boolean = value;
+	return result;
+}
+
+Value Value::fromInteger(kind_t kind, int64_t value)
+{
+	Value result;
+	result.kind = kind;
+	switch(kind)
+	{
+		case UBYTE:		result.integer = (uint8_t) value; break;
+		case BYTE:		result.integer = (int8_t) value; break;
+		case USHORT:
+		case CHAR:		result.integer = (uint16_t) value; break;
+		case SHORT:		result.integer = (int16_t) value; break;
+		case UINT:		result.integer = (uint32_t) value; break;
+		case INT:		result.integer = (int32_t) value; break;
+		case ULONG:
+		case LONG:		result.integer = value; break;
+		default:
+			throw BadArgumentError(getKindName(kind) + " is not an integral kind");
+	}
+	return result;
+}
+
+Value Value::fromReal(kind_t kind, double value)
+{
+	Value result;
+	result.kind = kind;
+	if(kind == FLOAT)
+		result.real = (float) value;
+	else if(kind == DOUBLE)
+		result.real = value;
+	else throw BadArgumentError(getKindName(kind) + " is not a real kind");
+	return result;
+}
+
+Value Value::fromString(std::u16string&& value)
+{
+	Value result;
+	result.kind = STRING;
+	result.ref = std::make_shared<String>(std::move(value));
+	return result;
+}
+
+Value Value::fromObject(std::shared_ptr<Object> object)
+{
+	Value result;
+	result.kind = OBJECT;
+	result.ref = object;
+	return result;
+}
+
+Value Value::fromFunction(const Function& function, std::shared_ptr<Object> receiver)
+{
+	Value result;
+	result.kind = FUNCTION;
+	result.function = &function;
+	result.ref = receiver;
+	return result;
+}
+
+Value::kind_t Value::getKind() const
+{
+	return this->kind;
+}
+
+bool Value::isNull() const
+{
+	return this->kind == NONE;
+}
+
+bool Value::isIntegral() const
+{
+	return (this->kind >= UBYTE && this->kind <= LONG) || this->kind == CHAR;
+}
+
+bool Value::isReal() const
+{
+	return this->kind == FLOAT || this->kind == DOUBLE;
+}
+
+bool Value::getBool() const
+{
+	return this->boolean;
+}
+
+int64_t Value::getInteger() const
+{
+	return this->integer;
+}
+
+double Value::getReal() const
+{
+	return this->real;
+}
+
+int64_t Value::toInteger() const
+{
+	return isReal() ? (int64_t) this->real : this->integer;
+}
+
+double Value::toReal() const
+{
+	if(isReal())
+		return this->real;
+	return this->kind == ULONG ? (double) (uint64_t) this->integer : (double) this->integer;
+}
+
+const std::u16string& Value::getString() const
+{
+	return static_cast<const String&>(*this->ref).getValue();
+}
+
+Object& Value::getObject() const
+{
+	return static_cast<Object&>(*this->ref);
+}
+
+std::shared_ptr<Object> Value::getObjectPtr() const
+{
+	return std::static_pointer_cast<Object>(this->ref);
+}
+
+const Function& Value::getFunction() const
+{
+	return *this->function;
+}
+
+std::shared_ptr<Object> Value::getReceiver() const
+{
+	return std::static_pointer_cast<Object>(this->ref);
+}
+
+bool Value::operator==(const Value& other) const
+{
+	if(this->kind != other.kind)
+		return false;
+
+	switch(this->kind)
+	{
+		case NONE:		return true;
+		case BOOL:		return this->boolean == other.boolean;
+		case FLOAT:
+		case DOUBLE:	return this->real == other.real;
+		case STRING:	return getString() == other.getString();
+		case OBJECT:	return this->ref == other.ref;
+		case FUNCTION:	return this->function == other.function && this->ref == other.ref;
+		default:		return this->integer == other.integer;
+	}
+}
+
+bool Value::operator!=(const Value& other) const
+{
+	return !(*this == other);
+}
+
+std::string Value::toString() const
+{
+	switch(this->kind)
+	{
+		case NONE:		return "null";
+		case BOOL:		return this->boolean ? "true" : "false";
+		case ULONG:		return std::to_string((uint64_t) this->integer);
+		case FLOAT:
+		case DOUBLE:
+		{
+			std::ostringstream ss;
+			ss << this->real;
+			return ss.str();
+		}
+		case CHAR:
+		case STRING:
+		{
+			std::u16string value = this->kind == CHAR ? std::u16string(1, (char16_t) this->integer) : getString();
+			std::string result;
+			for(char16_t ch : value)
+				result += ch < 0x80 ? (char) ch : '?';
+			return result;
+		}
+		case OBJECT:	return "[object]";
+		case FUNCTION:	return "[function " + this->function->getName() + "]";
+		default:		return std::to_string(this->integer);
+	}
+}
+
+Object::Object()
+: shape(&Shape::root())
+{}
+
+const Value* Object::findProperty(std::string_view name) const
+{
+	uint32_t slot = this->shape->find(name);
+	return slot == Shape::npos ? nullptr : &this->slots[slot];
+}
+
+void Object::setProperty(std::string_view name, Value value)
+{
+	uint32_t slot = this->shape->find(name);
+	if(slot != Shape::npos)
+		this->slots[slot] = std::move(value);
+	else if(this->shape->canTransition())
+		addSlot(this->shape->withProperty(name), std::move(value));
+	else
+	{
+		if(this->dictionary == nullptr)
+		{
+			this->dictionary = this->shape->toDictionary();
+			this->shape = this->dictionary.get();
+		}
+		this->dictionary->addProperty(name);
+		this->slots.push_back(std::move(value));
+	}
+}
+
+std::vector<std::string> Object::getPropertyNames() const
+{
+	return this->shape->getPropertyNames();
+}
+
+const Shape& Object::getShape() const
+{
+	return *this->shape;
+}
+
+const Value& Object::getSlot(uint32_t slot) const
+{
+	return this->slots[slot];
+}
+
+void Object::setSlot(uint32_t slot, Value value)
+{
+	this->slots[slot] = std::move(value);
+}
+
+void Object::addSlot(const Shape& shape, Value value)
+{
+	this->shape = &shape;
+	this->slots.push_back(std::move(value));
+}
+
+void Object::reserveSlots(uint32_t count)
+{
+	this->slots.reserve(count);
+}
+
+bool Object::hasOrigin(std::string_view origin) const
+{
+	return this->shape->hasOrigin(origin);
+}
+
+void Object::addOrigin(std::string_view origin)
+{
+	if(this->dictionary != nullptr)
+		this->dictionary->addOrigin(origin);
+	else this->shape = &this->shape->withOrigin(origin);
+}
+
+Function::Function(const OPPFile& file, uint32_t assetIndex, uint16_t index, const std::string& name)
+: name(name), file(&file), assetIndex(assetIndex), native(nullptr)
+{
+	std::string_view function = file.getFunction(file.getFunctionLiteral(index));
+	const uint8_t* data = (const uint8_t*) function.data();
+	if(function.length() < 5)
+		throw FormatError("Truncated header of function " + name + " in OPP file " + file.getURL().toString());
+
+	this->argCount = data[0];
+	this->localCount = readU16(data + 1);
+	uint16_t branchCount = readU16(data + 3);
+	if(function.length() < 5 + 2 * (size_t) branchCount)
+		throw FormatError("Truncated branch table of function " + name + " in OPP file " + file.getURL().toString());
+
+	for(uint16_t i = 0 ; i < branchCount ; ++i)
+		this->branches.push_back(readU16(data + 5 + 2 * i));
+	this->code = data + 5 + 2 * branchCount;
+	this->codeLength = function.length() - 5 - 2 * branchCount;
+	verify();
+}
+
+Function::Function(const std::string& name, uint8_t argCount, native_fn_t native)
+: name(name), argCount(argCount), localCount(argCount), file(nullptr), assetIndex(0), code(nullptr), codeLength(0),
+	native(native)
+{}
+
+/* Checks every operand the interpreter relies on without bounds checks, and allocates inline caches */
+void Function::verify()
+{
+	auto fail = [this](const std::string& reason) {
+		throw FormatError("Invalid function " + this->name + " in OPP file " + this->file->getURL().toString() + ": " + reason);
+	};
+
+	if(this->localCount < this->argCount)
+		fail("fewer local slots than arguments");
+
+	std::vector<bool> boundaries(this->codeLength + 1, false);
+	this->cacheIndices.assign(this->codeLength, 0);
+	uint8_t last = OP_NOP;
+	for(size_t pos = 0 ; pos < this->codeLength ; )
+	{
+		boundaries[pos] = true;
+		uint8_t op = this->code[pos];
+		if(op >= MAX_OPCODE_PLUS_ONE)
+			fail("invalid opcode " + std::to_string(op));
+		if(pos + 1 + OPCODE_OPERANDS[op] > this->codeLength)
+			fail("truncated " + std::string(OPCODE_MNEMONICS[op]) + " instruction");
+
+		uint16_t operand = OPCODE_OPERANDS[op] == 2 ? readU16(this->code + pos + 1)
+			: OPCODE_OPERANDS[op] == 1 ? this->code[pos + 1] : 0;
+		switch(op)
+		{
+			case OP_LOAD:
+			case OP_LOADW:
+			case OP_STORE:
+			case OP_STOREW:
+				if(operand >= this->localCount)
+					fail("local slot " + std::to_string(operand) + " out of range");
+				break;
+
+			case OP_CONST:
+			case OP_CONSTW:
+			{
+				OPPFile::const_sig_t signature = this->file->getConstantSignature(operand);
+				if(signature == OPPFile::CTYPE || signature == OPPFile::COPTTYPE)
+					fail("type constants cannot be loaded");
+				if(signature == OPPFile::CFNLIT)
+					this->file->getFunctionLiteral(operand);
+				break;
+			}
+
+			case OP_GETPROP:
+			case OP_GETPROPW:
+			case OP_SETPROP:
+			case OP_SETPROPW:
+				this->cacheIndices[pos] = this->caches.size();
+				this->caches.push_back({});
+				[[fallthrough]];
+			case OP_INVOKECON:
+			case OP_INVOKECONW:
+				this->file->getUTF8(operand);
+				break;
+
+			case OP_SATISFIES:
+			case OP_SATISFIESW:
+			case OP_CHECKTYPE:
+			case OP_CHECKTYPEW:
+			{
+				bool optional;
+				this->file->getType(operand, optional);
+				break;
+			}
+
+			case OP_GOTO:
+			case OP_GOTOW:
+			case OP_GOTOIF:
+			case OP_GOTOIFW:
+			case OP_GOTOIFTRUTHY:
+			case OP_GOTOIFTRUTHYW:
+			case OP_GOTOIFNULL:
+			case OP_GOTOIFNULLW:
+			case OP_GOTOIFNONNULL:
+			case OP_GOTOIFNONNULLW:
+				if(operand >= this->branches.size())
+					fail("branch index " + std::to_string(operand) + " out of range");
+				break;
+		}
+
+		last = op;
+		pos += 1 + OPCODE_OPERANDS[op];
+	}
+
+	// Execution may never run past the last instruction
+	if(last != OP_RETURN && last != OP_VRETURN && last != OP_GOTO && last != OP_GOTOW)
+		fail("missing return at the end of the function");
+
+	for(uint16_t branch : this->branches)
+		if(branch >= this->codeLength || !boundaries[branch])
+			fail("branch target " + std::to_string(branch) + " is not an instruction");
+}
+
+std::string Function::getName() const
+{
+	return this->name;
+}
+
+uint8_t Function::getArgCount() const
+{
+	return this->argCount;
+}
+
+uint16_t Function::getLocalCount() const
+{
+	return this->localCount;
+}
+
+bool Function::isNative() const
+{
+	return this->native != nullptr;
+}
+
+native_fn_t Function::getNative() const
+{
+	return this->native;
+}
+
+const OPPFile& Function::getFile() const
+{
+	return *this->file;
+}
+
+uint32_t Function::getAssetIndex() const
+{
+	return this->assetIndex;
+}
+
+const uint8_t* Function::getCode() const
+{
+	return this->code;
+}
+
+const uint8_t* Function::getBranch(uint16_t index) const
+{
+	return this->code + this->branches[index];
+}
+
+inline_cache_t& Function::getInlineCache(const uint8_t* instruction) const
+{
+	return this->caches[this->cacheIndices[instruction - this->code]];
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "base/runtime/opp.h"
+#include "base/runtime/shape.h"
+
+/* Number of shapes an inline cache holds before the instruction is considered megamorphic */
+#define INLINE_CACHE_SIZE	4
+
+namespace wckt::base
+{
+	/* Forward declarations */
+	class Engine;
+	class Object;
+	class Function;
+	class Value;
+
+	/* Native function body, returns whether it produced a result */
+	typedef bool (*native_fn_t)(Engine& engine, const Value& self, const Value* args, Value& result);
+
+	/* Heap-allocated payload of strings and objects */
+	class HeapValue
+	{
+		public:
+			virtual ~HeapValue() = default;
+	};
+
+	class String : public HeapValue
+	{
+		private:
+			std::u16string value;
+
+		public:
+			String(std::u16string&& value);
+			~String() override = default;
+
+			const std::u16string& getValue() const;
+	};
+
+	/**
+	 * Reference or primitive held in a local slot, on the operand stack or in a property. Integers are
+	 * stored sign or zero extended from their width, FLOAT values are rounded to single precision.
+	 * Functions are owned by the engine, a function value only records the receiver it is bound to.
+	 */
+	class Value
+	{
+		public:
+			enum kind_t : uint8_t
+			{
+				NONE,
+				BOOL,
+				UBYTE,
+				BYTE,
+				USHORT,
+				SHORT,
+				UINT,
+				INT,
+				ULONG,
+				LONG,
+				FLOAT,
+				DOUBLE,
+				CHAR,
+				STRING,
+				OBJECT,
+				FUNCTION
+			};
+
+			static std::string getKindName(kind_t kind);
+
+		private:
+			kind_t kind;
+			union
+			{
+				bool boolean;
+				int64_t integer;
+				double real;
+				const Function* function;
+			};
+			/* String or object, or receiver of a bound function */
+			std::shared_ptr<HeapValue> ref;
+
+		public:
+			Value();
+			~Value() = default;
+
+			static Value fromBool(bool value);
+			/* Truncates the value to the width of an integral kind (including CHAR) */
+			static Value fromInteger(kind_t kind, int64_t value);
+			static Value fromReal(kind_t kind, double value);
+			static Value fromString(std::u16string&& value);
+			static Value fromObject(std::shared_ptr<Object> object);
+			static Value fromFunction(const Function& function, std::shared_ptr<Object> receiver = nullptr);
+
+			kind_t getKind() const;
+			bool isNull() const;
+			bool isIntegral() const;
+			bool isReal() const;
+
+			bool getBool() const;
+			int64_t getInteger() const;
+			double getReal() const;
+			/* Integral or real value converted to the given numeric kind's representation */
+			int64_t toInteger() const;
+			double toReal() const;
+
+			const std::u16string& getString() const;
+			Object& getObject() const;
+			std::shared_ptr<Object> getObjectPtr() const;
+			const Function& getFunction() const;
+			/* Receiver of a bound function, or nullptr */
+			std::shared_ptr<Object> getReceiver() const;
+
+			/* Identity for references, value equality for primitives and strings */
+			bool operator==(const Value& other) const;
+			bool operator!=(const Value& other) const;
+
+			std::string toString() const;
+	};
+
+	/* Object whose properties are stored in the slots given by its shape, which also records its origins */
+	class Object : public HeapValue
+	{
+		private:
+			const Shape* shape;
+			/* Shape of the object once it has left the transition tree, which shape then points to */
+			std::unique_ptr<Shape> dictionary;
+			std::vector<Value> slots;
+
+		public:
+			Object();
+			~Object() override = default;
+
+			/* Returns nullptr if there is no such property */
+			const Value* findProperty(std::string_view name) const;
+			/* Adding a property transitions the object to a new shape, or a dictionary shape past the threshold */
+			void setProperty(std::string_view name, Value value);
+			std::vector<std::string> getPropertyNames() const;
+
+			const Shape& getShape() const;
+			/* Fixed-offset access to a slot of the object's shape */
+			const Value& getSlot(uint32_t slot) const;
+			void setSlot(uint32_t slot, Value value);
+			/* Transitions to a shape extending the current one by one property, and stores it */
+			void addSlot(const Shape& shape, Value value);
+			/* Preallocates slots for objects expected to gain a known number of properties */
+			void reserveSlots(uint32_t count);
+
+			bool hasOrigin(std::string_view origin) const;
+			void addOrigin(std::string_view origin);
+	};
+
+	/* Inline cache of a property instruction, recording the slot of the property in up to INLINE_CACHE_SIZE shapes */
+	typedef struct
+	{
+		/* Shape IDs, 0 for unused entries */
+		uint32_t shapes[INLINE_CACHE_SIZE];
+		uint32_t slots[INLINE_CACHE_SIZE];
+		/* Shape an object transitions to when setprop adds the property, or nullptr */
+		const Shape* transitions[INLINE_CACHE_SIZE];
+	} inline_cache_t;
+
+	/**
+	 * Bytecode or native function. Bytecode functions start with a header giving their argument count,
+	 * local slot count and branch table (see documentation/bytecode.md), and are verified on creation so
+	 * the interpreter can trust operands, local indices and branch targets.
+	 */
+	class Function
+	{
+		private:
+			std::string name;
+			uint8_t argCount;
+			uint16_t localCount;
+
+			/* Bytecode functions only */
+			const OPPFile* file;
+			uint32_t assetIndex;
+			const uint8_t* code;
+			size_t codeLength;
+			std::vector<uint16_t> branches;
+			/* Inline caches of property instructions, and the cache of every such instruction by offset */
+			mutable std::vector<inline_cache_t> caches;
+			std::vector<uint16_t> cacheIndices;
+
+			/* Native functions only */
+			native_fn_t native;
+
+			void verify();
+
+		public:
+			Function(const OPPFile& file, uint32_t assetIndex, uint16_t index, const std::string& name);
+			Function(const std::string& name, uint8_t argCount, native_fn_t native);
+			Function(const Function&) = delete;
+			~Function() = default;
+
+			std::string getName() const;
+			uint8_t getArgCount() const;
+			uint16_t getLocalCount() const;
+
+			bool isNative() const;
+			native_fn_t getNative() const;
+
+			const OPPFile& getFile() const;
+			uint32_t getAssetIndex() const;
+			const uint8_t* getCode() const;
+			/* Instruction at branch index */
+			const uint8_t* getBranch(uint16_t index) const;
+			/* Inline cache of a getprop or setprop instruction */
+			inline_cache_t& getInlineCache(const uint8_t* instruction) const;
+	};
+}
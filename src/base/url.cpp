@@ -1,11 +1,149 @@
 #include "base/url.h"
 #include "include/strutil.h"
 #include "include/exception.h"
+#include <mutex>
+#include <shared_mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#define URL_USE_MMAP
+#endif
 
 using namespace wckt::base;
 
+/* Files smaller than this are read rather than mapped, as mapping costs more than copying them */
+#define MMAP_THRESHOLD	(64 * 1024)
+
 namespace
 {
+	/**
+	 * Canonical forms of paths and whether they are directories, so the file system is asked once per
+	 * path string. Canonical paths resolve every link, including in file names. A file that is not a link
+	 * only costs a lookup of its directory, which is cached, and a check of its own name. Files are assumed
+	 * not to be replaced by links, nor the working directory changed, while the engine runs. Missing paths
+	 * are not cached, as they may be created later.
+	 */
+	class StatCache
+	{
+		private:
+			std::shared_mutex lock;
+			std::filesystem::path workingDirectory;
+			std::unordered_map<std::string, std::string> canonicalPaths;
+			std::unordered_map<std::string, bool> directories;
+			
+			StatCache()
+			{
+				std::error_code error;
+				this->workingDirectory = std::filesystem::current_path(error);
+			}
+			
+			std::string find(const std::string& path)
+			{
+				std::shared_lock<std::shared_mutex> guard(this->lock);
+				auto it = this->canonicalPaths.find(path);
+				return it != this->canonicalPaths.end() ? it->second : std::string();
+			}
+			
+			std::string insert(const std::string& path, const std::string& canonicalPath)
+			{
+				std::unique_lock<std::shared_mutex> guard(this->lock);
+				return this->canonicalPaths.emplace(path, canonicalPath).first->second;
+			}
+			
+			static std::string join(const std::string& directory, std::string_view name)
+			{
+				return directory + (!directory.empty() && directory.back() == '/' ? "" : "/") + std::string(name);
+			}
+			
+			/* Whether the path has no empty, '.' or '..' components, as most paths written in modulefiles */
+			static bool isNormal(std::string_view path)
+			{
+				size_t start = !path.empty() && path.front() == '/';
+				for(;;)
+				{
+					size_t end = path.find('/', start);
+					std::string_view part = path.substr(start, end == std::string_view::npos ? end : end - start);
+					if(part.empty() || part == "." || part == "..")
+						return false;
+					if(end == std::string_view::npos)
+						return true;
+					start = end + 1;
+				}
+			}
+		
+		public:
+			static StatCache& instance()
+			{
+				static StatCache cache;
+				return cache;
+			}
+			
+			/* Lexically normal absolute path if the path does not exist */
+			std::string canonical(const std::string& path)
+			{
+				// Normal paths are made absolute without building filesystem paths
+				std::string absolute = !isNormal(path) ? (this->workingDirectory / path).lexically_normal().string()
+					: path.front() == '/' ? path : join(this->workingDirectory.string(), path);
+				std::string result = find(absolute);
+				if(!result.empty())
+					return result;
+				
+				std::error_code error;
+				std::filesystem::file_status status = std::filesystem::symlink_status(absolute, error);
+				if(error || !std::filesystem::exists(status))
+					return absolute;
+				
+				size_t slash = absolute.rfind('/');
+				if(std::filesystem::is_symlink(status) || slash == 0 || slash + 1 == absolute.length())
+				{
+					std::filesystem::path resolved = std::filesystem::canonical(absolute, error);
+					return error ? absolute : insert(absolute, resolved.string());
+				}
+				return insert(absolute, join(canonical(absolute.substr(0, slash)), std::string_view(absolute).substr(slash + 1)));
+			}
+			
+			bool isDirectory(const std::string& path)
+			{
+				{
+					std::shared_lock<std::shared_mutex> guard(this->lock);
+					auto it = this->directories.find(path);
+					if(it != this->directories.end())
+						return it->second;
+				}
+				
+				std::error_code error;
+				std::filesystem::file_status status = std::filesystem::status(path, error);
+				if(error || !std::filesystem::exists(status))
+					return false;
+				
+				std::unique_lock<std::shared_mutex> guard(this->lock);
+				return this->directories.emplace(path, std::filesystem::is_directory(status)).first->second;
+			}
+	};
+	
+#ifdef URL_USE_MMAP
+	class MappedBuffer : public URLBuffer
+	{
+		private:
+			void* address;
+			size_t length;
+		
+		public:
+			MappedBuffer(void* address, size_t length)
+			: address(address), length(length)
+			{}
+			
+			~MappedBuffer() override
+			{ munmap(this->address, this->length); }
+			
+			std::string_view getView() const override
+			{ return std::string_view((const char*) this->address, this->length); }
+	};
+#endif
+	
 	struct StringProtocol : public URLProtocol
 	{
 		~StringProtocol() override = default;
@@ -14,20 +152,20 @@ namespace
 		{
 			return std::make_unique<std::istringstream>(source);
 		}
+		
+		std::shared_ptr<URLBuffer> map(const std::string& source, std::shared_ptr<URL> parent) const override
+		{
+			return std::make_shared<StringBuffer>(std::string(source));
+		}
 
 		std::unique_ptr<std::ostream> ostream(const std::string& source, std::shared_ptr<URL> parent, bool textMode) const override
 		{
 			throw UnsupportedOperationError("StringProtocol::ostream");
 		}
 
-		bool equals(const std::string& s0, std::shared_ptr<URL> p0, const std::string& s1, std::shared_ptr<URL> p1) const override
+		std::string key(const std::string& source, std::shared_ptr<URL> parent) const override
 		{
-			return s0 == s1;
-		}
-		
-		std::size_t hash(const std::string& source, std::shared_ptr<URL> parent) const override
-		{
-			return 4095 ^ (std::hash<std::string>()(source) << 1);
+			return source;
 		}
 		
 		std::string append(const std::string& source, const std::string& elem) const override
@@ -40,62 +178,75 @@ namespace
 	{
 		~FileProtocol() override = default;
 		
-		static inline std::filesystem::path computePath(const std::string& source, std::shared_ptr<URL> parent)
+		/* Source relative to the directory of a file parent, joined as std::filesystem::path would */
+		static inline std::string computePath(const std::string& source, std::shared_ptr<URL> parent)
 		{
-			std::filesystem::path sourcepath = source;
-			if(parent != nullptr && parent->getProtocol() == URL::FILE_PROTOCOL)
+			if(parent == nullptr || parent->getProtocol() != URL::FILE_PROTOCOL || (!source.empty() && source.front() == '/'))
+				return source;
+			
+			std::string directory = parent->getSource();
+			if(!StatCache::instance().isDirectory(directory))
 			{
-				std::filesystem::path parentSourcepath = parent->getSource();
-				if(!std::filesystem::is_directory(parentSourcepath))
-					parentSourcepath = parentSourcepath.parent_path();
-				
-				sourcepath = parentSourcepath / sourcepath;
-			}
-			return sourcepath;
-		}
-		
-		static inline std::filesystem::path canonical(const std::filesystem::path& path, std::shared_ptr<URL> parent)
-		{
-			try
-			{
-				return std::filesystem::canonical(path);
-			}
-			catch(const std::filesystem::filesystem_error& e)
-			{
-				throw IOError(std::string("Could not locate file: ") + e.what());
+				size_t slash = directory.rfind('/');
+				directory = slash == std::string::npos ? "" : directory.substr(0, slash == 0 ? 1 : slash);
 			}
+			if(directory.empty())
+				return source;
+			return directory + (directory.back() == '/' ? "" : "/") + source;
 		}
 		
 		std::unique_ptr<std::istream> istream(const std::string& source, std::shared_ptr<URL> parent, bool textMode) const override
 		{
-			auto sourcepath = computePath(source, parent);
+			std::filesystem::path sourcepath = computePath(source, parent);
 			auto stream = std::make_unique<std::ifstream>(sourcepath.c_str(), std::ios::in | (textMode ? (std::ios::openmode) 0 : std::ios::binary));
 			if(!stream->is_open())
 				throw IOError("Could not open file: " + sourcepath.string());
 			return stream;
 		}
 
+#ifdef URL_USE_MMAP
+		std::shared_ptr<URLBuffer> map(const std::string& source, std::shared_ptr<URL> parent) const override
+		{
+			std::filesystem::path sourcepath = computePath(source, parent);
+			int fd = open(sourcepath.c_str(), O_RDONLY);
+			if(fd < 0)
+				throw IOError("Could not open file: " + sourcepath.string());
+			
+			struct stat info;
+			if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size < MMAP_THRESHOLD)
+			{
+				close(fd);
+				return URLProtocol::map(source, parent);
+			}
+			
+			void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if(address == MAP_FAILED)
+				return URLProtocol::map(source, parent);
+			
+			// Sources are scanned front to back once, let the kernel read ahead aggressively
+			madvise(address, info.st_size, MADV_SEQUENTIAL);
+			return std::make_shared<MappedBuffer>(address, info.st_size);
+		}
+#endif
+		
 		std::unique_ptr<std::ostream> ostream(const std::string& source, std::shared_ptr<URL> parent, bool textMode) const override
 		{
-			auto sourcepath = computePath(source, parent);
+			std::filesystem::path sourcepath = computePath(source, parent);
 			auto stream = std::make_unique<std::ofstream>(sourcepath.c_str(), std::ios::out | (textMode ? (std::ios::openmode) 0 : std::ios::binary));
 			if(!stream->is_open())
 				throw IOError("Could not open file: " + sourcepath.string());
 			return stream;
 		}
 
-		bool equals(const std::string& s0, std::shared_ptr<URL> p0, const std::string& s1, std::shared_ptr<URL> p1) const override
+		std::string key(const std::string& source, std::shared_ptr<URL> parent) const override
 		{
-			auto path0 = computePath(s0, p0), path1 = computePath(s1, p1);
-			auto norm0 = canonical(path0, p0), norm1 = canonical(path1, p1);
-			return norm0 == norm1;
+			return StatCache::instance().canonical(computePath(source, parent));
 		}
 		
-		std::size_t hash(const std::string& source, std::shared_ptr<URL> parent) const override
+		bool internsKeys() const override
 		{
-			auto path = computePath(source, parent);
-			auto norm = canonical(path, parent);
-			return 65535 ^ (std::hash<std::string>()(norm.string()) << 2);
+			return true;
 		}
 		
 		std::string append(const std::string& source, const std::string& elem) const override
@@ -106,6 +257,27 @@ namespace
 	};	
 }
 
+StringBuffer::StringBuffer(std::string&& contents)
+: contents(std::move(contents))
+{}
+
+std::string_view StringBuffer::getView() const
+{
+	return this->contents;
+}
+
+std::shared_ptr<URLBuffer> URLProtocol::map(const std::string& source, std::shared_ptr<URL> parent) const
+{
+	std::ostringstream contents;
+	contents << istream(source, parent, false)->rdbuf();
+	return std::make_shared<StringBuffer>(std::move(contents).str());
+}
+
+bool URLProtocol::internsKeys() const
+{
+	return false;
+}
+
 const std::shared_ptr<URLProtocol> URL::STRING_PROTOCOL(new StringProtocol());
 const std::shared_ptr<URLProtocol> URL::FILE_PROTOCOL(new FileProtocol());
 
@@ -119,6 +291,7 @@ URL::URL()
 	this->protocol = nullptr;
 	this->source = "";
 	this->parent = nullptr;
+	computeKey();
 }
 
 URL::URL(std::shared_ptr<URLProtocol> protocol, const std::string& source, std::shared_ptr<URL> parent)
@@ -126,6 +299,7 @@ URL::URL(std::shared_ptr<URLProtocol> protocol, const std::string& source, std::
     this->protocol = protocol;
     this->source = source;
 	this->parent = parent;
+	computeKey();
 }
 
 URL::URL(const std::string& value, std::shared_ptr<URL> parent)
@@ -164,6 +338,23 @@ URL::URL(const std::string& value, std::shared_ptr<URL> parent)
     this->source = source;
     this->protocol = protocolObj;
 	this->parent = parent;
+	computeKey();
+}
+
+void URL::computeKey()
+{
+	this->key = ATOM_NPOS;
+	this->ownedKey = nullptr;
+	if(this->protocol == nullptr)
+	{
+		this->hash = 3947; // Random hash for void URLs
+		return;
+	}
+	std::string key = this->protocol->key(this->source, this->parent);
+	this->hash = std::hash<std::string_view>()(key) ^ std::hash<URLProtocol*>()(this->protocol.get());
+	if(this->protocol->internsKeys())
+		this->key = AtomTable::intern(key);
+	else this->ownedKey = std::make_shared<const std::string>(std::move(key));
 }
 
 bool URL::isVoid() const
@@ -186,6 +377,13 @@ std::shared_ptr<URL> URL::getParent() const
 	return this->parent;
 }
 
+std::string_view URL::getKey() const
+{
+	if(this->key != ATOM_NPOS)
+		return AtomTable::getString(this->key);
+	return this->ownedKey == nullptr ? std::string_view() : std::string_view(*this->ownedKey);
+}
+
 std::string URL::toString() const
 {
 	return this->protocol == nullptr ? "<null>"
@@ -201,9 +399,16 @@ std::unique_ptr<std::istream> URL::toInputStream(bool textMode) const
 
 std::string URL::read(bool textMode) const
 {
-    std::string result;
-    result.assign(std::istreambuf_iterator<char>(*this->toInputStream(textMode)), std::istreambuf_iterator<char>());
-    return result;
+    std::ostringstream result;
+    result << this->toInputStream(textMode)->rdbuf();
+    return std::move(result).str();
+}
+
+std::shared_ptr<URLBuffer> URL::map() const
+{
+	if(this->protocol == nullptr)
+		throw BadStateError("Cannot read a void URL");
+	return this->protocol->map(this->source, this->parent);
 }
 
 std::unique_ptr<std::ostream> URL::toOutputStream(bool textMode) const
@@ -215,11 +420,9 @@ std::unique_ptr<std::ostream> URL::toOutputStream(bool textMode) const
 
 bool URL::operator==(const URL& other) const
 {
-	if(this->protocol != other.protocol)
+	if(this->protocol != other.protocol || this->key != other.key || this->hash != other.hash)
 		return false;
-	if(this->protocol == nullptr)
-		return true;
-	return this->protocol->equals(this->source, this->parent, other.source, other.parent);
+	return this->ownedKey == other.ownedKey || (this->ownedKey != nullptr && other.ownedKey != nullptr && *this->ownedKey == *other.ownedKey);
 }
 
 bool URL::operator!=(const URL& other) const
@@ -239,6 +442,7 @@ URL& URL::operator+=(const std::string& elem)
 	if(this->protocol == nullptr)
 		return *this;
 	this->source = this->protocol->append(this->source, elem);
+	computeKey();
 	return *this;
 }
 
@@ -254,7 +458,5 @@ std::string URL::getProtocolName(std::shared_ptr<URLProtocol> protocol)
 
 std::size_t __impl_URLHasher__::operator()(const URL& elem) const
 {
-	if(elem.getProtocol() == nullptr)
-		return 3947; // Random hash for void URLs
-	return elem.getProtocol()->hash(elem.getSource(), elem.getParent());
+	return elem.hash;
 }
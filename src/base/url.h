@@ -1,19 +1,45 @@
 #pragma once
 
 #include "include/definitions.h"
+#include "include/atoms.h"
 
 namespace wckt::base
 {
 	class URL;
 	
+	/* Read-only contents of a resource, views into it stay valid as long as the buffer lives */
+	class URLBuffer
+	{
+		public:
+			virtual ~URLBuffer() = default;
+			virtual std::string_view getView() const = 0;
+	};
+	
+	class StringBuffer : public URLBuffer
+	{
+		private:
+			std::string contents;
+		
+		public:
+			StringBuffer(std::string&& contents);
+			~StringBuffer() override = default;
+			
+			std::string_view getView() const override;
+	};
+	
     class URLProtocol
     {
         public:
             virtual ~URLProtocol() = default;
             virtual std::unique_ptr<std::istream> istream(const std::string& source, std::shared_ptr<URL> parent, bool textMode) const = 0;
+			/* Contents of the resource in binary mode, by default read from istream() into a string */
+			virtual std::shared_ptr<URLBuffer> map(const std::string& source, std::shared_ptr<URL> parent) const;
 			virtual std::unique_ptr<std::ostream> ostream(const std::string& source, std::shared_ptr<URL> parent, bool textMode) const = 0;
-            virtual bool equals(const std::string& s0, std::shared_ptr<URL> p0, const std::string& s1, std::shared_ptr<URL> p1) const = 0;
-			virtual std::size_t hash(const std::string& source, std::shared_ptr<URL> parent) const = 0;
+			/* Normalized name of the resource, URLs of the same protocol and key name the same resource */
+			virtual std::string key(const std::string& source, std::shared_ptr<URL> parent) const = 0;
+			/* Whether keys are interned, which suits protocols naming a bounded set of resources such as files.
+			   Interned keys are never freed, so protocols whose sources are the contents themselves keep them per URL. */
+			virtual bool internsKeys() const;
 			virtual std::string append(const std::string& source, const std::string& elem) const = 0;
     };
 	
@@ -33,6 +59,13 @@ namespace wckt::base
             std::shared_ptr<URLProtocol> protocol;
             std::string source;
 			std::shared_ptr<URL> parent;
+			/* Computed once on construction so comparing and hashing never touch the resource. Keys of protocols that
+			   intern them are atoms, other keys are shared by copies of the URL and compared by hash then contents. */
+			atom_t key;
+			std::shared_ptr<const std::string> ownedKey;
+			std::size_t hash;
+			
+			void computeKey();
         
         public:
 			URL();
@@ -44,11 +77,14 @@ namespace wckt::base
             std::shared_ptr<URLProtocol> getProtocol() const;
             std::string getSource() const;
 			std::shared_ptr<URL> getParent() const;
+			std::string_view getKey() const;
 			
 			std::string toString() const;
 
             std::unique_ptr<std::istream> toInputStream(bool textMode = false) const;
             std::string read(bool textMode = false) const;
+			/* Maps the resource in memory when the protocol supports it, instead of copying it */
+			std::shared_ptr<URLBuffer> map() const;
 			
 			std::unique_ptr<std::ostream> toOutputStream(bool textMode = false) const;
 
@@ -59,6 +95,8 @@ namespace wckt::base
 			URL& operator+=(const std::string& elem);
 			
 			static std::string getProtocolName(std::shared_ptr<URLProtocol> protocol);
+			
+			friend struct __impl_URLHasher__;
     };
 	
 	struct __impl_URLHasher__
@@ -6,19 +6,23 @@ using namespace wckt::base;
 
 TagRule::TagRule(const std::string& name, const std::vector<argument_t>& arguments, const std::vector<std::shared_ptr<TagRule>>& children)
 : name(name), arguments(arguments), children(children)
-{}
+{
+	for(const auto& child : this->children)
+		this->childIndex.emplace(child->getName(), child.get());
+}
 
-std::vector<std::shared_ptr<TagRule>>& TagRule::_getChildren()
+void TagRule::addChild(std::shared_ptr<TagRule> child)
 {
-	return this->children;
+	this->childIndex.emplace(child->getName(), child.get());
+	this->children.push_back(child);
 }
 
-std::string TagRule::getName() const
+const std::string& TagRule::getName() const
 {
 	return this->name;
 }
 
-std::vector<TagRule::argument_t> TagRule::getArguments() const
+const std::vector<TagRule::argument_t>& TagRule::getArguments() const
 {
 	return this->arguments;
 }
@@ -28,6 +32,12 @@ const std::vector<std::shared_ptr<TagRule>>& TagRule::getChildren() const
 	return this->children;
 }
 
+const TagRule* TagRule::findChild(std::string_view name) const
+{
+	auto it = this->childIndex.find(name);
+	return it == this->childIndex.end() ? nullptr : it->second;
+}
+
 #define __PVEC		__vec__
 #define __PVEC_ARG	xmlparse_t& __PVEC
 #define __VSRC		__PVEC.src
@@ -37,11 +47,10 @@ const std::vector<std::shared_ptr<TagRule>>& TagRule::getChildren() const
 #define __VLINEPOS	__PVEC.linePos
 #define __VPARSER	__PVEC.parser
 
-#define __WHITESPACE	std::string("\n\r\t ")
-
 typedef struct
 {
-	std::string src;
+	/* View into the mapped modulefile, so saved parser states are cheap to copy */
+	std::string_view src;
 	uint32_t pos;
 	uint32_t lineNo;
 	uint32_t linePos;
@@ -65,7 +74,7 @@ static std::string getLocatorString(__PVEC_ARG)
 static std::string getTracebackString(__PVEC_ARG)
 {
 	uint32_t endIndex = __VSRC.find('\n', __VLINEPOS);
-	std::string src = endIndex != std::string::npos ? __VSRC.substr(__VLINEPOS, endIndex - __VLINEPOS) : __VSRC.substr(__VLINEPOS);
+	std::string src(endIndex != std::string::npos ? __VSRC.substr(__VLINEPOS, endIndex - __VLINEPOS) : __VSRC.substr(__VLINEPOS));
 	trim(src);
 	uint32_t earliest = std::max((int32_t) 0, (int32_t) __COL0 - __TB_RADIUS);
 	return std::string("--> ") + (earliest > 0 ? "..." : "") + src.substr(earliest, 2 * __TB_RADIUS)
@@ -116,9 +125,14 @@ namespace
 	};
 }
 
+inline static bool isWhitespace(char ch)
+{
+	return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
 inline static void jumpWhitespace(__PVEC_ARG)
 {
-	while(__VPOS < __VSRC.length() && __WHITESPACE.find(__VCHAR) != std::string::npos)
+	while(__VPOS < __VSRC.length() && isWhitespace(__VCHAR))
 	{
 		if(__VCHAR == '\n')
 		{
@@ -168,7 +182,7 @@ static std::string consumeIdentifier(__PVEC_ARG)
 			first = __VCHAR;
 		}
 		
-		return __VSRC.substr(start, __VPOS - start);
+		return std::string(__VSRC.substr(start, __VPOS - start));
 	}
 	else throw parse_error(std::string(1, __VCHAR), "identifier", __PVEC);
 }
@@ -195,7 +209,7 @@ static inline std::string consumeString(__PVEC_ARG)
 		}
 		
 		__VPOS++;
-		return __VSRC.substr(start + 1, __VPOS - 2 - start);
+		return std::string(__VSRC.substr(start + 1, __VPOS - 2 - start));
 	}
 	else throw parse_error(std::string(1, __VCHAR), "string", __PVEC);
 }
@@ -208,22 +222,16 @@ static inline bool foundArgument(const std::vector<TagRule::argument_t>& argumen
 	return false;
 }
 
-static tagoutput_t parseTag(const std::vector<std::shared_ptr<TagRule>>& rules, err::ErrorSentinel& outerSentinel, __PVEC_ARG)
+/* Parses a tag allowed under parent, or the parser's root rule if parent is nullptr */
+static tagoutput_t parseTag(const TagRule* parent, err::ErrorSentinel& outerSentinel, __PVEC_ARG)
 {
 	jumpWhitespace(__PVEC);
 	xmlparse_t pvecCopy = __PVEC;
 	
 	consume('<', __PVEC);
 	std::string header = consumeIdentifier(__PVEC);
-	std::shared_ptr<TagRule> rule = nullptr;
-	for(std::shared_ptr<TagRule> curRule : rules)
-	{
-		if(curRule->getName() == header)
-		{
-			rule = curRule;
-			break;
-		}
-	}
+	const TagRule* rule = parent != nullptr ? parent->findChild(header)
+		: header == __VPARSER->getRule()->getName() ? __VPARSER->getRule().get() : nullptr;
 	if(rule == nullptr)
 		outerSentinel.raise(parse_error("Disallowed tag name \'" + header + "\'", __PVEC));
 	
@@ -255,7 +263,7 @@ static tagoutput_t parseTag(const std::vector<std::shared_ptr<TagRule>>& rules,
 	}
 	
 	TagRule::childmap_t children;
-	for(std::shared_ptr<TagRule> childRule : rule->getChildren())
+	for(const auto& childRule : rule->getChildren())
 		children[childRule->getName()];
 	
 	if(rule->getChildren().size() > 0)
@@ -267,7 +275,7 @@ static tagoutput_t parseTag(const std::vector<std::shared_ptr<TagRule>>& rules,
 				break;
 			__PVEC = tmp;
 			
-			tagoutput_t output = parseTag(rule->getChildren(), outerSentinel, __PVEC);
+			tagoutput_t output = parseTag(rule, outerSentinel, __PVEC);
 			children[output.tagName].push_back(std::move(output.object));
 		}
 		std::string footer = consumeIdentifier(__PVEC);
@@ -304,10 +312,9 @@ std::unique_ptr<XMLObject> XMLParser::build() const
 	
 	std::unique_ptr<XMLObject> outputPtr;
 	outerSentinel.guard<parse_error>([this, &outputPtr](err::ErrorSentinel& es) {
-		xmlparse_t __PVEC = { this->url->read(), 0, 1, 0, this };
-		std::vector<std::shared_ptr<TagRule>> rules = { this->rule };
-		
-		tagoutput_t output = parseTag(rules, es, __PVEC);
+		std::shared_ptr<URLBuffer> buffer = this->url->map();
+		xmlparse_t __PVEC = { buffer->getView(), 0, 1, 0, this };
+		tagoutput_t output = parseTag(nullptr, es, __PVEC);
 		
 		consumeOptional('\0', __PVEC);
 		if(__VCHAR != '\0')
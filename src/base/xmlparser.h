@@ -54,18 +54,23 @@ namespace wckt::base
 			std::string name;
 			std::vector<argument_t> arguments;
 			std::vector<std::shared_ptr<TagRule>> children;
+			/* Children by tag name, the first one winning if names repeat */
+			std::unordered_map<std::string_view, const TagRule*> childIndex;
 			
 		protected:
 			TagRule(const std::string& name, _VECARG(argument_t, arguments), _VECARG(std::shared_ptr<TagRule>, children));
 			
-			std::vector<std::shared_ptr<TagRule>>& _getChildren();
+			/* For recursive rules, whose children cannot all exist when they are constructed */
+			void addChild(std::shared_ptr<TagRule> child);
 			
 		public:
 			virtual ~TagRule() = default;
 			
-			std::string getName() const;
-			std::vector<argument_t> getArguments() const;
+			const std::string& getName() const;
+			const std::vector<argument_t>& getArguments() const;
 			const std::vector<std::shared_ptr<TagRule>>& getChildren() const;
+			/* Returns nullptr if no child rule has the tag name */
+			const TagRule* findChild(std::string_view name) const;
 			
 			virtual _APPLY_TAG_RULE() = 0;
 	};
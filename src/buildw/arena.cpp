@@ -0,0 +1,55 @@
+#include "buildw/arena.h"
+
+using namespace wckt;
+using namespace wckt::build;
+
+const size_t ParseArena::BLOCK_SIZE = 64 * 1024;
+
+ParseArena::ParseArena()
+: cursor(nullptr), limit(nullptr), allocationCount(0), bytesUsed(0)
+{}
+
+void* ParseArena::allocate(size_t size, size_t alignment)
+{
+	uintptr_t address = ((uintptr_t) this->cursor + alignment - 1) & ~(uintptr_t) (alignment - 1);
+	if(this->cursor == nullptr || address + size > (uintptr_t) this->limit)
+	{
+		// Oversized objects get a dedicated block so the current one keeps being filled
+		size_t blockSize = std::max(BLOCK_SIZE, size + alignment);
+		this->blocks.push_back(std::make_unique<uint8_t[]>(blockSize));
+
+		uint8_t* block = this->blocks.back().get();
+		address = ((uintptr_t) block + alignment - 1) & ~(uintptr_t) (alignment - 1);
+		if(blockSize == BLOCK_SIZE)
+		{
+			this->cursor = block;
+			this->limit = block + blockSize;
+		}
+		else
+		{
+			this->allocationCount++;
+			this->bytesUsed += size;
+			return (void*) address;
+		}
+	}
+
+	this->cursor = (uint8_t*) (address + size);
+	this->allocationCount++;
+	this->bytesUsed += size;
+	return (void*) address;
+}
+
+size_t ParseArena::getAllocationCount() const
+{
+	return this->allocationCount;
+}
+
+size_t ParseArena::getBytesUsed() const
+{
+	return this->bytesUsed;
+}
+
+size_t ParseArena::getBlockCount() const
+{
+	return this->blocks.size();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "include/definitions.h"
+
+namespace wckt::build
+{
+	/* Deleter for arena-allocated objects, runs the destructor only (memory is reclaimed with the arena) */
+	struct ArenaDeleter
+	{
+		template<typename _Ty>
+		inline void operator()(_Ty* ptr) const
+		{ ptr->~_Ty(); }
+	};
+
+	/**
+	 * Bump allocator owning every parse object of a translation unit. Objects are carved out of
+	 * large blocks and only destructed individually; the blocks themselves are released together
+	 * when the arena is destroyed, which must happen after every object in it has been destructed.
+	 */
+	class ParseArena
+	{
+		public:
+			static const size_t BLOCK_SIZE;
+
+		private:
+			std::vector<std::unique_ptr<uint8_t[]>> blocks;
+			uint8_t* cursor;
+			uint8_t* limit;
+
+			size_t allocationCount;
+			size_t bytesUsed;
+
+		public:
+			ParseArena();
+			ParseArena(const ParseArena&) = delete;
+			~ParseArena() = default;
+
+			ParseArena& operator=(const ParseArena&) = delete;
+
+			void* allocate(size_t size, size_t alignment);
+
+			template<typename _Ty, typename... _Args>
+			std::unique_ptr<_Ty, ArenaDeleter> make(_Args&&... args)
+			{ return std::unique_ptr<_Ty, ArenaDeleter>(new(allocate(sizeof(_Ty), alignof(_Ty))) _Ty(std::forward<_Args>(args)...)); }
+
+			size_t getAllocationCount() const;
+			size_t getBytesUsed() const;
+			size_t getBlockCount() const;
+	};
+}
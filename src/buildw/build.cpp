@@ -1,7 +1,10 @@
 #include "buildw/build.h"
 #include "buildw/tokenizer.h"
 #include "buildw/parser.h"
+#include "buildw/cache.h"
 #include "include/exception.h"
+#include "include/scheduler.h"
+#include "include/checksum.h"
 #include "ast/general/translation.h"
 
 using namespace wckt;
@@ -14,7 +17,7 @@ BuildContext::BuildContext(std::shared_ptr<base::EngineContext> context, ARG_mod
 {}
 
 BuildContext::BuildContext(const BuildContext& src)
-: context(src.context), moduleID(src.moduleID), assets(src.assets), nextAssetID(src.nextAssetID)
+: context(src.context), moduleID(src.moduleID), assets(src.assets), cache(src.cache), nextAssetID(src.nextAssetID)
 {
 	for(const auto& entry : src.buildInfo)
 		this->buildInfo.insert(std::pair(entry.first, std::make_unique<build_info_t>(*entry.second)));
@@ -29,6 +32,7 @@ BuildContext& BuildContext::operator=(const BuildContext& src)
 	this->moduleID = src.moduleID;
 	this->nextAssetID = src.nextAssetID;
 	this->assets = src.assets;
+	this->cache = src.cache;
 	this->buildInfo.clear();
 	for(const auto& entry : src.buildInfo)
 		this->buildInfo.insert(std::pair(entry.first, std::make_unique<build_info_t>(*entry.second)));
@@ -86,6 +90,16 @@ build_info_t& BuildContext::getBuildInfo(uint32_t assetID) const
 	return *this->buildInfo.at(assetID);
 }
 
+std::shared_ptr<BuildCache> BuildContext::getCache() const
+{
+	return this->cache;
+}
+
+void BuildContext::setCache(std::shared_ptr<BuildCache> cache)
+{
+	this->cache = cache;
+}
+
 uint32_t BuildContext::addAsset(const base::URL& url, const sym::Locator& pckg)
 {
 	if(findAssetID(url) != npos)
@@ -98,29 +112,92 @@ uint32_t BuildContext::addAsset(const base::URL& url, const sym::Locator& pckg)
 	return assetID;
 }
 
-void services::buildFromContext(const BuildContext& context, err::ErrorSentinel* parentSentinel)
+static void buildAsset(const asset_info_t& asset, build_info_t& buildInfo, BuildCache* cache, err::ErrorSentinel& sentinel, std::ostream& out)
 {
-	std::vector<uint32_t> assetIDs = context.getAssetIDs();
-	for(uint32_t assetID : assetIDs)
+	std::shared_ptr<SourceTable> sourceTable;
+	sentinel.guard<IOError>([&sourceTable, &asset](err::ErrorSentinel&) {
+		sourceTable = std::make_shared<SourceTable>(asset.url);
+	});
+	if(sentinel.hasErrors())
+		return;
+	
+	std::string_view source = sourceTable->getSource();
+	uint32_t checksum = 0;
+	if(cache != nullptr)
 	{
-		asset_info_t asset = context.getAsset(assetID);
-		build_info_t& buildInfo = context.getBuildInfo(assetID);
-		err::ErrorSentinel sentinel(parentSentinel, err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+		checksum = crc32(source.data(), source.length());
 		
-		sentinel.guard<IOError>([&buildInfo, &asset](err::ErrorSentinel&) {
-			buildInfo.sourceTable = std::make_shared<SourceTable>(asset.url);
-		});
-		if(sentinel.hasErrors())
-			continue;
-		
-		services::tokenize(buildInfo, &sentinel);
+		// An unchanged source that built cleanly last time keeps its tokens and translation unit
+		if(buildInfo.translationUnit != nullptr && !buildInfo.syntaxErrors
+			&& buildInfo.sourceChecksum == checksum && buildInfo.sourceTable->getSource() == source)
+		{
+			cache->recordMemoryHit();
+			return;
+		}
 		
-		for(const auto& token : *buildInfo.tokenSequence)
-			std::cout << token.toString() << std::endl;
-		
-		services::parse(buildInfo, &sentinel);
+		// One that built cleanly in a previous run is skipped altogether
+		if(cache->isUpToDate(asset.url, source, checksum))
+		{
+			buildInfo = { .sourceTable = sourceTable, .tokenSequence = nullptr, .translationUnit = nullptr,
+				.syntaxErrors = false, .sourceChecksum = checksum };
+			return;
+		}
+	}
+	
+	buildInfo.sourceTable = sourceTable;
+	buildInfo.sourceChecksum = checksum;
+	services::tokenize(buildInfo, &sentinel);
+	services::parse(buildInfo, &sentinel);
+	if(cache != nullptr && !buildInfo.syntaxErrors)
+		cache->recordBuild(asset.url, source, checksum);
+	
+	for(const auto& token : *buildInfo.tokenSequence)
+		out << token.toString(*buildInfo.sourceTable) << std::endl;
+	
+	out << buildInfo.translationUnit->toTreeString() << std::endl;
+	// ...
+}
+
+namespace
+{
+	typedef struct
+	{
+		std::unique_ptr<err::ErrorSentinel> sentinel;
+		std::stringstream output;
+		std::exception_ptr exception;
+	} asset_result_t;
+}
+
+void services::buildFromContext(const BuildContext& context, err::ErrorSentinel* parentSentinel, uint32_t jobs)
+{
+	std::vector<uint32_t> assetIDs = context.getAssetIDs();
+	
+	// Each asset collects into its own root sentinel so workers never touch a shared one
+	std::vector<asset_result_t> results(assetIDs.size());
+	std::vector<WorkScheduler::task_t> tasks;
+	for(size_t i = 0 ; i < assetIDs.size() ; ++i)
+	{
+		asset_result_t& result = results[i];
+		result.sentinel = std::make_unique<err::ErrorSentinel>(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
 		
-		std::cout << buildInfo.translationUnit->toTreeString() << std::endl;
-		// ...
+		asset_info_t asset = context.getAsset(assetIDs[i]);
+		build_info_t& buildInfo = context.getBuildInfo(assetIDs[i]);
+		tasks.push_back([&result, asset, &buildInfo, cache = context.getCache().get()]() {
+			try
+			{ buildAsset(asset, buildInfo, cache, *result.sentinel, result.output); }
+			catch(...)
+			{ result.exception = std::current_exception(); }
+		});
+	}
+	
+	WorkScheduler(jobs).run(std::move(tasks));
+	
+	// Report in asset order, stopping at the first asset that failed fatally as a sequential build would
+	for(auto& result : results)
+	{
+		std::cout << result.output.str();
+		result.sentinel->forward(parentSentinel);
+		if(result.exception)
+			std::rethrow_exception(result.exception);
 	}
 }
@@ -11,6 +11,7 @@ namespace wckt::build
 	/* Forward declarations */
 	class Token;
 	class TranslationUnit;
+	class BuildCache;
 	
 	typedef struct
 	{
@@ -21,8 +22,13 @@ namespace wckt::build
 	typedef struct
 	{
 		std::shared_ptr<SourceTable> sourceTable;
+		/* Both null when the build cache skipped the asset as unchanged since its last clean build */
 		std::shared_ptr<std::vector<Token>> tokenSequence;
 		std::shared_ptr<TranslationUnit> translationUnit;
+		/* Whether tokenizing or parsing the current source raised errors */
+		bool syntaxErrors;
+		/* CRC32 of the source the token sequence and translation unit were built from, 0 if built without a cache */
+		uint32_t sourceChecksum;
 		// ...
 	} build_info_t;
 	
@@ -36,6 +42,7 @@ namespace wckt::build
 			moduleid_t moduleID;
 			std::map<uint32_t, asset_info_t> assets;
 			std::map<uint32_t, std::unique_ptr<build_info_t>> buildInfo;
+			std::shared_ptr<BuildCache> cache;
 			
 			uint32_t nextAssetID;
 			
@@ -54,12 +61,16 @@ namespace wckt::build
 			
 			asset_info_t getAsset(uint32_t assetID) const;
 			build_info_t& getBuildInfo(uint32_t assetID) const;
+			/* Cache used to skip unchanged assets, or nullptr if every asset is rebuilt from scratch */
+			std::shared_ptr<BuildCache> getCache() const;
+			void setCache(std::shared_ptr<BuildCache> cache);
 			
 			uint32_t addAsset(const base::URL& url, const sym::Locator& pckg);
 	};
 	
 	namespace services
 	{
-		void buildFromContext(const BuildContext& context, err::ErrorSentinel* parentSentinel);
+		/* Builds every asset of the context, running up to `jobs` asset pipelines concurrently */
+		void buildFromContext(const BuildContext& context, err::ErrorSentinel* parentSentinel, uint32_t jobs = 1);
 	};
 }
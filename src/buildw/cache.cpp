@@ -0,0 +1,111 @@
+#include "buildw/cache.h"
+#include "include/checksum.h"
+#include <thread>
+
+#ifdef _WIN32
+	#include <process.h>
+	#define getpid _getpid
+#else
+	#include <unistd.h>
+#endif
+
+using namespace wckt;
+using namespace wckt::build;
+
+#define CACHE_SIGNATURE		0x444c4257	/* "WBLD" */
+
+namespace
+{
+	typedef struct
+	{
+		uint32_t signature;
+		uint16_t majorVersion;
+		uint16_t minorVersion;
+		uint32_t checksum;
+		uint32_t reserved;
+		uint64_t sourceHash;
+		uint64_t sourceLength;
+	} cache_record_t;
+}
+
+BuildCache::BuildCache(const std::filesystem::path& directory)
+: directory(directory), memoryHits(0), diskHits(0), misses(0)
+{}
+
+std::filesystem::path BuildCache::getDirectory() const
+{
+	return this->directory;
+}
+
+std::filesystem::path BuildCache::getEntryPath(const base::URL& url) const
+{
+	std::string_view key = url.getKey();
+	std::stringstream ss;
+	ss << std::hex << fnv1a64(key.data(), key.length()) << std::dec << "-v" << WCKT_MAJ_VER << "." << WCKT_MIN_VER << ".wbld";
+	return this->directory / ss.str();
+}
+
+bool BuildCache::isUpToDate(const base::URL& url, std::string_view source, uint32_t checksum)
+{
+	std::ifstream in(getEntryPath(url), std::ios::binary);
+
+	// The checksum and length rule out almost every change before the source is hashed again
+	cache_record_t record;
+	if(!in.read((char*) &record, sizeof(record)) || record.signature != CACHE_SIGNATURE
+		|| record.majorVersion != WCKT_MAJ_VER || record.minorVersion != WCKT_MIN_VER
+		|| record.checksum != checksum || record.sourceLength != source.length()
+		|| record.sourceHash != fnv1a64(source.data(), source.length()))
+	{
+		this->misses++;
+		return false;
+	}
+
+	this->diskHits++;
+	return true;
+}
+
+void BuildCache::recordBuild(const base::URL& url, std::string_view source, uint32_t checksum)
+{
+	cache_record_t record = {
+		.signature = CACHE_SIGNATURE,
+		.majorVersion = WCKT_MAJ_VER,
+		.minorVersion = WCKT_MIN_VER,
+		.checksum = checksum,
+		.reserved = 0,
+		.sourceHash = fnv1a64(source.data(), source.length()),
+		.sourceLength = source.length()
+	};
+
+	// Write to a private file first so concurrent builds never see a partial record, named after the process
+	// as well as the thread since thread IDs of different processes may be equal
+	std::filesystem::path path = getEntryPath(url);
+	std::stringstream tmpName;
+	tmpName << path.filename().string() << ".tmp" << getpid() << "-" << std::this_thread::get_id();
+	std::filesystem::path tmpPath = this->directory / tmpName.str();
+
+	std::error_code ec;
+	std::filesystem::create_directories(this->directory, ec);
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		out.write((const char*) &record, sizeof(record));
+		if(!out)
+		{
+			out.close();
+			std::filesystem::remove(tmpPath, ec);
+			return;
+		}
+	}
+	std::filesystem::rename(tmpPath, path, ec);
+	if(ec)
+		std::filesystem::remove(tmpPath, ec);
+}
+
+void BuildCache::recordMemoryHit()
+{
+	this->memoryHits++;
+}
+
+cache_stats_t BuildCache::getStatistics() const
+{
+	return { .memoryHits = this->memoryHits, .diskHits = this->diskHits, .misses = this->misses };
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "base/url.h"
+#include <atomic>
+
+namespace wckt::build
+{
+	typedef struct
+	{
+		/* Assets whose previous build was reused as is */
+		size_t memoryHits;
+		/* Assets skipped because they are unchanged since their last clean build, by its on-disk record */
+		size_t diskHits;
+		size_t misses;
+	} cache_stats_t;
+
+	/**
+	 * On-disk record of the last clean build of every asset, keyed by the asset URL and the compiler version.
+	 * A record holds the CRC32 and length of the source it was built from (the same checksum stored in OPP
+	 * headers) and a 64-bit hash of it, an asset whose source still matches its record is up to date and is
+	 * neither tokenized nor parsed again. Cache failures never fail a build, they are treated as misses.
+	 */
+	class BuildCache
+	{
+		private:
+			std::filesystem::path directory;
+
+			std::atomic<size_t> memoryHits;
+			std::atomic<size_t> diskHits;
+			std::atomic<size_t> misses;
+
+			std::filesystem::path getEntryPath(const base::URL& url) const;
+
+		public:
+			BuildCache(const std::filesystem::path& directory);
+			BuildCache(const BuildCache&) = delete;
+			~BuildCache() = default;
+
+			std::filesystem::path getDirectory() const;
+
+			/* Whether the asset last built cleanly from this very source */
+			bool isUpToDate(const base::URL& url, std::string_view source, uint32_t checksum);
+			void recordBuild(const base::URL& url, std::string_view source, uint32_t checksum);
+
+			void recordMemoryHit();
+			cache_stats_t getStatistics() const;
+	};
+}
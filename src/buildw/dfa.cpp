@@ -0,0 +1,365 @@
+#include "buildw/dfa.h"
+#include "include/exception.h"
+#include <bitset>
+#include <array>
+#include <limits>
+
+using namespace wckt;
+using namespace wckt::build;
+
+namespace
+{
+	typedef std::bitset<256> charset_t;
+
+	typedef struct
+	{
+		std::vector<uint32_t> epsilon;
+		charset_t chars;
+		uint32_t target;
+		Token::class_t accept;
+	} nfa_node_t;
+
+	typedef struct
+	{
+		uint32_t start;
+		uint32_t end;
+	} fragment_t;
+
+	/* Recursive descent compiler (to a Thompson NFA) for the regexp subset used by the token class table */
+	class RegexCompiler
+	{
+		private:
+			std::vector<nfa_node_t>& nodes;
+			const std::string& regexp;
+			size_t pos;
+
+			inline bool done() const
+			{ return this->pos >= this->regexp.length(); }
+			inline char peek() const
+			{ return this->regexp[this->pos]; }
+
+			[[noreturn]] void fail(const std::string& message) const
+			{ throw FormatError("Malformed token regexp \'" + this->regexp + "\' at " + std::to_string(this->pos) + ": " + message); }
+
+			uint32_t node()
+			{
+				this->nodes.push_back({ {}, charset_t(), 0, Token::__NULL__ });
+				return this->nodes.size() - 1;
+			}
+
+			fragment_t chars(const charset_t& set)
+			{
+				uint32_t start = node(), end = node();
+				this->nodes[start].chars = set;
+				this->nodes[start].target = end;
+				return { start, end };
+			}
+
+			charset_t escape()
+			{
+				if(done())
+					fail("dangling escape");
+
+				charset_t set;
+				char ch = this->regexp[this->pos++];
+				switch(ch)
+				{
+					case 'd':
+						for(char c = '0' ; c <= '9' ; ++c)
+							set.set((uchar_t) c);
+						break;
+					case 's':
+						for(char c : std::string("\n\r\t\f\v "))
+							set.set((uchar_t) c);
+						break;
+					case 'w':
+						for(uint32_t c = 0 ; c < 256 ; ++c)
+							if(std::isalnum(c) || c == '_')
+								set.set(c);
+						break;
+					case 'n': set.set('\n'); break;
+					case 'r': set.set('\r'); break;
+					case 't': set.set('\t'); break;
+					default: set.set((uchar_t) ch);
+				}
+				return set;
+			}
+
+			charset_t bracket()
+			{
+				charset_t set;
+				bool negate = !done() && peek() == '^';
+				if(negate)
+					this->pos++;
+
+				for(bool first = true ; ; first = false)
+				{
+					if(done())
+						fail("unterminated bracket expression");
+					if(peek() == ']' && !first)
+						break;
+
+					if(peek() == '\\')
+					{
+						this->pos++;
+						set |= escape();
+						continue;
+					}
+
+					uchar_t lo = (uchar_t) this->regexp[this->pos++];
+					if(this->pos + 1 < this->regexp.length() && peek() == '-' && this->regexp[this->pos + 1] != ']')
+					{
+						uchar_t hi = (uchar_t) this->regexp[this->pos + 1];
+						this->pos += 2;
+						if(hi < lo)
+							fail("inverted range");
+						for(uint32_t c = lo ; c <= hi ; ++c)
+							set.set(c);
+					}
+					else set.set(lo);
+				}
+
+				this->pos++;
+				return negate ? ~set : set;
+			}
+
+			fragment_t atom()
+			{
+				char ch = this->regexp[this->pos++];
+				switch(ch)
+				{
+					case '(': {
+						fragment_t inner = alternation();
+						if(done() || peek() != ')')
+							fail("expected \')\'");
+						this->pos++;
+						return inner;
+					}
+					case '[':
+						return chars(bracket());
+					case '.': {
+						charset_t set;
+						set.set();
+						set.reset('\n');
+						set.reset('\r');
+						return chars(set);
+					}
+					case '\\':
+						return chars(escape());
+					case '*': case '+': case '?':
+						fail("nothing to repeat");
+					default: {
+						charset_t set;
+						set.set((uchar_t) ch);
+						return chars(set);
+					}
+				}
+			}
+
+			fragment_t repetition()
+			{
+				fragment_t frag = atom();
+				while(!done() && (peek() == '*' || peek() == '+' || peek() == '?'))
+				{
+					char op = this->regexp[this->pos++];
+					uint32_t start = node(), end = node();
+					this->nodes[start].epsilon.push_back(frag.start);
+					this->nodes[frag.end].epsilon.push_back(end);
+					if(op != '+')
+						this->nodes[start].epsilon.push_back(end);
+					if(op != '?')
+						this->nodes[frag.end].epsilon.push_back(frag.start);
+					frag = { start, end };
+				}
+				return frag;
+			}
+
+			fragment_t concatenation()
+			{
+				uint32_t start = node();
+				fragment_t frag = { start, start };
+				while(!done() && peek() != '|' && peek() != ')')
+				{
+					fragment_t next = repetition();
+					this->nodes[frag.end].epsilon.push_back(next.start);
+					frag.end = next.end;
+				}
+				return frag;
+			}
+
+			fragment_t alternation()
+			{
+				fragment_t frag = concatenation();
+				while(!done() && peek() == '|')
+				{
+					this->pos++;
+					fragment_t other = concatenation();
+					uint32_t start = node(), end = node();
+					this->nodes[start].epsilon.push_back(frag.start);
+					this->nodes[start].epsilon.push_back(other.start);
+					this->nodes[frag.end].epsilon.push_back(end);
+					this->nodes[other.end].epsilon.push_back(end);
+					frag = { start, end };
+				}
+				return frag;
+			}
+
+		public:
+			RegexCompiler(std::vector<nfa_node_t>& nodes, const std::string& regexp)
+			: nodes(nodes), regexp(regexp), pos(0)
+			{}
+
+			fragment_t compile()
+			{
+				fragment_t frag = alternation();
+				if(!done())
+					fail("unbalanced \')\'");
+				return frag;
+			}
+	};
+
+	typedef std::vector<uint32_t> nfa_set_t;
+
+	nfa_set_t closure(const std::vector<nfa_node_t>& nodes, const nfa_set_t& seeds)
+	{
+		std::vector<bool> visited(nodes.size(), false);
+		std::vector<uint32_t> stack(seeds.begin(), seeds.end());
+		nfa_set_t output;
+
+		while(!stack.empty())
+		{
+			uint32_t index = stack.back();
+			stack.pop_back();
+			if(visited[index])
+				continue;
+			visited[index] = true;
+			output.push_back(index);
+			for(uint32_t next : nodes[index].epsilon)
+				stack.push_back(next);
+		}
+
+		std::sort(output.begin(), output.end());
+		return output;
+	}
+}
+
+const LexerDFA::state_t LexerDFA::DEAD = 0;
+const LexerDFA::state_t LexerDFA::START = 1;
+
+const LexerDFA& LexerDFA::standard()
+{
+	static const LexerDFA dfa(Token::REGEXPS);
+	return dfa;
+}
+
+LexerDFA::LexerDFA(const std::map<Token::class_t, std::string>& regexps)
+{
+	// Build one NFA with a shared start node branching into every token class
+	std::vector<nfa_node_t> nodes;
+	nodes.push_back({ {}, charset_t(), 0, Token::__NULL__ });
+	for(const auto& entry : regexps)
+	{
+		if(entry.second.empty())
+			continue;
+
+		fragment_t frag = RegexCompiler(nodes, entry.second).compile();
+		nodes[0].epsilon.push_back(frag.start);
+		nodes[frag.end].accept = entry.first;
+	}
+
+	// Subset construction, state 0 is the dead (empty) state and state 1 the start state
+	std::map<nfa_set_t, state_t> ids = { { nfa_set_t(), DEAD } };
+	std::vector<nfa_set_t> sets = { nfa_set_t(), closure(nodes, { 0 }) };
+	ids[sets[START]] = START;
+
+	std::vector<std::array<state_t, 256>> table;
+	for(size_t index = 0 ; index < sets.size() ; ++index)
+	{
+		table.emplace_back();
+		table.back().fill(DEAD);
+
+		Token::class_t accept = Token::__NULL__;
+		for(uint32_t n : sets[index])
+			if(nodes[n].accept != Token::__NULL__ && (accept == Token::__NULL__ || nodes[n].accept < accept))
+				accept = nodes[n].accept;
+		this->accepting.push_back(accept);
+
+		if(index == DEAD)
+			continue;
+
+		for(uint32_t ch = 0 ; ch < 256 ; ++ch)
+		{
+			nfa_set_t seeds;
+			for(uint32_t n : sets[index])
+				if(nodes[n].chars.test(ch))
+					seeds.push_back(nodes[n].target);
+			if(seeds.empty())
+				continue;
+
+			nfa_set_t target = closure(nodes, seeds);
+			auto it = ids.find(target);
+			if(it == ids.end())
+			{
+				if(sets.size() > (size_t) std::numeric_limits<state_t>::max())
+					throw CorruptStateError("Token class regexps produce too many DFA states");
+				it = ids.insert(std::pair(target, (state_t) sets.size())).first;
+				sets.push_back(target);
+			}
+			table[index][ch] = it->second;
+		}
+	}
+
+	// Collapse bytes with identical columns into equivalence classes to keep the table small
+	std::map<std::vector<state_t>, uint8_t> columns;
+	std::vector<std::vector<state_t>> ordered;
+	for(uint32_t ch = 0 ; ch < 256 ; ++ch)
+	{
+		std::vector<state_t> column;
+		for(const auto& row : table)
+			column.push_back(row[ch]);
+
+		auto it = columns.find(column);
+		if(it == columns.end())
+		{
+			it = columns.insert(std::pair(column, (uint8_t) ordered.size())).first;
+			ordered.push_back(column);
+		}
+		this->byteClasses[ch] = it->second;
+	}
+
+	this->classCount = ordered.size();
+	this->transitions.resize(table.size() * this->classCount);
+	for(size_t state = 0 ; state < table.size() ; ++state)
+		for(uint32_t cls = 0 ; cls < this->classCount ; ++cls)
+			this->transitions[state * this->classCount + cls] = ordered[cls][state];
+}
+
+size_t LexerDFA::getStateCount() const
+{
+	return this->accepting.size();
+}
+
+uint32_t LexerDFA::getByteClassCount() const
+{
+	return this->classCount;
+}
+
+size_t LexerDFA::match(std::string_view str, Token::class_t& _class) const
+{
+	size_t length = 0;
+	_class = Token::__NULL__;
+
+	state_t state = START;
+	for(size_t i = 0 ; i < str.length() ; ++i)
+	{
+		state = next(state, str[i]);
+		if(state == DEAD)
+			break;
+		if(this->accepting[state] != Token::__NULL__)
+		{
+			length = i + 1;
+			_class = this->accepting[state];
+		}
+	}
+	return length;
+}
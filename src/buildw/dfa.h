@@ -0,0 +1,44 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "buildw/tokenizer.h"
+
+namespace wckt::build
+{
+	/**
+	 * Table-driven DFA matching every token class at once. The token class regexps are compiled
+	 * into a single automaton (Thompson NFA + subset construction) on first use, where each
+	 * accepting state resolves to the highest priority (lowest ID) class it accepts.
+	 */
+	class LexerDFA
+	{
+		public:
+			typedef uint16_t state_t;
+
+			static const state_t DEAD;
+			static const state_t START;
+
+			static const LexerDFA& standard();
+
+		private:
+			uint8_t byteClasses[256];
+			uint32_t classCount;
+			std::vector<state_t> transitions;
+			std::vector<Token::class_t> accepting;
+
+		public:
+			LexerDFA(const std::map<Token::class_t, std::string>& regexps);
+			~LexerDFA() = default;
+
+			size_t getStateCount() const;
+			uint32_t getByteClassCount() const;
+
+			inline state_t next(state_t state, char ch) const
+			{ return this->transitions[state * this->classCount + this->byteClasses[(uchar_t) ch]]; }
+			inline Token::class_t getAccepted(state_t state) const
+			{ return this->accepting[state]; }
+
+			/* Returns the length of the longest match at the start of str, and its class (or __NULL__ if none) */
+			size_t match(std::string_view str, Token::class_t& _class) const;
+	};
+}
@@ -0,0 +1,179 @@
+#include "buildw/incremental.h"
+#include "buildw/tokenizer.h"
+#include "buildw/parser.h"
+#include "include/exception.h"
+#include "include/checksum.h"
+#include "ast/general/translation.h"
+
+using namespace wckt;
+using namespace wckt::build;
+
+/* Reused declarations keep their arenas alive, past this many a full rebuild compacts them */
+#define MAX_REUSED_ARENAS	16
+
+static inline size_t segmentEnd(const SourceSegment& segment)
+{ return segment.getPosition() + segment.getLength(); }
+
+/* Returns the first token starting at or after position */
+static std::vector<Token>::const_iterator findToken(const std::vector<Token>& tokens, size_t position)
+{
+	return std::lower_bound(tokens.begin(), tokens.end(), position, [](const Token& token, size_t pos) {
+		return token.getPosition() < pos;
+	});
+}
+
+/* Segment covering every token starting at or after position, or an empty one at the end of the stream */
+static SourceSegment coverage(const std::vector<Token>& tokens, size_t position)
+{
+	auto first = findToken(tokens, position);
+	if(first == tokens.end())
+		return SourceSegment(tokens.empty() ? 0 : segmentEnd(tokens.back().getSegment()), 0);
+	return first->getSegment() | tokens.back().getSegment();
+}
+
+static bool rebuildIncremental(build_info_t& buildInfo, std::shared_ptr<SourceTable> sourceTable, const source_edit_t& edit)
+{
+	const std::vector<Token>& previous = *buildInfo.tokenSequence;
+	ptrdiff_t delta = (ptrdiff_t) edit.inserted.length() - (ptrdiff_t) edit.removed;
+	size_t insertedEnd = edit.position + edit.inserted.length();
+
+	ParseTreeDeleter* previousDeleter = std::get_deleter<ParseTreeDeleter>(buildInfo.translationUnit);
+	if(previousDeleter == nullptr || previousDeleter->arenas.size() >= MAX_REUSED_ARENAS)
+		return false;
+
+	// Re-lex from the token before the first one reaching the edit, since tokens may merge across it
+	auto touched = std::lower_bound(previous.begin(), previous.end(), edit.position, [](const Token& token, size_t pos) {
+		return segmentEnd(token.getSegment()) < pos;
+	});
+	size_t first = touched == previous.begin() ? 0 : touched - previous.begin() - 1;
+	size_t restart = touched == previous.begin() ? 0 : previous[first].getPosition();
+
+	// Lex the new source until a token lines up with the same token of the previous sequence after the edit
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	build_info_t relexed = { .sourceTable = sourceTable, .tokenSequence = std::make_shared<std::vector<Token>>(),
+		.translationUnit = nullptr, .syntaxErrors = false, .sourceChecksum = 0 };
+
+	size_t resume = previous.size();
+	bool synced = services::tokenize(relexed, &sentinel, restart, [&](const Token& token) {
+		if(token.getPosition() < insertedEnd)
+			return false;
+
+		auto match = findToken(previous, (size_t) ((ptrdiff_t) token.getPosition() - delta));
+		if(match == previous.end() || (ptrdiff_t) match->getPosition() + delta != (ptrdiff_t) token.getPosition()
+			|| match->getClass() != token.getClass() || match->getLength() != token.getLength())
+			return false;
+
+		resume = match - previous.begin() + 1;
+		return true;
+	});
+	if(sentinel.hasErrors())
+	{
+		sentinel.clear();
+		return false;
+	}
+
+	// Unchanged tokens are carried over, those after the edit moved by delta
+	auto tokens = std::make_shared<std::vector<Token>>();
+	tokens->reserve(first + relexed.tokenSequence->size() + previous.size() - resume);
+	tokens->insert(tokens->end(), previous.begin(), previous.begin() + first);
+	tokens->insert(tokens->end(), relexed.tokenSequence->begin(), relexed.tokenSequence->end());
+	for(size_t i = resume ; i < previous.size() ; ++i)
+		tokens->push_back(previous[i].rebase(delta));
+
+	// Previous source is unchanged before restart and from the synchronizing token onwards
+	size_t resumePosition = synced ? previous[resume - 1].getPosition() : (size_t) -1;
+
+	// Top-level declarations entirely inside the unchanged ranges are reused, imports must not be touched
+	TranslationUnit& unit = *buildInfo.translationUnit;
+	const auto& declarations = unit.getDeclarations().getDeclarations();
+
+	size_t importsEnd = 0;
+	for(const auto& statement : unit.getImportStatements())
+		importsEnd = std::max(importsEnd, segmentEnd(statement->getSegment()));
+	if(importsEnd > restart)
+		return false;
+
+	size_t prefix = 0, boundary = importsEnd;
+	while(prefix < declarations.size() && segmentEnd(declarations[prefix]->getSegment()) <= restart)
+		boundary = segmentEnd(declarations[prefix++]->getSegment());
+
+	size_t suffix = prefix;
+	while(suffix < declarations.size() && declarations[suffix]->getSegment().getPosition() < resumePosition)
+		suffix++;
+	size_t fragmentEnd = suffix < declarations.size() ? declarations[suffix]->getSegment().getPosition() + delta : (size_t) -1;
+
+	// Re-parse the tokens between the reused declarations on their own
+	build_info_t fragment = { .sourceTable = sourceTable,
+		.tokenSequence = std::make_shared<std::vector<Token>>(findToken(*tokens, boundary), findToken(*tokens, fragmentEnd)),
+		.translationUnit = nullptr, .syntaxErrors = false, .sourceChecksum = 0 };
+	try
+	{ services::parse(fragment, &sentinel); }
+	catch(const FatalCompileError&)
+	{
+		sentinel.clear();
+		return false;
+	}
+	catch(...)
+	{
+		sentinel.clear();
+		throw;
+	}
+
+	if(sentinel.hasErrors() || !fragment.translationUnit->getImportStatements().empty())
+	{
+		sentinel.clear();
+		return false;
+	}
+
+	// Splice the reused declarations around the re-parsed ones, the new unit also keeps the previous arenas alive
+	TranslationUnit& result = *fragment.translationUnit;
+	ast::DeclarationSet& set = result.getDeclarations();
+	std::vector<UPTR(ast::Declaration)> parsed = set.releaseDeclarations();
+	std::vector<UPTR(ast::Declaration)> reused = unit.getDeclarations().releaseDeclarations();
+	std::vector<UPTR(ast::ImportStatement)> imports = unit.releaseImportStatements();
+
+	for(size_t i = 0 ; i < prefix ; ++i)
+		set.addDeclaration(std::move(reused[i]));
+	for(auto& declaration : parsed)
+		set.addDeclaration(std::move(declaration));
+	for(size_t i = suffix ; i < reused.size() ; ++i)
+	{
+		reused[i]->shiftSegments(delta);
+		set.addDeclaration(std::move(reused[i]));
+	}
+	for(size_t i = imports.size() ; i > 0 ; --i)
+		result.insertImportStatement(std::move(imports[i - 1]));
+
+	set.setSegment(coverage(*tokens, importsEnd));
+	result.setSegment(coverage(*tokens, 0));
+
+	ParseTreeDeleter* deleter = std::get_deleter<ParseTreeDeleter>(fragment.translationUnit);
+	deleter->arenas.insert(deleter->arenas.end(), previousDeleter->arenas.begin(), previousDeleter->arenas.end());
+
+	buildInfo.sourceTable = sourceTable;
+	buildInfo.tokenSequence = tokens;
+	buildInfo.translationUnit = fragment.translationUnit;
+	buildInfo.syntaxErrors = false;
+	return true;
+}
+
+bool services::rebuild(build_info_t& buildInfo, const source_edit_t& edit, err::ErrorSentinel* parentSentinel)
+{
+	assert(buildInfo.sourceTable != nullptr, "Build info must contain source table before rebuilding");
+	std::shared_ptr<SourceTable> sourceTable = std::make_shared<SourceTable>(*buildInfo.sourceTable, edit);
+	std::string_view source = sourceTable->getSource();
+	uint32_t checksum = crc32(source.data(), source.length());
+
+	if(buildInfo.tokenSequence != nullptr && buildInfo.translationUnit != nullptr && !buildInfo.syntaxErrors
+		&& rebuildIncremental(buildInfo, sourceTable, edit))
+	{
+		buildInfo.sourceChecksum = checksum;
+		return true;
+	}
+
+	buildInfo.sourceTable = sourceTable;
+	buildInfo.sourceChecksum = checksum;
+	services::tokenize(buildInfo, parentSentinel);
+	services::parse(buildInfo, parentSentinel);
+	return false;
+}
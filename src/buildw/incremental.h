@@ -0,0 +1,21 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "buildw/build.h"
+#include "buildw/source.h"
+#include "error/error.h"
+
+namespace wckt::build
+{
+	namespace services
+	{
+		/**
+		 * Applies an edit to a built asset and brings its token sequence and translation unit up to date.
+		 * Only the tokens around the edit are re-lexed, and only the top-level declarations they overlap
+		 * are re-parsed; all other declarations are moved over from the previous translation unit. Falls
+		 * back to a full rebuild whenever reuse is unsafe (previous syntax errors, edits in the import
+		 * section, errors in the re-parsed fragment). Returns true if the incremental path was taken.
+		 */
+		bool rebuild(build_info_t& buildInfo, const source_edit_t& edit, err::ErrorSentinel* parentSentinel);
+	}
+}
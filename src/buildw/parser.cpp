@@ -13,6 +13,32 @@ typedef struct
 	bool started;
 } tree_state_t;
 
+SourceSegment ParseObject::getSegment() const
+{
+	return this->segment;
+}
+
+void ParseObject::setSegment(const SourceSegment& segment)
+{
+	this->segment = segment;
+}
+
+void ParseObject::shiftSegments(ptrdiff_t delta)
+{
+	std::stack<ParseObject*> stack;
+	stack.push(this);
+	
+	while(!stack.empty())
+	{
+		ParseObject* object = stack.top();
+		stack.pop();
+		object->segment = SourceSegment(object->segment.getPosition() + delta, object->segment.getLength());
+		for(ParseObject* elem : object->getElements())
+			if(elem != nullptr)
+				stack.push(elem);
+	}
+}
+
 std::string ParseObject::toTreeString(uint32_t tabSize) const
 {
 	std::stringstream ss;
@@ -49,10 +75,35 @@ std::string ParseObject::toTreeString(uint32_t tabSize) const
 	return ss.str();
 }
 
-#define _NULL_TOKEN Token(Token::__NULL__, " ", 0)
+ShiftedToken::ShiftedToken(const Token& token, const SourceTable& sourceTable)
+: SourceSegment(token.getSegment()), _class(token.getClass()), view(token.getView(sourceTable)), repairChar(token.getRepairChar())
+{}
+
+Token::class_t ShiftedToken::getClass() const
+{
+	return this->_class;
+}
+
+std::string ShiftedToken::getValue() const
+{
+	return this->repairChar ? std::string(this->view) + this->repairChar : std::string(this->view);
+}
+
+std::string_view ShiftedToken::getView() const
+{
+	return this->view;
+}
+
+#define _NULL_TOKEN Token(Token::__NULL__, 0, 1)
+
+static const Token NULL_TOKEN = _NULL_TOKEN;
+
+#define __END_OF_STREAM_POS (this->tokenSequence->empty() ? 0 : this->tokenSequence \
+                        ->at(this->tokenSequence->size() - 1).getSegment().after().getPosition())
 
 TokenIterator::TokenIterator(std::shared_ptr<std::vector<Token>> tokenSequence, size_t position)
-: tokenSequence(tokenSequence), position(position), insertedToken(_NULL_TOKEN)
+: tokenSequence(tokenSequence), position(position), insertedToken(_NULL_TOKEN), consumedToken(_NULL_TOKEN),
+  endOfStream(Token::END_OF_STREAM, __END_OF_STREAM_POS, 1)
 {}
 
 std::shared_ptr<std::vector<Token>> TokenIterator::getTokenSequence() const
@@ -65,38 +116,35 @@ size_t TokenIterator::getPosition() const
     return this->position;
 }
 
-#define __END_OF_STREAM_POS (this->tokenSequence->empty() ? 0 : this->tokenSequence \
-                        ->at(this->tokenSequence->size() - 1).after().getPosition())
-
-Token TokenIterator::next()
+const Token& TokenIterator::next()
 {
 	if(this->insertedToken.getClass() != Token::__NULL__)
 	{
-		Token tok = this->insertedToken;
+		this->consumedToken = this->insertedToken;
 		this->insertedToken = _NULL_TOKEN;
-		return tok;
+		return this->consumedToken;
 	}
 	
     if(this->position >= this->tokenSequence->size())
-        return Token(Token::END_OF_STREAM, " ", __END_OF_STREAM_POS);
-    else return this->tokenSequence->at(this->position++);
+        return this->endOfStream;
+    else return (*this->tokenSequence)[this->position++];
 }
 
-Token TokenIterator::lookAhead() const
+const Token& TokenIterator::lookAhead() const
 {
 	if(this->insertedToken.getClass() != Token::__NULL__)
 		return this->insertedToken;
 	
     if(this->position >= this->tokenSequence->size())
-        return Token(Token::END_OF_STREAM, " ", __END_OF_STREAM_POS);
-    else return this->tokenSequence->at(this->position);
+        return this->endOfStream;
+    else return (*this->tokenSequence)[this->position];
 }
 
-Token TokenIterator::latest() const
+const Token& TokenIterator::latest() const
 {
     if(this->position == 0 || this->tokenSequence->empty())
-        return Token(Token::__NULL__, " ", 0);
-    else return this->tokenSequence->at(std::min(this->tokenSequence->size(), this->position) - 1);
+        return NULL_TOKEN;
+    else return (*this->tokenSequence)[std::min(this->tokenSequence->size(), this->position) - 1];
 }
 
 void TokenIterator::insert(const Token& token)
@@ -121,14 +169,14 @@ typedef struct
 typedef struct
 {
 	uint32_t number;
-	std::unique_ptr<ParseObject> object;
+	UPTR(ParseObject) object;
+	SourceSegment segment;
 } state_t;
 
 /* Minimum token distance between 2 reported errors */
 #define MIN_ERROR_DISTANCE	3
 
 /* Imported from LALR parse table generator */
-extern void lalrinit();
 extern uint32_t lalraction(uint32_t __row, uint32_t __col);
 extern uint32_t lalrgoto(uint32_t __row, uint32_t __col);
 extern production_t lalrprod(uint32_t __row);
@@ -159,11 +207,11 @@ static inline action_t getAction(uint32_t stateNumber, Token::class_t tokenClass
 static inline action_t getAction(uint32_t stateNumber, const Token& lookAhead)
 { return getAction(stateNumber, lookAhead.getClass()); }
 
-#define __LOOKAHEAD_STR			(lookAhead.getClass() == Token::END_OF_STREAM ? "end-of-stream" : "token \'" + lookAhead.getValue() + "\'")
+#define __LOOKAHEAD_STR			(lookAhead.getClass() == Token::END_OF_STREAM ? "end-of-stream" : "token \'" + lookAhead.getValue(sourceTable) + "\'")
 #define __FIND(_Vec, _Val)		(std::find((_Vec).begin(), (_Vec).end(), (_Val)))
 #define __CONTAINS(_Vec, _Val)	(__FIND(_Vec, _Val) != _Vec.end())
 
-static inline std::string getErrorMessage(uint32_t stateNumber, const Token& lookAhead)
+static inline std::string getErrorMessage(uint32_t stateNumber, const Token& lookAhead, const SourceTable& sourceTable)
 {
 	std::vector<Token::class_t> validLookAheads;
 	for(Token::class_t tokenClass : Token::CLASSES)
@@ -199,25 +247,28 @@ void services::parse(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel
     assert(buildInfo.sourceTable != nullptr, "Build info must contain source table before parsing");
     assert(buildInfo.tokenSequence != nullptr, "Build info must contain token sequence before parsing");
 	
+	// Every parse object of this translation unit is allocated in one arena, declared first so it outlives the stack
+	std::shared_ptr<ParseArena> arena = std::make_shared<ParseArena>();
+	
 	// Create stack of states and push initial state
     std::stack<state_t> stack;
     stack.push({.number = 0, .object = nullptr});
 	
 	// Create token iterator and look-ahead object
     TokenIterator iterator(buildInfo.tokenSequence);
-    Token lookAhead(Token::__NULL__, " ", 0);
+    Token lookAhead = _NULL_TOKEN;
 	
 	// Create error sentinel to handle parsing errors with proper tracebacks
     err::ErrorSentinel sentinel(parentSentinel, err::ErrorSentinel::COLLECT, [&buildInfo, &lookAhead](err::PTR_ErrorContextLayer ptr) {
-        return _MAKE_ERR(IntrasourceContextLayer, std::move(ptr), lookAhead, buildInfo.sourceTable);
+        return _MAKE_ERR(IntrasourceContextLayer, std::move(ptr), lookAhead.getSegment(), buildInfo.sourceTable);
     });
 	
-	// Init LALR parse table if not done already
-	lalrinit();
-	
 	// Store position of last error to prevent overly dense error reporting
 	size_t lastErrorPosition = (size_t) -1;
 	
+	// Reduction element buffer, reused across reductions
+	std::vector<UPTR(ParseObject)> xelems;
+	
 	// LALR parsing iteration
     for(;;)
     {
@@ -232,7 +283,8 @@ void services::parse(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel
         {
             case SHIFT: {
 				// For shift actions, simply shift to the next state and consume the look-ahead
-				stack.push({.number = action.number, .object = PMAKE_UNIQUE(ContainerObject<Token>)(lookAhead)});
+				stack.push({.number = action.number, .object = arena->make<ContainerObject<ShiftedToken>>(ShiftedToken(lookAhead, *buildInfo.sourceTable)),
+					.segment = lookAhead.getSegment()});
 				iterator.next();
 				
 				// If we are shifting the ERROR token, we panic until either END_OF_STREAM or a matchable look-ahead
@@ -249,7 +301,7 @@ void services::parse(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel
 					if(errorLookAhead.getClass() == Token::END_OF_STREAM && getAction(action.number, errorLookAhead).type == ERROR)
 					{
 						if(lastErrorPosition == (size_t) -1 || iterator.getPosition() - lastErrorPosition >= MIN_ERROR_DISTANCE)
-							sentinel.raise(_MAKE_STD_ERR(getErrorMessage(action.number, errorLookAhead)));
+							sentinel.raise(_MAKE_STD_ERR(getErrorMessage(action.number, errorLookAhead, *buildInfo.sourceTable)));
 						throw FatalCompileError("Cannot continue parsing after end-of-stream");
 					}
 				}
@@ -258,19 +310,30 @@ void services::parse(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel
             case REDUCE: {
 				// For reduction actions, we fetch the production to reduce by
 				production_t production = lalrprod(action.number);
-				std::vector<std::unique_ptr<ParseObject>> xelems;
+				xelems.clear();
+				xelems.resize(production.length);
 				
 				// For every symbol in the production, we pop a state from the stack and store its object, if any
-                for(uint32_t i = 0 ; i < production.length ; ++i)
+				// The covered source range is the union of the non-empty ranges (empty productions sit at the look-ahead)
+				SourceSegment segment(lookAhead.getPosition(), 0);
+				bool empty = true;
+                for(uint32_t i = production.length ; i > 0 ; --i)
 				{
-					xelems.insert(xelems.begin(), std::move(stack.top().object));
+					xelems[i - 1] = std::move(stack.top().object);
+					if(stack.top().segment.getLength())
+					{
+						segment = empty ? stack.top().segment : (segment | stack.top().segment);
+						empty = false;
+					}
 					stack.pop();
 				}
 				
 				// If the production has a semantic action, call it to generate an object using popped state objects
-				auto object = production.action != nullptr ? production.action(std::move(xelems)) : nullptr;
+				UPTR(ParseObject) object = production.action != nullptr ? production.action(*arena, std::move(xelems)) : nullptr;
+				if(object != nullptr)
+					object->setSegment(segment);
 				// Use the goto entry of the new top state to move to the new state after the reduction, copying the new object, if any
-                stack.push({.number = lalrgoto(stack.top().number, production.nterm), .object = std::move(object)});
+                stack.push({.number = lalrgoto(stack.top().number, production.nterm), .object = std::move(object), .segment = segment});
             	continue;
 			}
             case ACCEPT: {
@@ -280,7 +343,7 @@ void services::parse(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel
             case ERROR: {
 				// For error actions (i.e. no such entry in the parse table), first raise a syntax error with a helpful message (if not too close)
 				if(lastErrorPosition == (size_t) -1 || iterator.getPosition() - lastErrorPosition >= MIN_ERROR_DISTANCE)
-				{ sentinel.raise(_MAKE_STD_ERR(getErrorMessage(state.number, lookAhead))); lastErrorPosition = iterator.getPosition(); }
+				{ sentinel.raise(_MAKE_STD_ERR(getErrorMessage(state.number, lookAhead, *buildInfo.sourceTable))); lastErrorPosition = iterator.getPosition(); }
 				
 				// Continually pop states off the stack until ERROR is a valid look-ahead token
 				action = getAction(state.number, Token::ERROR);
@@ -293,16 +356,18 @@ void services::parse(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel
 				// If there is no such state that accepts the ERROR token, we abort parsing (this shouldn't happen)
 				// Otherwise, we insert the ERROR token and continue parsing from this state
 				assert(action.type != ERROR, "No error recovery rule available");
-				iterator.insert(Token(Token::ERROR, " ", lookAhead.getPosition()));
+				iterator.insert(Token(Token::ERROR, lookAhead.getPosition(), 1));
 			}
         }
     }
 	
     finish:
-	std::unique_ptr<ParseObject> object = std::move(stack.top().object);
-	TranslationUnit* raw = dynamic_cast<TranslationUnit*>(object.release());
-	assert(raw != nullptr, "Parse output is not an instance of TranslationUnit");
+	UPTR(ParseObject) object = std::move(stack.top().object);
+	assert(dynamic_cast<TranslationUnit*>(object.get()) != nullptr, "Parse output is not an instance of TranslationUnit");
+	TranslationUnit* raw = static_cast<TranslationUnit*>(object.release());
 
-	std::shared_ptr<TranslationUnit> translationUnit = std::shared_ptr<TranslationUnit>(raw);
+	// The arena is released together with the translation unit, after its objects are destructed
+	std::shared_ptr<TranslationUnit> translationUnit = std::shared_ptr<TranslationUnit>(raw, ParseTreeDeleter { { arena } });
 	buildInfo.translationUnit = translationUnit;
+	buildInfo.syntaxErrors |= sentinel.hasErrors();
 }
@@ -3,12 +3,17 @@
 #include "include/definitions.h"
 #include "buildw/build.h"
 #include "buildw/tokenizer.h"
+#include "buildw/arena.h"
 #include "error/error.h"
 
 namespace wckt::build
 {
 	class ParseObject
 	{
+		private:
+			/* Source range covered by the production this object was reduced from */
+			SourceSegment segment;
+			
 		public:
 			virtual ~ParseObject() = default;
 			
@@ -16,9 +21,23 @@ namespace wckt::build
 			virtual std::vector<const ParseObject*> getElements() const = 0;
 			virtual std::vector<ParseObject*> getElements() = 0;
 			
+			SourceSegment getSegment() const;
+			void setSegment(const SourceSegment& segment);
+			/* Moves the segments of this object and all of its elements by delta characters */
+			void shiftSegments(ptrdiff_t delta);
+			
 			std::string toTreeString(uint32_t tabSize = 3) const;
 	};
 	
+	/* Destructs a tree of parse objects, then releases the arenas its objects were allocated in */
+	struct ParseTreeDeleter
+	{
+		std::vector<std::shared_ptr<ParseArena>> arenas;
+		
+		inline void operator()(ParseObject* root) const
+		{ ArenaDeleter()(root); }
+	};
+	
 	class DummyObject : public ParseObject
 	{
 		public:
@@ -55,16 +74,35 @@ namespace wckt::build
 			{ return {}; }
 	};
     
-	typedef std::unique_ptr<ParseObject>(*psem_action_t)(std::vector<std::unique_ptr<ParseObject>>&&);
+	/* Terminal as semantic actions receive it, with its text resolved from the source table when shifted */
+	class ShiftedToken : public SourceSegment
+	{
+		private:
+			Token::class_t _class;
+			/* View into the source buffer, valid as long as the source table lives */
+			std::string_view view;
+			char repairChar;
+			
+		public:
+			ShiftedToken(const Token& token, const SourceTable& sourceTable);
+			~ShiftedToken() override = default;
+			
+			Token::class_t getClass() const;
+			std::string getValue() const;
+			std::string_view getView() const;
+	};
+	
+	/* Parse objects live in the ParseArena of their translation unit */
+	#define	UPTR(_Type...)						std::unique_ptr<_Type, wckt::build::ArenaDeleter>
 	
-	#define	UPTR(_Type)							std::unique_ptr<_Type>
+	typedef UPTR(ParseObject)(*psem_action_t)(ParseArena&, std::vector<UPTR(ParseObject)>&&);
 	
 	#define __PXELEM(_Index)					__xelem ## _Index ## __
 	
 	#define PNULL								nullptr
-	#define PMAKE_UNIQUE(_Class)				std::make_unique<_Class>
-	#define PMAKE_UNIQUE_OF(_Type, _Args...)	std::make_unique<_Type>(_Args)
-	#define PSEM_ACTION(__Name)					UPTR(ParseObject) __Name(std::vector<UPTR(ParseObject)>&& __xelems__)
+	#define PMAKE_UNIQUE(_Class)				__arena__.make<_Class>
+	#define PMAKE_UNIQUE_OF(_Type, _Args...)	__arena__.make<_Type>(_Args)
+	#define PSEM_ACTION(__Name)					UPTR(ParseObject) __Name(ParseArena& __arena__, std::vector<UPTR(ParseObject)>&& __xelems__)
 	#define PXELEM(_Index)						( std::move(__PXELEM(_Index)) )
 	#define PMAKE_XELEM(_Type, _Index)			UPTR(_Type) __PXELEM(_Index) = UPTR(_Type)(static_cast<_Type*>(__xelems__[_Index].release()));
 	
@@ -82,6 +120,8 @@ namespace wckt::build
             size_t position;
 			
 			Token insertedToken;
+			Token consumedToken;
+			Token endOfStream;
 
         public:
             TokenIterator(std::shared_ptr<std::vector<Token>> tokenSequence, size_t position = 0);
@@ -90,9 +130,10 @@ namespace wckt::build
             std::shared_ptr<std::vector<Token>> getTokenSequence() const;
             size_t getPosition() const;
 
-            Token next();
-            Token lookAhead() const;
-            Token latest() const;
+			/* Returned references remain valid until the next call to next() or insert() */
+            const Token& next();
+            const Token& lookAhead() const;
+            const Token& latest() const;
 			
 			void insert(const Token& token);
     };
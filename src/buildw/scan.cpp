@@ -0,0 +1,251 @@
+#include "buildw/scan.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+	#include <immintrin.h>
+	#define SCAN_USE_X86
+#endif
+
+using namespace wckt;
+using namespace wckt::build;
+
+static constexpr std::array<uint8_t, 256> makeClassTable()
+{
+	std::array<uint8_t, 256> table = {};
+	for(char ch : std::string_view("\n\r\t "))
+		table[(uint8_t) ch] |= scan::WHITESPACE;
+	for(char ch : std::string_view("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_$"))
+		table[(uint8_t) ch] |= scan::IDENTIFIER;
+	for(char ch : std::string_view("~!@%^&*()-=+[]{}|;:,<>/?"))
+		table[(uint8_t) ch] |= scan::SYMBOL;
+	return table;
+}
+
+const std::array<uint8_t, 256> scan::CLASS_TABLE = makeClassTable();
+
+namespace
+{
+	typedef struct
+	{
+		const char* name;
+		size_t (*run)(const char* data, size_t length, scan::class_t _class);
+		void (*newlines)(const char* data, size_t length, size_t offset, std::vector<size_t>& lineStarts);
+	} scan_impl_t;
+}
+
+static size_t runScalar(const char* data, size_t length, scan::class_t _class)
+{
+	size_t i = 0;
+	while(i < length && scan::is(data[i], _class))
+		i++;
+	return i;
+}
+
+static void newlinesScalar(const char* data, size_t length, size_t offset, std::vector<size_t>& lineStarts)
+{
+	for(size_t i = 0 ; i < length ; ++i)
+		if(data[i] == '\n')
+			lineStarts.push_back(offset + i + 1);
+}
+
+#ifdef SCAN_USE_X86
+
+/* Appends the line start following every set bit of a newline mask */
+static inline void pushNewlines(uint32_t mask, size_t base, std::vector<size_t>& lineStarts)
+{
+	for(; mask ; mask &= mask - 1)
+		lineStarts.push_back(base + __builtin_ctz(mask) + 1);
+}
+
+/* Bytes in [lo, hi], using an unsigned comparison SSE2 lacks */
+static inline __m128i inRange16(__m128i block, char lo, char hi)
+{
+	__m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8(lo));
+	return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(hi - lo)), shifted);
+}
+
+static inline uint32_t classMask16(__m128i block, scan::class_t _class)
+{
+	__m128i match;
+	if(_class == scan::WHITESPACE)
+	{
+		match = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\t'))),
+			_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))));
+	}
+	else if(_class == scan::IDENTIFIER)
+	{
+		match = _mm_or_si128(
+			_mm_or_si128(inRange16(_mm_or_si128(block, _mm_set1_epi8(0x20)), 'a', 'z'), inRange16(block, '0', '9')),
+			_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('_')), _mm_cmpeq_epi8(block, _mm_set1_epi8('$'))));
+	}
+	else
+	{
+		match = _mm_setzero_si128();
+		for(char ch : std::string_view("~!@%^&*()-=+[]{}|;:,<>/?"))
+			match = _mm_or_si128(match, _mm_cmpeq_epi8(block, _mm_set1_epi8(ch)));
+	}
+	return (uint32_t) _mm_movemask_epi8(match);
+}
+
+static size_t runSSE2(const char* data, size_t length, scan::class_t _class)
+{
+	size_t i = 0;
+	for(; i + 16 <= length ; i += 16)
+	{
+		uint32_t mask = classMask16(_mm_loadu_si128((const __m128i*) (data + i)), _class);
+		if(mask != 0xffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + runScalar(data + i, length - i, _class);
+}
+
+static void newlinesSSE2(const char* data, size_t length, size_t offset, std::vector<size_t>& lineStarts)
+{
+	size_t i = 0;
+	for(; i + 16 <= length ; i += 16)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i*) (data + i));
+		pushNewlines(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))), offset + i, lineStarts);
+	}
+	newlinesScalar(data + i, length - i, offset + i, lineStarts);
+}
+
+namespace
+{
+	/**
+	 * Nibble lookup tables classifying a byte with two shuffles: hi has bit h set for high nibble h < 8,
+	 * lo[l] has bit h set if byte (h << 4 | l) belongs to the class. Exact for any set of ASCII bytes.
+	 */
+	typedef struct
+	{
+		uint8_t lo[16];
+		uint8_t hi[16];
+	} nibble_lut_t;
+}
+
+static nibble_lut_t makeNibbleLUT(scan::class_t _class)
+{
+	nibble_lut_t lut = {};
+	for(uint32_t h = 0 ; h < 8 ; ++h)
+	{
+		lut.hi[h] = 1 << h;
+		for(uint32_t l = 0 ; l < 16 ; ++l)
+			if(scan::CLASS_TABLE[h << 4 | l] & _class)
+				lut.lo[l] |= 1 << h;
+	}
+	return lut;
+}
+
+__attribute__((target("avx2")))
+static inline uint32_t classMask32(__m256i block, const nibble_lut_t& lut)
+{
+	__m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) lut.lo));
+	__m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) lut.hi));
+	__m256i nibbles = _mm256_set1_epi8(0x0f);
+
+	__m256i bits = _mm256_and_si256(
+		_mm256_shuffle_epi8(lo, _mm256_and_si256(block, nibbles)),
+		_mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibbles)));
+	return ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bits, _mm256_setzero_si256()));
+}
+
+__attribute__((target("avx2")))
+static size_t runAVX2(const char* data, size_t length, scan::class_t _class)
+{
+	static const nibble_lut_t LUTS[] = {
+		makeNibbleLUT(scan::WHITESPACE), makeNibbleLUT(scan::IDENTIFIER), makeNibbleLUT(scan::SYMBOL)
+	};
+	const nibble_lut_t& lut = LUTS[_class == scan::WHITESPACE ? 0 : _class == scan::IDENTIFIER ? 1 : 2];
+
+	size_t i = 0;
+	for(; i + 32 <= length ; i += 32)
+	{
+		uint32_t mask = classMask32(_mm256_loadu_si256((const __m256i*) (data + i)), lut);
+		if(mask != 0xffffffff)
+			return i + __builtin_ctz(~mask);
+	}
+	return i + runSSE2(data + i, length - i, _class);
+}
+
+__attribute__((target("avx2")))
+static void newlinesAVX2(const char* data, size_t length, size_t offset, std::vector<size_t>& lineStarts)
+{
+	size_t i = 0;
+	for(; i + 32 <= length ; i += 32)
+	{
+		__m256i block = _mm256_loadu_si256((const __m256i*) (data + i));
+		pushNewlines(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n'))), offset + i, lineStarts);
+	}
+	newlinesSSE2(data + i, length - i, offset + i, lineStarts);
+}
+
+#endif
+
+/* Every implementation built for this architecture, best first */
+static const scan_impl_t IMPLEMENTATIONS[] = {
+#ifdef SCAN_USE_X86
+	{ "avx2", runAVX2, newlinesAVX2 },
+	{ "sse2", runSSE2, newlinesSSE2 },
+#endif
+	{ "scalar", runScalar, newlinesScalar }
+};
+
+static bool isSupported(const scan_impl_t& impl)
+{
+#ifdef SCAN_USE_X86
+	if(impl.run == runAVX2)
+		return __builtin_cpu_supports("avx2");
+#endif
+	return true;
+}
+
+static const scan_impl_t*& getImplementationSlot()
+{
+	static const scan_impl_t* impl = [] {
+		for(const scan_impl_t& impl : IMPLEMENTATIONS)
+			if(isSupported(impl))
+				return &impl;
+		return &IMPLEMENTATIONS[std::size(IMPLEMENTATIONS) - 1];
+	}();
+	return impl;
+}
+
+static const scan_impl_t& getImplementation()
+{
+	return *getImplementationSlot();
+}
+
+size_t scan::runBlocks(const char* data, size_t length, class_t _class)
+{
+	return getImplementation().run(data, length, _class);
+}
+
+void scan::newlines(const char* data, size_t length, size_t offset, std::vector<size_t>& lineStarts)
+{
+	getImplementation().newlines(data, length, offset, lineStarts);
+}
+
+const char* scan::getImplementationName()
+{
+	return getImplementation().name;
+}
+
+std::vector<const char*> scan::getSupportedImplementations()
+{
+	std::vector<const char*> names;
+	for(const scan_impl_t& impl : IMPLEMENTATIONS)
+		if(isSupported(impl))
+			names.push_back(impl.name);
+	return names;
+}
+
+bool scan::setImplementation(std::string_view name)
+{
+	for(const scan_impl_t& impl : IMPLEMENTATIONS)
+		if(impl.name == name && isSupported(impl))
+		{
+			getImplementationSlot() = &impl;
+			return true;
+		}
+	return false;
+}
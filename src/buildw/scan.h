@@ -0,0 +1,56 @@
+#pragma once
+
+#include "include/definitions.h"
+#include <array>
+
+namespace wckt::build
+{
+	/**
+	 * Character scanning primitives shared by the tokenizer and the source table. Runs are scanned over
+	 * blocks of 32 (AVX2) or 16 (SSE2) bytes, the implementation is picked once for the running CPU and
+	 * falls back to the lookup table below on other architectures.
+	 */
+	namespace scan
+	{
+		enum class_t : uint8_t
+		{
+			/* \n \r \t and space */
+			WHITESPACE = 0x01,
+			/* A-Z a-z 0-9 _ $ */
+			IDENTIFIER = 0x02,
+			/* ~!@%^&*()-=+[]{}|;:,<>/? */
+			SYMBOL = 0x04
+		};
+
+		/* Characters checked by table before a run is scanned by blocks */
+		constexpr size_t PROLOGUE_LENGTH = 8;
+
+		/* Class bits of every byte */
+		extern const std::array<uint8_t, 256> CLASS_TABLE;
+
+		inline bool is(char ch, class_t _class)
+		{ return CLASS_TABLE[(uint8_t) ch] & _class; }
+
+		/* Length of the run of characters of the class at the start of data, scanned by blocks */
+		size_t runBlocks(const char* data, size_t length, class_t _class);
+
+		/* Length of the run of characters of the class at the start of data */
+		inline size_t run(const char* data, size_t length, class_t _class)
+		{
+			// Most runs in sources are shorter than a block, the table settles them without a call
+			size_t i = 0, prologue = std::min(length, (size_t) PROLOGUE_LENGTH);
+			while(i < prologue && is(data[i], _class))
+				i++;
+			return i < prologue ? i : i + runBlocks(data + i, length - i, _class);
+		}
+		/* Appends offset + i + 1 to lineStarts for every newline at index i of data */
+		void newlines(const char* data, size_t length, size_t offset, std::vector<size_t>& lineStarts);
+
+		/* Name of the implementation in use ("avx2", "sse2" or "scalar"), the best the running CPU supports unless forced */
+		const char* getImplementationName();
+		/* Names of the implementations the running CPU supports, best first */
+		std::vector<const char*> getSupportedImplementations();
+		/* Forces a supported implementation by name, returns false otherwise. Not thread-safe, for tests and benchmarks */
+		bool setImplementation(std::string_view name);
+	}
+}
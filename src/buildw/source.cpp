@@ -1,4 +1,5 @@
 #include "buildw/source.h"
+#include "buildw/scan.h"
 #include "include/exception.h"
 #include "include/strutil.h"
 
@@ -6,18 +7,37 @@ using namespace wckt;
 using namespace wckt::build;
 
 SourceTable::SourceTable(const base::URL& url)
-: url(url)
+: url(url), buffer(url.map())
 {
-	this->source = url.read(true);
-	
+	this->source = this->buffer->getView();
 	this->lines.push_back(0);
+	indexLines(0);
+}
+
+SourceTable::SourceTable(const SourceTable& previous, const source_edit_t& edit)
+: url(previous.url)
+{
+	if(edit.position > previous.source.length() || edit.removed > previous.source.length() - edit.position)
+		throw BadArgumentError("Edit range exceeds the bounds of the source");
 	
-	size_t start = this->source.find('\n');
-	while(start != std::string::npos)
-	{
-		this->lines.push_back(start + 1);
-		start = this->source.find('\n', start + 1);
-	}
+	std::string edited;
+	edited.reserve(previous.source.length() - edit.removed + edit.inserted.length());
+	edited.append(previous.source, 0, edit.position);
+	edited.append(edit.inserted);
+	edited.append(previous.source, edit.position + edit.removed);
+	this->buffer = std::make_shared<base::StringBuffer>(std::move(edited));
+	this->source = this->buffer->getView();
+	
+	// Lines starting up to the edit are unchanged, the rest are rescanned
+	auto unchanged = std::upper_bound(previous.lines.begin(), previous.lines.end(), edit.position);
+	this->lines.assign(previous.lines.begin(), unchanged);
+	indexLines(this->lines.back());
+}
+
+/* Appends the start of every line after position start */
+void SourceTable::indexLines(size_t start)
+{
+	scan::newlines(this->source.data() + start, this->source.length() - start, start, this->lines);
 }
 
 base::URL SourceTable::getURL() const
@@ -25,7 +45,7 @@ base::URL SourceTable::getURL() const
 	return this->url;
 }
 
-const std::string& SourceTable::getSource() const
+std::string_view SourceTable::getSource() const
 {
 	return this->source;
 }
@@ -67,9 +87,9 @@ std::string SourceTable::getLine(uint32_t row) const
 		return "";
 	
 	if(row == this->lines.size() - 1)
-		return this->source.substr(this->lines[row]);
+		return std::string(this->source.substr(this->lines[row]));
 	
-	return this->source.substr(this->lines[row], this->lines[row + 1] - this->lines[row] - 1);
+	return std::string(this->source.substr(this->lines[row], this->lines[row + 1] - this->lines[row] - 1));
 }
 
 SourceSegment::SourceSegment()
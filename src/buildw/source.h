@@ -6,6 +6,14 @@
 
 namespace wckt::build
 {
+	/* Replacement of `removed` characters at `position` by the `inserted` text */
+	typedef struct
+	{
+		size_t position;
+		size_t removed;
+		std::string inserted;
+	} source_edit_t;
+	
 	class SourceTable
 	{
 		public:
@@ -17,15 +25,21 @@ namespace wckt::build
 		
 		private:
 			base::URL url;
-			std::string source;
+			/* Mapped or owned source text, source views into it */
+			std::shared_ptr<base::URLBuffer> buffer;
+			std::string_view source;
 			std::vector<size_t> lines;
 			
+			void indexLines(size_t start);
+			
 		public:
 			SourceTable(const base::URL& url);
+			/* Source resulting from applying the edit to a previous version of the source */
+			SourceTable(const SourceTable& previous, const source_edit_t& edit);
 			~SourceTable() = default;
 			
 			base::URL getURL() const;
-			const std::string& getSource() const;
+			std::string_view getSource() const;
 			
 			coords1_t getCoords(size_t pos) const;
 			/* Row starting from 1 */
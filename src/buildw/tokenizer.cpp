@@ -1,6 +1,7 @@
 #include "buildw/tokenizer.h"
+#include "buildw/dfa.h"
+#include "buildw/scan.h"
 #include "include/exception.h"
-#include <regex>
 
 using namespace wckt;
 using namespace wckt::build;
@@ -31,23 +32,63 @@ const std::map<Token::class_t, std::string> Token::NICKNAMES = {
 	FOREACH_TOKEN_CLASS_NICKNAME(__ENUM_TO_NICKNAME_INIT)
 };
 
-Token::Token(class_t _class, const std::string& value, size_t position)
-: SourceSegment(position, value.length()), _class(_class), value(value)
+Token::Token(class_t _class, size_t position, size_t length, char repairChar)
+: position(position), length(length), _class(_class), repairChar(repairChar)
 {}
 
 Token::class_t Token::getClass() const
 {
-	return this->_class;
+	return (class_t) this->_class;
 }
 
-std::string Token::getValue() const
+size_t Token::getPosition() const
 {
-	return this->value;
+	return this->position;
 }
 
-std::string Token::toString() const
+size_t Token::getLength() const
 {
-	return "[" + getClassName(this->_class) + " " + this->value + "]";
+	return this->length + (this->repairChar ? 1 : 0);
+}
+
+SourceSegment Token::getSegment() const
+{
+	return SourceSegment(this->position, getLength());
+}
+
+char Token::getRepairChar() const
+{
+	return this->repairChar;
+}
+
+std::string_view Token::getView(const SourceTable& sourceTable) const
+{
+	// Tokens made up by the parser may lie past the end of the source
+	std::string_view source = sourceTable.getSource();
+	return this->position < source.length() ? source.substr(this->position, this->length) : std::string_view();
+}
+
+std::string Token::getValue(const SourceTable& sourceTable) const
+{
+	std::string value(getView(sourceTable));
+	if(this->repairChar)
+		value += this->repairChar;
+	return value;
+}
+
+atom_t Token::getAtom(const SourceTable& sourceTable) const
+{
+	return this->repairChar ? AtomTable::intern(getValue(sourceTable)) : AtomTable::intern(getView(sourceTable));
+}
+
+Token Token::rebase(ptrdiff_t delta) const
+{
+	return Token(getClass(), this->position + delta, this->length, this->repairChar);
+}
+
+std::string Token::toString(const SourceTable& sourceTable) const
+{
+	return "[" + getClassName(getClass()) + " " + getValue(sourceTable) + "]";
 }
 
 namespace
@@ -56,7 +97,7 @@ namespace
 	{
 		build_info_t& info;
 		size_t pos;
-		const std::string& src;
+		std::string_view src;
 	} itr_t;
 }
 
@@ -68,14 +109,19 @@ namespace
 
 #define _ICHAR		( _ISRC[_IPOS] )
 
-#define _WHITESPACE(ch)		( std::string("\n\r\t ").find(ch) != std::string::npos )
-#define _ALPHANUMERIC(ch)	( (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch == '_' || ch == '$' )
-#define _SYMBOLIC(ch)		( std::string("~!@%^&*()-=+[]{}|;:,<>/?").find(ch) != std::string::npos )
+#define _ALPHANUMERIC(ch)	scan::is(ch, scan::IDENTIFIER)
+#define _SYMBOLIC(ch)		scan::is(ch, scan::SYMBOL)
+#define _DIGIT(ch)			( ch >= '0' && ch <= '9' )
+
+/* Skips the run of characters of the class starting at the current position */
+static inline void jumpRun(scan::class_t _class, _IVEC_ARG)
+{
+	_IPOS += scan::run(_ISRC.data() + _IPOS, _ISRC.length() - _IPOS, _class);
+}
 
 static inline void jumpWhitespace(_IVEC_ARG)
 {
-	while(_IPOS < _ISRC.length() && _WHITESPACE(_ICHAR))
-		_IPOS++;
+	jumpRun(scan::WHITESPACE, _IVEC);
 }
 
 static size_t nextLongest(err::ErrorSentinel& sentinel, char& repairChar, _IVEC_ARG)
@@ -89,18 +135,18 @@ static size_t nextLongest(err::ErrorSentinel& sentinel, char& repairChar, _IVEC_
 	
 	if(_ALPHANUMERIC(ch))
 	{
-		bool numeric = ch >= '0' && ch <= '9';
-		for(_IPOS++ ; _IPOS < _ISRC.length() && (_ALPHANUMERIC(_ICHAR) || (numeric && _ICHAR == '.')) ; _IPOS++)
+		// A run of digits may be followed by a single decimal point
+		if(_DIGIT(ch))
 		{
-			if(_ICHAR < '0' || _ICHAR > '9')
-				numeric = false;
+			while(_IPOS < _ISRC.length() && _DIGIT(_ICHAR))
+				_IPOS++;
+			if(_IPOS < _ISRC.length() && _ICHAR == '.')
+				_IPOS++;
 		}
+		jumpRun(scan::IDENTIFIER, _IVEC);
 	}
 	else if(_SYMBOLIC(ch))
-	{
-		do { _IPOS++; }
-		while(_IPOS < _ISRC.length() && _SYMBOLIC(_ICHAR));
-	}
+		jumpRun(scan::SYMBOL, _IVEC);
 	else if(ch == '\'' || ch == '\"')
 	{
 		bool escape = false;
@@ -124,12 +170,10 @@ static size_t nextLongest(err::ErrorSentinel& sentinel, char& repairChar, _IVEC_
 	else if(ch == '.')
 	{
 		_IPOS++;
-		if(_IPOS < _ISRC.length() && _ICHAR >= '0' && _ICHAR <= '9')
-			while(_IPOS < _ISRC.length() && _ALPHANUMERIC(_ICHAR))
-				_IPOS++;
+		if(_IPOS < _ISRC.length() && _DIGIT(_ICHAR))
+			jumpRun(scan::IDENTIFIER, _IVEC);
 		else
-			while(_IPOS < _ISRC.length() && _SYMBOLIC(_ICHAR))
-				_IPOS++;
+			jumpRun(scan::SYMBOL, _IVEC);
 	}
 	else
 	{
@@ -144,31 +188,17 @@ static size_t nextLongest(err::ErrorSentinel& sentinel, char& repairChar, _IVEC_
 
 static void findLongestMatch(Token::class_t& _class, size_t& len, err::ErrorSentinel& sentinel, char repairChar, _IVEC_ARG)
 {
-	std::string token = _ISRC.substr(_IPOS, len);
-	std::smatch maxMatch;
-	_class = Token::__NULL__;
-	
+	std::string_view token(_ISRC.data() + _IPOS, len);
+	std::string repaired;
 	if(repairChar)
-		token += repairChar;
+		token = repaired = std::string(token) + repairChar;
 	
-	for(const auto& entry : Token::REGEXPS)
-	{
-		if(entry.second.empty())
-			continue;
-		
-		std::smatch match;
-		std::regex regex(entry.second);
-		if(std::regex_search(token, match, regex, std::regex_constants::match_continuous) && (_class == Token::__NULL__ || match.length() > maxMatch.length()))
-		{
-			maxMatch = match;
-			_class = entry.first;
-		}
-	}
+	size_t matchLen = LexerDFA::standard().match(token, _class);
 	
 	if(_class == Token::__NULL__)
-		sentinel.raise(_MAKE_STD_ERR("\'" + token + "\' is not a token"));
+		sentinel.raise(_MAKE_STD_ERR("\'" + std::string(token) + "\' is not a token"));
 	else
-		len = (size_t) maxMatch.length() > len ? len : maxMatch.length();
+		len = matchLen > len ? len : matchLen;
 }
 
 static void nextReal(err::ErrorSentinel& parentSentinel, _IVEC_ARG)
@@ -201,8 +231,8 @@ static void nextReal(err::ErrorSentinel& parentSentinel, _IVEC_ARG)
 		if(_class == Token::COMMENT_SINGLELINE)
 		{
 			_IPOS += len;
-			while(_IPOS < _ISRC.length() && _ICHAR != '\n')
-				_IPOS++;
+			const char* end = (const char*) std::memchr(_ISRC.data() + _IPOS, '\n', _ISRC.length() - _IPOS);
+			_IPOS = end != nullptr ? end - _ISRC.data() : _ISRC.length();
 			return;
 		}
 		else if(_class == Token::COMMENT_MULTILINE)
@@ -231,21 +261,43 @@ static void nextReal(err::ErrorSentinel& parentSentinel, _IVEC_ARG)
 			}
 		}
 		
-		Token token(_class, _ISRC.substr(_IPOS, len) + (repairChar ? std::string(1, repairChar) : ""), _IPOS);
-		_IBINFO.tokenSequence->push_back(token);
+		_IBINFO.tokenSequence->emplace_back(_class, _IPOS, len, repairChar);
 	}
 	_IPOS += len;
 }
 
 void services::tokenize(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel)
+{
+	buildInfo.tokenSequence = std::make_shared<std::vector<Token>>();
+	buildInfo.syntaxErrors = false;
+	services::tokenize(buildInfo, parentSentinel, 0, nullptr);
+}
+
+bool services::tokenize(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel, size_t start, const std::function<bool(const Token&)>& stop)
 {
 	assert(buildInfo.sourceTable != nullptr, "Build info must contain source table before tokenization");
+	assert(buildInfo.tokenSequence != nullptr, "Build info must contain token sequence before tokenization");
 	
-	itr_t _IVEC = { buildInfo, 0, buildInfo.sourceTable->getSource() };
-	buildInfo.tokenSequence = std::make_shared<std::vector<Token>>();
+	itr_t _IVEC = { buildInfo, start, buildInfo.sourceTable->getSource() };
 	
 	err::ErrorSentinel sentinel(parentSentinel, err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
 	
-	while(_IPOS < _ISRC.length())
+	// Tokens store 32-bit positions and lengths
+	if(_ISRC.length() > UINT32_MAX)
+	{
+		sentinel.raise(_MAKE_STD_ERR("Source is too large to tokenize"));
+		buildInfo.syntaxErrors = true;
+		return false;
+	}
+	
+	bool stopped = false;
+	while(!stopped && _IPOS < _ISRC.length())
+	{
+		size_t count = buildInfo.tokenSequence->size();
 		nextReal(sentinel, _IVEC);
+		stopped = stop && buildInfo.tokenSequence->size() > count && stop(buildInfo.tokenSequence->back());
+	}
+	
+	buildInfo.syntaxErrors |= sentinel.hasErrors();
+	return stopped;
 }
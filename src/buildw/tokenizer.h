@@ -1,6 +1,7 @@
 #pragma once
 
 #include "include/definitions.h"
+#include "include/atoms.h"
 #include "buildw/build.h"
 #include "error/error.h"
 
@@ -122,7 +123,8 @@
 
 namespace wckt::build
 {
-	class Token : public SourceSegment
+	/* Class and source range of a token, whose text is resolved from the source table it was lexed from */
+	class Token
 	{
 		public:
 			enum class_t
@@ -135,21 +137,39 @@ namespace wckt::build
 			static const std::map<class_t, std::string> NICKNAMES;
 			
 		private:
-			class_t _class;
-			std::string value;
+			uint32_t position;
+			/* Length in the source, excluding the repair character */
+			uint32_t length;
+			uint8_t _class;
+			/* Closing quote appended by the tokenizer to repair an unterminated literal (or 0 if none) */
+			char repairChar;
 			
 		public:
-			Token(class_t _class, const std::string& value, size_t position);
+			Token(class_t _class, size_t position, size_t length, char repairChar = 0);
 			~Token() = default;
 			
 			class_t getClass() const;
-			std::string getValue() const;
+			size_t getPosition() const;
+			/* Length of the token value, including the repair character */
+			size_t getLength() const;
+			SourceSegment getSegment() const;
+			char getRepairChar() const;
 			
-			std::string toString() const;
+			/* View into the source, which excludes the repair character */
+			std::string_view getView(const SourceTable& sourceTable) const;
+			std::string getValue(const SourceTable& sourceTable) const;
+			/* Interned value, so identifiers can be compared as atoms */
+			atom_t getAtom(const SourceTable& sourceTable) const;
+			/* Copy of this token moved by delta characters */
+			Token rebase(ptrdiff_t delta) const;
+			
+			std::string toString(const SourceTable& sourceTable) const;
 	};
 	
 	namespace services
 	{
 		void tokenize(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel);
+		/* Appends tokens from position start onwards, returns true if stopped early because stop() accepted a new token */
+		bool tokenize(build_info_t& buildInfo, err::ErrorSentinel* parentSentinel, size_t start, const std::function<bool(const Token&)>& stop);
 	}
 }
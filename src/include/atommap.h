@@ -0,0 +1,181 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "include/atoms.h"
+#include "include/exception.h"
+
+/**
+ * Open-addressing hash map from atoms, whose entries are stored inline in a power-of-two table and
+ * probed linearly. The table grows to keep at most half of it occupied, so misses stop after a few
+ * entries. Erasing shifts the rest of the probe sequence back instead of leaving tombstones. Unused
+ * entries have the key ATOM_NPOS, which is never interned.
+ */
+template<typename _Tv>
+class AtomMap
+{
+	public:
+		typedef std::pair<atom_t, _Tv> entry_t;
+
+		/* Iterates used entries in table order, entries must not be modified or inserted while iterating */
+		template<typename _Te>
+		class basic_iterator
+		{
+			private:
+				_Te* entry;
+				_Te* end;
+
+				inline void skip()
+				{ while(this->entry != this->end && this->entry->first == ATOM_NPOS) ++this->entry; }
+
+			public:
+				inline basic_iterator(_Te* entry, _Te* end)
+				: entry(entry), end(end) { skip(); }
+
+				inline _Te& operator*() const { return *this->entry; }
+				inline _Te* operator->() const { return this->entry; }
+				inline basic_iterator& operator++() { ++this->entry; skip(); return *this; }
+				inline bool operator==(const basic_iterator& other) const { return this->entry == other.entry; }
+				inline bool operator!=(const basic_iterator& other) const { return this->entry != other.entry; }
+		};
+
+		typedef basic_iterator<entry_t> iterator;
+		typedef basic_iterator<const entry_t> const_iterator;
+
+	private:
+		std::vector<entry_t> entries;
+		size_t count;
+		/* log2 of the table size */
+		uint32_t bits;
+
+		/* Fibonacci hashing, since atoms of the same shard share their low bits */
+		inline size_t home(atom_t key) const
+		{ return (uint32_t) (key * 2654435769u) >> (32 - this->bits); }
+
+		/* Entry holding key, or the unused entry where it would be inserted */
+		inline size_t probe(atom_t key) const
+		{
+			size_t mask = this->entries.size() - 1;
+			size_t i = home(key);
+			while(this->entries[i].first != key && this->entries[i].first != ATOM_NPOS)
+				i = (i + 1) & mask;
+			return i;
+		}
+
+		void grow()
+		{
+			std::vector<entry_t> old = std::move(this->entries);
+			this->bits++;
+			this->entries = std::vector<entry_t>((size_t) 1 << this->bits);
+			for(auto& entry : this->entries)
+				entry.first = ATOM_NPOS;
+			for(auto& entry : old)
+				if(entry.first != ATOM_NPOS)
+					this->entries[probe(entry.first)] = std::move(entry);
+		}
+
+		/* Empty table of 8 entries */
+		void reset()
+		{
+			this->entries = std::vector<entry_t>(8);
+			for(auto& entry : this->entries)
+				entry.first = ATOM_NPOS;
+			this->count = 0;
+			this->bits = 3;
+		}
+
+	public:
+		AtomMap()
+		{ reset(); }
+
+		/* Moved-from maps are left empty and usable, with a table of their own */
+		AtomMap(AtomMap&& other)
+		: entries(std::move(other.entries)), count(other.count), bits(other.bits)
+		{ other.reset(); }
+
+		AtomMap& operator=(AtomMap&& other)
+		{
+			if(this != &other)
+			{
+				this->entries = std::move(other.entries);
+				this->count = other.count;
+				this->bits = other.bits;
+				other.reset();
+			}
+			return *this;
+		}
+
+		~AtomMap() = default;
+
+		inline size_t size() const { return this->count; }
+		inline bool empty() const { return this->count == 0; }
+
+		/* Returns nullptr if there is no entry for key */
+		inline _Tv* find(atom_t key)
+		{
+			size_t i = probe(key);
+			return this->entries[i].first == ATOM_NPOS ? nullptr : &this->entries[i].second;
+		}
+
+		inline const _Tv* find(atom_t key) const
+		{
+			size_t i = probe(key);
+			return this->entries[i].first == ATOM_NPOS ? nullptr : &this->entries[i].second;
+		}
+
+		/* Returns false, leaving the map unchanged, if there already is an entry for key */
+		bool insert(atom_t key, _Tv&& value)
+		{
+			if(key == ATOM_NPOS)
+				throw BadArgumentError("Cannot insert ATOM_NPOS into an atom map");
+			if(find(key) != nullptr)
+				return false;
+			if((this->count + 1) * 2 > this->entries.size())
+				grow();
+
+			entry_t& entry = this->entries[probe(key)];
+			entry.first = key;
+			entry.second = std::move(value);
+			this->count++;
+			return true;
+		}
+
+		/* Returns false if there is no entry for key */
+		bool erase(atom_t key)
+		{
+			size_t mask = this->entries.size() - 1;
+			size_t i = probe(key);
+			if(this->entries[i].first == ATOM_NPOS)
+				return false;
+
+			// Moves back later entries whose home is not cyclically within (i, j], as they were displaced past i
+			for(size_t j = (i + 1) & mask ; this->entries[j].first != ATOM_NPOS ; j = (j + 1) & mask)
+			{
+				size_t k = home(this->entries[j].first);
+				if(i <= j ? (i < k && k <= j) : (i < k || k <= j))
+					continue;
+				this->entries[i] = std::move(this->entries[j]);
+				i = j;
+			}
+			this->entries[i].first = ATOM_NPOS;
+			this->entries[i].second = _Tv();
+			this->count--;
+			return true;
+		}
+
+		void clear()
+		{
+			for(auto& entry : this->entries)
+			{
+				entry.first = ATOM_NPOS;
+				entry.second = _Tv();
+			}
+			this->count = 0;
+		}
+
+		inline iterator begin() { return iterator(this->entries.data(), this->entries.data() + this->entries.size()); }
+		inline iterator end() { return iterator(this->entries.data() + this->entries.size(), this->entries.data() + this->entries.size()); }
+		inline const_iterator begin() const
+		{ return const_iterator(this->entries.data(), this->entries.data() + this->entries.size()); }
+		inline const_iterator end() const
+		{ return const_iterator(this->entries.data() + this->entries.size(), this->entries.data() + this->entries.size()); }
+};
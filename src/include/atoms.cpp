@@ -0,0 +1,70 @@
+#include "include/atoms.h"
+#include "include/exception.h"
+#include <mutex>
+#include <shared_mutex>
+#include <deque>
+
+#define ATOM_SHARD_COUNT	(1u << ATOM_SHARD_BITS)
+
+namespace
+{
+	typedef struct
+	{
+		std::shared_mutex lock;
+		std::unordered_map<std::string_view, atom_t> atoms;
+		/* Strings by atom index, whose elements never move so views into them stay valid */
+		std::deque<std::string> strings;
+	} atom_shard_t;
+
+	atom_shard_t& getShard(uint32_t index)
+	{
+		static atom_shard_t shards[ATOM_SHARD_COUNT];
+		return shards[index];
+	}
+}
+
+atom_t AtomTable::intern(std::string_view string)
+{
+	uint32_t index = std::hash<std::string_view>()(string) & (ATOM_SHARD_COUNT - 1);
+	atom_shard_t& shard = getShard(index);
+	{
+		std::shared_lock<std::shared_mutex> lock(shard.lock);
+		auto it = shard.atoms.find(string);
+		if(it != shard.atoms.end())
+			return it->second;
+	}
+
+	// Another thread may have interned the string between the locks
+	std::unique_lock<std::shared_mutex> lock(shard.lock);
+	auto it = shard.atoms.find(string);
+	if(it != shard.atoms.end())
+		return it->second;
+
+	// The last index of the last shard would give ATOM_NPOS, which is left unused
+	if(shard.strings.size() >= (1ull << (32 - ATOM_SHARD_BITS)) - 1)
+		throw BadStateError("Atom table is full");
+	atom_t atom = (atom_t) shard.strings.size() << ATOM_SHARD_BITS | index;
+	shard.strings.emplace_back(string);
+	shard.atoms.emplace(shard.strings.back(), atom);
+	return atom;
+}
+
+std::string_view AtomTable::getString(atom_t atom)
+{
+	atom_shard_t& shard = getShard(atom & (ATOM_SHARD_COUNT - 1));
+	std::shared_lock<std::shared_mutex> lock(shard.lock);
+	if((atom >> ATOM_SHARD_BITS) >= shard.strings.size())
+		throw BadArgumentError("No atom " + std::to_string(atom));
+	return shard.strings[atom >> ATOM_SHARD_BITS];
+}
+
+size_t AtomTable::getAtomCount()
+{
+	size_t count = 0;
+	for(uint32_t i = 0 ; i < ATOM_SHARD_COUNT ; ++i)
+	{
+		std::shared_lock<std::shared_mutex> lock(getShard(i).lock);
+		count += getShard(i).strings.size();
+	}
+	return count;
+}
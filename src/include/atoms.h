@@ -0,0 +1,27 @@
+#pragma once
+
+#include "include/definitions.h"
+
+/* Number of independently locked shards of the atom table, as a power of two */
+#define ATOM_SHARD_BITS		4
+
+/* Interned string, equal atoms always name equal strings */
+typedef uint32_t atom_t;
+
+/* Never returned by AtomTable::intern, for use as an empty key */
+#define ATOM_NPOS	( (atom_t) -1 )
+
+/**
+ * Process-wide table of interned strings such as identifiers. Interning the same string always
+ * returns the same atom, so identifiers can be compared and hashed as 32-bit integers. The table
+ * is split into shards by string hash, each behind its own reader-writer lock, so concurrent builds
+ * mostly take shared locks on different shards. Interned strings are never freed.
+ */
+class AtomTable
+{
+	public:
+		static atom_t intern(std::string_view string);
+		/* Valid as long as the process runs */
+		static std::string_view getString(atom_t atom);
+		static size_t getAtomCount();
+};
@@ -0,0 +1,40 @@
+#include "include/checksum.h"
+
+namespace
+{
+	struct crc32_table_t
+	{
+		uint32_t entries[256];
+
+		crc32_table_t()
+		{
+			for(uint32_t i = 0 ; i < 256 ; ++i)
+			{
+				uint32_t value = i;
+				for(uint32_t bit = 0 ; bit < 8 ; ++bit)
+					value = (value & 1) ? (value >> 1) ^ 0xedb88320 : value >> 1;
+				this->entries[i] = value;
+			}
+		}
+	};
+}
+
+uint32_t crc32(const void* data, size_t length, uint32_t crc)
+{
+	static const crc32_table_t table;
+
+	const uchar_t* bytes = (const uchar_t*) data;
+	crc = ~crc;
+	for(size_t i = 0 ; i < length ; ++i)
+		crc = table.entries[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+uint64_t fnv1a64(const void* data, size_t length)
+{
+	const uchar_t* bytes = (const uchar_t*) data;
+	uint64_t hash = 0xcbf29ce484222325;
+	for(size_t i = 0 ; i < length ; ++i)
+		hash = (hash ^ bytes[i]) * 0x100000001b3;
+	return hash;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "include/definitions.h"
+
+/* CRC32 (IEEE 802.3) of the data, continuing from a previous checksum if given */
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+
+/* 64-bit FNV-1a hash of the data */
+uint64_t fnv1a64(const void* data, size_t length);
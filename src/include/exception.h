@@ -32,3 +32,4 @@ _MAKE_API_ERROR(BadArgumentError)
 _MAKE_API_ERROR(BadStateError)
 _MAKE_API_ERROR(CorruptStateError)
 _MAKE_API_ERROR(FatalCompileError)
+_MAKE_API_ERROR(ExecutionError)
@@ -0,0 +1,79 @@
+#include "include/scheduler.h"
+#include "include/exception.h"
+
+uint32_t WorkScheduler::getDefaultConcurrency()
+{
+	uint32_t count = std::thread::hardware_concurrency();
+	return count ? count : 1;
+}
+
+WorkScheduler::WorkScheduler(uint32_t concurrency)
+: concurrency(concurrency)
+{
+	if(concurrency == 0)
+		throw BadArgumentError("Scheduler concurrency must be at least 1");
+}
+
+uint32_t WorkScheduler::getConcurrency() const
+{
+	return this->concurrency;
+}
+
+bool WorkScheduler::pop(queue_t& queue, task_t& task)
+{
+	std::lock_guard<std::mutex> guard(queue.lock);
+	if(queue.tasks.empty())
+		return false;
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+	return true;
+}
+
+bool WorkScheduler::steal(queue_t& queue, task_t& task)
+{
+	std::lock_guard<std::mutex> guard(queue.lock);
+	if(queue.tasks.empty())
+		return false;
+	task = std::move(queue.tasks.front());
+	queue.tasks.pop_front();
+	return true;
+}
+
+void WorkScheduler::run(std::vector<task_t>&& tasks) const
+{
+	uint32_t workers = std::min<size_t>(this->concurrency, tasks.size());
+	if(workers <= 1)
+	{
+		for(auto& task : tasks)
+			task();
+		return;
+	}
+
+	// Deal tasks out in contiguous blocks, pushed in reverse so each worker pops its block in order
+	std::vector<queue_t> queues(workers);
+	for(size_t i = tasks.size() ; i > 0 ; --i)
+		queues[(i - 1) * workers / tasks.size()].tasks.push_back(std::move(tasks[i - 1]));
+
+	// No task spawns more work, so a worker may retire once every queue is empty
+	auto work = [&queues, workers](uint32_t self) {
+		task_t task;
+		for(;;)
+		{
+			bool found = pop(queues[self], task);
+			for(uint32_t offset = 1 ; !found && offset < workers ; ++offset)
+				found = steal(queues[(self + offset) % workers], task);
+			if(!found)
+				return;
+			task();
+			task = nullptr;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(uint32_t i = 1 ; i < workers ; ++i)
+		threads.emplace_back(work, i);
+	work(0);
+
+	for(auto& thread : threads)
+		thread.join();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "include/definitions.h"
+#include <thread>
+#include <mutex>
+#include <deque>
+
+/**
+ * Runs a batch of independent tasks on a fixed pool of worker threads. Each worker owns a
+ * deque, popping its own work from the back and stealing from the front of the others' when
+ * it runs dry. With a single worker, tasks run inline on the calling thread, in order.
+ */
+class WorkScheduler
+{
+	public:
+		typedef std::function<void()> task_t;
+
+		/* Returns the number of hardware threads (at least 1) */
+		static uint32_t getDefaultConcurrency();
+
+	private:
+		typedef struct
+		{
+			std::mutex lock;
+			std::deque<task_t> tasks;
+		} queue_t;
+
+		uint32_t concurrency;
+
+		static bool pop(queue_t& queue, task_t& task);
+		static bool steal(queue_t& queue, task_t& task);
+
+	public:
+		WorkScheduler(uint32_t concurrency = getDefaultConcurrency());
+		~WorkScheduler() = default;
+
+		uint32_t getConcurrency() const;
+
+		/* Blocks until every task has run. Tasks must not throw; capture exceptions inside the task */
+		void run(std::vector<task_t>&& tasks) const;
+};
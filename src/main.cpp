@@ -1,8 +1,12 @@
 #include "include/definitions.h"
 #include "base/engine.h"
 #include "base/modules/dependencies.h"
+#include "base/modules/manifest.h"
 #include "error/error.h"
 #include "buildw/build.h"
+#include "buildw/cache.h"
+#include "include/scheduler.h"
+#include <charconv>
 
 using namespace wckt;
 using namespace wckt::base;
@@ -25,32 +29,84 @@ static void quit(err::ErrorSentinel& sentinel, bool fatal = false, const std::st
 	else exit(0);
 }
 
-static void loadModules(const URL& url, std::shared_ptr<EngineContext> context)
+/* Resolves the dependencies of a modulefile and unpacks every module it needs into the context */
+static void loadModules(const URL& url, std::shared_ptr<EngineContext> context, uint32_t jobs, const modgenfunc_t& genfunc)
 {
 	err::ErrorSentinel sentinel(err::ErrorSentinel::THROW, USE_BASIC_CONTEXT_LAYER(LoadingModuleContextLayer));
 	
-	std::vector<std::shared_ptr<Module>> modules;
-	sentinel.guard<CyclicDependencyError>([&modules, &url](err::ErrorSentinel&) {
-		DependencyResolver resolver(url);
-		modules = resolver.computeTopologicalOrder();
+	std::vector<std::vector<std::shared_ptr<Module>>> levels;
+	sentinel.guard<CyclicDependencyError>([&levels, &url, jobs, &genfunc](err::ErrorSentinel&) {
+		DependencyResolver resolver(url, genfunc, jobs);
+		levels = resolver.computeTopologicalLevels();
 	});
+	
+	sentinel.guard<sym::SymbolResolutionError>([context, &levels, jobs](err::ErrorSentinel&) {
+		context->unpackModules(levels, jobs);
+	});
+}
+
+/* Directory holding the build and manifest cache records when building with `-c` */
+#define CACHE_DIRECTORY		"build/cache"
+/* Largest thread count accepted by `-j` */
+#define MAX_JOBS			1024
 
-	for(std::shared_ptr<Module> module : modules)
+typedef struct
+{
+	/* Number of assets built concurrently */
+	uint32_t jobs;
+	/* Whether unchanged assets and modulefiles are skipped using the build and manifest caches */
+	bool changedOnly;
+} options_t;
+
+/* Parses `-j N`, `-jN` or `--jobs N` and `-c` or `--changed` */
+static options_t parseOptions(int argc, char** argv)
+{
+	options_t options = { .jobs = WorkScheduler::getDefaultConcurrency(), .changedOnly = false };
+	for(int i = 1 ; i < argc ; ++i)
 	{
-		moduleid_t moduleID = context->unpackModule(module);
-		sentinel.guard<sym::SymbolResolutionError>([context, moduleID](err::ErrorSentinel&) {
-			context->getModule(moduleID).declareAllInOrder();
-		});
+		std::string arg = argv[i], value;
+		if(arg == "-c" || arg == "--changed")
+		{
+			options.changedOnly = true;
+			continue;
+		}
+		else if(arg == "-j" || arg == "--jobs")
+		{
+			if(i + 1 >= argc)
+				throw BadArgumentError("Option \'" + arg + "\' expects a thread count");
+			value = argv[++i];
+		}
+		else if(arg.rfind("-j", 0) == 0)
+			value = arg.substr(2);
+		else throw BadArgumentError("Unknown option \'" + arg + "\'");
+		
+		// Parsed without exceptions, so out of range counts are reported like any other invalid one
+		uint32_t jobs = 0;
+		auto [end, error] = std::from_chars(value.data(), value.data() + value.length(), jobs);
+		if(value.empty() || error != std::errc() || end != value.data() + value.length() || jobs == 0 || jobs > MAX_JOBS)
+			throw BadArgumentError("Invalid thread count \'" + value + "\', expected 1 to " + std::to_string(MAX_JOBS));
+		options.jobs = jobs;
 	}
+	return options;
 }
 
-int main()
+int main(int argc, char** argv)
 {
     std::shared_ptr<EngineContext> context = std::make_shared<EngineContext>();
 	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
 	
-	sentinel.guard<err::ErrorSentinel::no_except>([context](err::ErrorSentinel&) {
-		loadModules(URL("file://test/module.xml"), context);
+	options_t options = { .jobs = 1, .changedOnly = false };
+	sentinel.guard<BadArgumentError>([&options, argc, argv](err::ErrorSentinel&) {
+		options = parseOptions(argc, argv);
+	});
+	if(sentinel.hasErrors())
+		quit(sentinel);
+	
+	std::shared_ptr<ManifestCache> manifestCache = options.changedOnly ? std::make_shared<ManifestCache>(CACHE_DIRECTORY) : nullptr;
+	modgenfunc_t genfunc = manifestCache != nullptr ? DependencyResolver::genCachedFunction(manifestCache)
+		: DependencyResolver::modgenfuncDefault();
+	sentinel.guard<err::ErrorSentinel::no_except>([context, &options, &genfunc](err::ErrorSentinel&) {
+		loadModules(URL("file://test/module.xml"), context, options.jobs, genfunc);
 	});
 	if(sentinel.hasErrors())
 		quit(sentinel);
@@ -58,10 +114,24 @@ int main()
 	build::BuildContext buildContext(context, context->findModuleID(URL("file://test/module.xml")));
 	buildContext.addAsset(context->getModule(buildContext.getModuleID())
 		.getSource()->getRootPackage().getChildren()[0].getAssets()[0], std::string("test"));
+	if(options.changedOnly)
+		buildContext.setCache(std::make_shared<build::BuildCache>(CACHE_DIRECTORY));
 	
-	sentinel.guard<FatalCompileError>([&buildContext](err::ErrorSentinel& sentinel) {
-		build::services::buildFromContext(buildContext, &sentinel);
+	sentinel.guard<FatalCompileError>([&buildContext, &options](err::ErrorSentinel& sentinel) {
+		build::services::buildFromContext(buildContext, &sentinel, options.jobs);
 	}, [&sentinel](const FatalCompileError& err) { quit(sentinel, true, err.what()); });
 	
+	if(manifestCache != nullptr)
+	{
+		manifest_stats_t stats = manifestCache->getStatistics();
+		std::cout << "Manifest cache: " << stats.hits << " hit(s), " << stats.misses << " miss(es)" << std::endl;
+	}
+	if(buildContext.getCache() != nullptr)
+	{
+		build::cache_stats_t stats = buildContext.getCache()->getStatistics();
+		std::cout << "Build cache: " << stats.memoryHits + stats.diskHits << " hit(s) (" << stats.diskHits
+			<< " from disk), " << stats.misses << " miss(es)" << std::endl;
+	}
+	
 	quit(sentinel);
 }
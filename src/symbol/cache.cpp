@@ -0,0 +1,47 @@
+#include "symbol/cache.h"
+#include "symbol/symbol.h"
+
+using namespace wckt::sym;
+
+size_t LocatorCache::key_hasher_t::operator()(const Locator& locator) const
+{
+	size_t hash = locator.getModuleID();
+	for(atom_t pckg : locator.getAtoms())
+		hash = hash * 31 + pckg;
+	return hash;
+}
+
+bool LocatorCache::key_equal_t::operator()(const Locator& a, const Locator& b) const
+{
+	return a.getModuleID() == b.getModuleID() && a == b;
+}
+
+LocatorCache::LocatorCache()
+: generation(Namespace::getGeneration())
+{}
+
+Symbol* LocatorCache::find(const Locator& locator)
+{
+	if(this->generation != Namespace::getGeneration())
+		clear();
+	auto it = this->entries.find(locator);
+	return it == this->entries.end() ? nullptr : it->second;
+}
+
+void LocatorCache::insert(const Locator& locator, Symbol& symbol)
+{
+	if(this->generation != Namespace::getGeneration())
+		clear();
+	this->entries[locator] = &symbol;
+}
+
+void LocatorCache::clear()
+{
+	this->entries.clear();
+	this->generation = Namespace::getGeneration();
+}
+
+size_t LocatorCache::size() const
+{
+	return this->entries.size();
+}
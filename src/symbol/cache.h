@@ -0,0 +1,47 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "symbol/locator.h"
+
+namespace wckt::sym
+{
+	// Forward declaration, refer to symbol.h //
+	class Symbol;
+
+	/**
+	 * Symbols resolved from the locators of every module in a context, with reference symbols followed to
+	 * their final target, so chains of references are only walked once. Declaring symbols only changes
+	 * what a locator already resolves to when they shadow others through a mounted namespace, so entries
+	 * are only discarded then, when a namespace loses symbols (see Namespace::getGeneration) or when the
+	 * context deletes a module.
+	 */
+	class LocatorCache
+	{
+		private:
+			/* Unlike Locator::operator==, keys also compare module IDs */
+			struct key_hasher_t
+			{
+				size_t operator()(const Locator& locator) const;
+			};
+
+			struct key_equal_t
+			{
+				bool operator()(const Locator& a, const Locator& b) const;
+			};
+
+			std::unordered_map<Locator, Symbol*, key_hasher_t, key_equal_t> entries;
+			/* Namespace generation the entries were resolved in */
+			uint64_t generation;
+
+		public:
+			LocatorCache();
+			~LocatorCache() = default;
+
+			/* Returns nullptr if the locator was not resolved since the last change */
+			Symbol* find(const Locator& locator);
+			void insert(const Locator& locator, Symbol& symbol);
+			void clear();
+
+			size_t size() const;
+	};
+}
@@ -1,15 +1,29 @@
 #include "symbol/locator.h"
 #include "symbol/symbol.h"
+#include "symbol/cache.h"
 #include "base/context.h"
-#include "include/strutil.h"
 #include "include/exception.h"
-#include <regex>
 
 using namespace wckt;
 using namespace wckt::sym;
 
 // TODO integrate this with tokenizer for consistent identifiers
-static std::regex identifierRegex("[A-Za-z$_][A-Za-z0-9$_]*");
+/* Matches [A-Za-z$_][A-Za-z0-9$_]* */
+static bool isIdentifier(std::string_view str)
+{
+	if(str.empty() || std::isdigit((unsigned char) str[0]))
+		return false;
+	for(char ch : str)
+		if(!std::isalnum((unsigned char) ch) && ch != '$' && ch != '_')
+			return false;
+	return true;
+}
+
+static atom_t internPackage(std::string_view pckg)
+{
+	assert(isIdentifier(pckg), "Package \'" + std::string(pckg) + "\' is not an identifier");
+	return AtomTable::intern(pckg);
+}
 
 Locator::Locator()
 : Locator(_MODULEID_NPOS)
@@ -31,31 +45,32 @@ Locator::Locator(ARG_moduleid_t moduleID, const std::vector<std::string>& pckgs)
 : moduleID(moduleID)
 {
     for(const auto& pckg : pckgs)
-        assert(std::regex_match(pckg, identifierRegex), "Package \'" + pckg + "\' is not an identifier");
-    this->pckgs = pckgs;
+        this->pckgs.push_back(internPackage(pckg));
 }
 
 Locator::Locator(ARG_moduleid_t moduleID, const std::string& signature)
 : moduleID(moduleID)
 {
-    std::string cur = signature;
+    auto trimmed = [](std::string_view str) {
+        while(!str.empty() && std::isspace((unsigned char) str.front()))
+            str.remove_prefix(1);
+        while(!str.empty() && std::isspace((unsigned char) str.back()))
+            str.remove_suffix(1);
+        return str;
+    };
+
+    std::string_view cur = signature;
     size_t pos;
-    
-    while((pos = cur.find('.')) != std::string::npos)
+    while((pos = cur.find('.')) != std::string_view::npos)
     {
-        std::string pckg = cur.substr(0, pos);
-        trim(pckg);
-        assert(std::regex_match(pckg, identifierRegex), "Package \'" + pckg + "\' is not an identifier");
-
-        this->pckgs.push_back(pckg);
+        this->pckgs.push_back(internPackage(trimmed(cur.substr(0, pos))));
         cur = cur.substr(pos + 1);
     }
 
-    trim(cur);
+    cur = trimmed(cur);
     if(cur.empty() && this->pckgs.size() == 0) // Special case of empty signature
         return;
-    assert(std::regex_match(cur, identifierRegex), "Package \'" + cur + "\' is not an identifier");
-    this->pckgs.push_back(cur);
+    this->pckgs.push_back(internPackage(cur));
 }
 
 RET_moduleid_t Locator::getModuleID() const
@@ -65,12 +80,25 @@ RET_moduleid_t Locator::getModuleID() const
 
 std::vector<std::string> Locator::getPackages() const
 {
-    return this->pckgs;
+    std::vector<std::string> pckgs;
+    for(atom_t pckg : this->pckgs)
+        pckgs.emplace_back(AtomTable::getString(pckg));
+    return pckgs;
 }
 
 std::string Locator::getPackage(uint32_t index) const
 {
-    return this->pckgs[index];
+    return std::string(AtomTable::getString(this->pckgs[index]));
+}
+
+const std::vector<atom_t>& Locator::getAtoms() const
+{
+	return this->pckgs;
+}
+
+atom_t Locator::getAtom(uint32_t index) const
+{
+	return this->pckgs[index];
 }
 
 uint32_t Locator::length() const
@@ -89,11 +117,16 @@ namespace
 		using __Tr = typename std::conditional<std::is_const<__Tc>::value, const ReferenceSymbol, ReferenceSymbol>::type;
 		
 		/* Implementation */
-		__Ts& operator()(const std::vector<std::string>& pckgs, ARG_moduleid_t moduleID, __Tc& context)
+		__Ts& operator()(const Locator& locator, __Tc& context)
 		{
+			// Resolved symbols are cached with references already followed (the cache is never const)
+			sym::LocatorCache& cache = context.getLocatorCache();
+			if(Symbol* cached = cache.find(locator))
+				return *cached;
+
 			// Get the static space of that module
-			__Ts* symbol = &context.getModule(moduleID).getSymbolTable();
-			for(const auto& pckg : pckgs)
+			__Ts* symbol = &context.getModule(locator.getModuleID()).getSymbolTable();
+			for(atom_t pckg : locator.getAtoms())
 			{
 				// When there's another symbol to navigate to, we ensure the parent symbol is a namespace
 				__Tn& n = Namespace::assertSymbol(*symbol);
@@ -102,39 +135,43 @@ namespace
 				__F_Action(n, pckg);
 
 				// Navigate to the next symbol
-				symbol = &n.getSymbol(pckg);
+				symbol = n.tryGetSymbol(pckg);
+				if(symbol == nullptr)
+					throw SymbolResolutionError(SymbolResolutionError::NOT_FOUND, n.getLocator().getChild(pckg));
 				
 				// If the acquired symbol is a reference symbol to another module, use its locator to jump to its target
-				// (Will recurse to this locate function)
+				// (Will recurse to this locate function, which caches the target's resolution as well)
 				if(__Tr* r = dynamic_cast<__Tr*>(symbol))
 					symbol = &r->getTarget().locate(context);
 			}
+
+			cache.insert(locator, const_cast<Symbol&>(*symbol));
 			return *symbol;
 		}
 	};
 
-	void declareIfNotDeclared(Namespace& _namespace, const std::string& pckg)
+	void declareIfNotDeclared(Namespace& _namespace, atom_t pckg)
 	{
-		if(!_namespace.isDeclared(pckg))
+		if(_namespace.tryGetSymbol(pckg) == nullptr)
 			_namespace.declareSymbol(pckg, std::make_unique<Namespace>());
 	}
 
-	void doNothing(const Namespace&, const std::string&) {}
+	void doNothing(const Namespace&, atom_t) {}
 }
 
 const Symbol& Locator::locate(__CTX_CONST context) const
 {
-	return locate_impl_t<const base::EngineContext, doNothing>()(this->pckgs, this->moduleID, context);
+	return locate_impl_t<const base::EngineContext, doNothing>()(*this, context);
 }
 
 Symbol& Locator::locate(__CTX context) const
 {
-	return locate_impl_t<base::EngineContext, doNothing>()(this->pckgs, this->moduleID, context);
+	return locate_impl_t<base::EngineContext, doNothing>()(*this, context);
 }
 
 Symbol& Locator::locateOrDeclare(__CTX context) const
 {
-	return locate_impl_t<base::EngineContext, declareIfNotDeclared>()(this->pckgs, this->moduleID, context);
+	return locate_impl_t<base::EngineContext, declareIfNotDeclared>()(*this, context);
 }
 
 std::string Locator::toString() const
@@ -143,9 +180,9 @@ std::string Locator::toString() const
 		return "<root>";
 	
     std::stringstream stream;
-    for(const auto& pckg : this->pckgs)
+    for(atom_t pckg : this->pckgs)
     {
-        stream << pckg << ".";
+        stream << AtomTable::getString(pckg) << ".";
     }
     std::string str = stream.str();
     return str.length() > 0 ? str.substr(0, str.length() - 1) : str;
@@ -153,12 +190,7 @@ std::string Locator::toString() const
 
 bool Locator::operator==(const Locator& other) const
 {
-	if(this->pckgs.size() != other.pckgs.size())
-		return false;
-	for(uint32_t i = 0 ; i < this->pckgs.size() ; ++i)
-		if(this->pckgs[i] != other.pckgs[i])
-			return false;
-	return true;
+	return this->pckgs == other.pckgs;
 }
 
 bool Locator::operator<(const Locator& other) const
@@ -168,10 +200,10 @@ bool Locator::operator<(const Locator& other) const
 		if(i >= this->pckgs.size() || i >= other.pckgs.size())
 			return i < other.pckgs.size(); // If we've reached an end, this < other i.f.f. other still has packages
 		
-		if(this->pckgs[i] < other.pckgs[i])
-			return true;
-		else if(this->pckgs[i] > other.pckgs[i])
-			return false;
+		// Atoms are only equal for equal strings, but are not ordered like them
+		if(this->pckgs[i] == other.pckgs[i])
+			continue;
+		return AtomTable::getString(this->pckgs[i]) < AtomTable::getString(other.pckgs[i]);
 	}
 }
 
@@ -188,11 +220,18 @@ Locator& Locator::operator+=(const Locator& other)
 
 Locator Locator::operator+(const Locator& other) const
 {
-	Locator locator(this->moduleID, this->pckgs);
+	Locator locator = *this;
 	locator += other;
 	return locator;
 }
 
+Locator Locator::getChild(atom_t pckg) const
+{
+	Locator locator = *this;
+	locator.pckgs.push_back(pckg);
+	return locator;
+}
+
 Locator Locator::withModuleID(ARG_moduleid_t moduleID) const
 {
 	Locator loc = *this;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "include/definitions.h"
+#include "include/atoms.h"
 #include "base/context_incl.h"
 
 namespace wckt::sym
@@ -8,10 +9,11 @@ namespace wckt::sym
 	// Forward declaration, refer to symbol.h //
 	class Symbol;
 	
+	/* Dotted path to a symbol in the static space of a module, whose packages are interned identifiers */
 	class Locator
 	{
 		private:
-			std::vector<std::string> pckgs;
+			std::vector<atom_t> pckgs;
 			moduleid_t moduleID;
 			
 		public:
@@ -26,6 +28,8 @@ namespace wckt::sym
 			RET_moduleid_t getModuleID() const;
             std::vector<std::string> getPackages() const;
             std::string getPackage(uint32_t index) const;
+			const std::vector<atom_t>& getAtoms() const;
+			atom_t getAtom(uint32_t index) const;
             uint32_t length() const;
 			
 			const Symbol& locate(__CTX_CONST context) const;
@@ -43,6 +47,8 @@ namespace wckt::sym
 			
 			Locator& operator+=(const Locator& other);
 			Locator operator+(const Locator& other) const;
+			/* Locator of a symbol declared in the scope at this locator */
+			Locator getChild(atom_t pckg) const;
 
 			Locator withModuleID(ARG_moduleid_t moduleID) const;
 	};
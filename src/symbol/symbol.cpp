@@ -30,21 +30,23 @@ std::unique_ptr<Symbol> ReferenceSymbol::clone() const
 	return std::make_unique<ReferenceSymbol>(*this);
 }
 
+std::atomic<uint64_t> Namespace::generation(0);
+
 Namespace::Namespace()
-: Symbol()
+: Symbol(), mounted(false)
 {}
 
 Namespace::Namespace(ARG_moduleid_t moduleID)
-: Symbol()
+: Symbol(), mounted(false)
 {
 	this->locator = Locator(moduleID);
 }
 
 Namespace::Namespace(const Namespace& src)
-: Symbol(src)
+: Symbol(src), overlays(src.overlays), mounted(false)
 {
 	for(const auto& entry : src.symbols)
-		this->symbols.insert(std::pair(entry.first, entry.second->clone()));
+		this->symbols.insert(entry.first, entry.second->clone());
 }
 
 Namespace& Namespace::operator=(const Namespace& src)
@@ -54,48 +56,140 @@ Namespace& Namespace::operator=(const Namespace& src)
 	
 	Symbol::operator=(src);
 	this->symbols.clear();
+	this->overlays = src.overlays;
+	generation++;
 	for(const auto& entry : src.symbols)
-		this->symbols.insert(std::pair(entry.first, entry.second->clone()));
+		this->symbols.insert(entry.first, entry.second->clone());
 	return *this;
 }
 
-const std::map<std::string, std::unique_ptr<Symbol>>& Namespace::getSymbols() const
+uint64_t Namespace::getGeneration()
+{
+	return generation.load();
+}
+
+const AtomMap<std::shared_ptr<Symbol>>& Namespace::getSymbols() const
 {
     return this->symbols;
 }
 
+const std::vector<std::shared_ptr<Namespace>>& Namespace::getOverlays() const
+{
+	return this->overlays;
+}
+
+bool Namespace::isDeclared(atom_t name) const
+{
+    return tryGetSymbol(name) != nullptr;
+}
+
 bool Namespace::isDeclared(const std::string& name) const
 {
-    return this->symbols.find(name) != this->symbols.end();
+    return isDeclared(AtomTable::intern(name));
+}
+
+const Symbol* Namespace::tryGetSymbol(atom_t name) const
+{
+    return const_cast<Namespace*>(this)->tryGetSymbol(name);
+}
+
+Symbol* Namespace::tryGetSymbol(atom_t name)
+{
+    if(std::shared_ptr<Symbol>* symbol = this->symbols.find(name))
+        return symbol->get();
+    for(const auto& overlay : this->overlays)
+        if(Symbol* symbol = overlay->tryGetSymbol(name))
+            return symbol;
+    return nullptr;
+}
+
+const Symbol& Namespace::getSymbol(atom_t name) const
+{
+    const Symbol* symbol = tryGetSymbol(name);
+    if(symbol == nullptr)
+        throw SymbolResolutionError(SymbolResolutionError::NOT_FOUND, this->locator.getChild(name));
+    return *symbol;
 }
 
 const Symbol& Namespace::getSymbol(const std::string& name) const
 {
-    try { return *this->symbols.at(name); }
-    catch(const std::out_of_range&)
-    { throw SymbolResolutionError(SymbolResolutionError::NOT_FOUND, this->locator + name); }
+    return getSymbol(AtomTable::intern(name));
+}
+
+Symbol& Namespace::getSymbol(atom_t name)
+{
+    Symbol* symbol = tryGetSymbol(name);
+    if(symbol == nullptr)
+        throw SymbolResolutionError(SymbolResolutionError::NOT_FOUND, this->locator.getChild(name));
+    return *symbol;
 }
 
 Symbol& Namespace::getSymbol(const std::string& name)
 {
-    try { return *this->symbols.at(name); }
-    catch(const std::out_of_range&)
-    { throw SymbolResolutionError(SymbolResolutionError::NOT_FOUND, this->locator + name); }
+    return getSymbol(AtomTable::intern(name));
+}
+
+void Namespace::declareSymbol(atom_t name, std::unique_ptr<Symbol> symbol)
+{
+    if(const Symbol* declared = tryGetSymbol(name))
+        throw SymbolResolutionError(SymbolResolutionError::DUP_DECL, declared->getLocator());
+    symbol->locator = this->locator.getChild(name);
+    this->symbols.insert(name, std::move(symbol));
+    // Through the namespaces this one is mounted in, the name may now resolve here rather than in a later overlay
+    // or not at all, the host's own symbols and earlier overlays still come first
+    if(this->mounted)
+        generation++;
 }
 
 void Namespace::declareSymbol(const std::string& name, std::unique_ptr<Symbol> symbol)
 {
-    if(isDeclared(name))
-        throw SymbolResolutionError(SymbolResolutionError::DUP_DECL, this->symbols[name]->getLocator());
-    symbol->locator = this->locator + name;
-    this->symbols[name] = std::move(symbol);
+    declareSymbol(AtomTable::intern(name), std::move(symbol));
+}
+
+void Namespace::undeclareSymbol(atom_t name)
+{
+    if(!this->symbols.erase(name))
+        throw SymbolResolutionError(SymbolResolutionError::NOT_FOUND, this->locator.getChild(name));
+    generation++;
 }
 
 void Namespace::undeclareSymbol(const std::string& name)
 {
-    if(!isDeclared(name))
-        throw SymbolResolutionError(SymbolResolutionError::NOT_FOUND, this->locator + name);
-    this->symbols.erase(name);
+    undeclareSymbol(AtomTable::intern(name));
+}
+
+void Namespace::mount(std::shared_ptr<Namespace> overlay)
+{
+	if(overlay.get() == this)
+		throw BadArgumentError("Cannot mount a namespace into itself");
+	if(std::find(this->overlays.begin(), this->overlays.end(), overlay) != this->overlays.end())
+		return;
+
+	// Every overlay already mounted is compared with the new one, from the smaller side but with nested overlays in full
+	for(const auto& entry : this->symbols)
+		if(overlay->tryGetSymbol(entry.first) != nullptr)
+			throw SymbolResolutionError(SymbolResolutionError::DUP_DECL, entry.second->getLocator());
+	for(const auto& other : this->overlays)
+		if(const Symbol* collision = findCollision(*overlay, *other))
+			throw SymbolResolutionError(SymbolResolutionError::DUP_DECL, collision->getLocator());
+
+	overlay->mounted = true;
+	this->overlays.push_back(std::move(overlay));
+	if(this->mounted)
+		generation++;
+}
+
+const Symbol* Namespace::findCollision(const Namespace& a, const Namespace& b)
+{
+	if(a.symbols.size() > b.symbols.size())
+		return findCollision(b, a);
+	for(const auto& entry : a.symbols)
+		if(b.tryGetSymbol(entry.first) != nullptr)
+			return entry.second.get();
+	for(const auto& overlay : a.overlays)
+		if(const Symbol* collision = findCollision(*overlay, b))
+			return collision;
+	return nullptr;
 }
 
 std::unique_ptr<Symbol> Namespace::clone() const
@@ -2,7 +2,9 @@
 
 #include "include/definitions.h"
 #include "include/exception.h"
+#include "include/atommap.h"
 #include "symbol/locator.h"
+#include <atomic>
 
 namespace wckt::sym
 {
@@ -31,7 +33,8 @@ namespace wckt::sym
 			Locator getLocator() const;
 	};
 	
-	class Symbol
+	/* Symbols are owned by shared pointers, so namespaces can be mounted into other modules (see Namespace::mount) */
+	class Symbol : public std::enable_shared_from_this<Symbol>
 	{
 		private:
 			Locator locator;
@@ -81,7 +84,19 @@ namespace wckt::sym
 	class Namespace : public Symbol
 	{
 		private:
-			std::map<std::string, std::unique_ptr<Symbol>> symbols;
+			/* Incremented whenever a namespace loses symbols or a mounted one gains some, invalidating resolved locators */
+			static std::atomic<uint64_t> generation;
+
+			/* Symbols by interned name */
+			AtomMap<std::shared_ptr<Symbol>> symbols;
+			/* Namespaces of other modules whose symbols are visible here without being copied, searched in order */
+			std::vector<std::shared_ptr<Namespace>> overlays;
+			/* Whether this namespace is an overlay of another, where symbols declared here may become visible */
+			bool mounted;
+
+			/* Returns a symbol visible in both namespaces. Iterates the symbols of the one with fewer of its own, then
+			   every symbol of its overlays, each looked up in the other and through its overlays in turn */
+			static const Symbol* findCollision(const Namespace& a, const Namespace& b);
 			
 		public:
 			Namespace();
@@ -91,14 +106,34 @@ namespace wckt::sym
 			
 			Namespace& operator=(const Namespace& src);
 			
-			const std::map<std::string, std::unique_ptr<Symbol>>& getSymbols() const;
+			static uint64_t getGeneration();
 
+			/* Symbols declared in this namespace, excluding those of mounted namespaces */
+			const AtomMap<std::shared_ptr<Symbol>>& getSymbols() const;
+			const std::vector<std::shared_ptr<Namespace>>& getOverlays() const;
+
+			bool isDeclared(atom_t name) const;
 			bool isDeclared(const std::string& name) const;
+			/* Returns nullptr if there is no such symbol, rather than throwing like getSymbol */
+			const Symbol* tryGetSymbol(atom_t name) const;
+			Symbol* tryGetSymbol(atom_t name);
+			const Symbol& getSymbol(atom_t name) const;
 			const Symbol& getSymbol(const std::string& name) const;
+			Symbol& getSymbol(atom_t name);
 			Symbol& getSymbol(const std::string& name);
 			
+			void declareSymbol(atom_t name, std::unique_ptr<Symbol> symbol);
 			void declareSymbol(const std::string& name, std::unique_ptr<Symbol> symbol);
+			void undeclareSymbol(atom_t name);
 			void undeclareSymbol(const std::string& name);
+
+			/* Makes every symbol of another namespace visible in this one, as it changes. Neither symbols declared
+			   here nor those of other overlays may share a name with one visible in the overlay when it is mounted.
+			   Lookups search this namespace first then overlays in mount order, so a name declared in an overlay
+			   afterwards is hidden by one declared here or in an earlier overlay, and hides those of later overlays.
+			   Collisions are checked against each overlay already mounted with findCollision, so mounting k overlays
+			   of n symbols costs O(k^2 * n) lookups overall: cheap for a module's few dependencies, not for many. */
+			void mount(std::shared_ptr<Namespace> overlay);
 			
 			std::unique_ptr<Symbol> clone() const override;
 
@@ -0,0 +1,744 @@
+#include "type/types.h"
+#include "ast/types/typeops.h"
+#include "ast/types/typevalues.h"
+#include "include/exception.h"
+
+using namespace wckt::type;
+
+namespace
+{
+	void combineHash(size_t& seed, size_t value)
+	{
+		seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+	}
+
+	/* Memoization key of an operation on two types, ordered for commutative operations */
+	uint64_t pairKey(const Type* a, const Type* b, bool commutative)
+	{
+		if(commutative && a->getID() > b->getID())
+			std::swap(a, b);
+		return (uint64_t) a->getID() << 32 | b->getID();
+	}
+
+	const Type* strip(const Type* type)
+	{
+		return type->getKind() == Type::OPTIONAL ? type->getOperand() : type;
+	}
+
+	/* Appends the members of a union or intersection of the given kind, or the type itself */
+	void flatten(const Type* type, Type::kind_t kind, std::vector<const Type*>& members)
+	{
+		if(type->getKind() == kind)
+			members.insert(members.end(), type->getOperands().begin(), type->getOperands().end());
+		else members.push_back(type);
+	}
+
+	/* Operand as it appears in the string of a compound type */
+	std::string operandString(const Type* type)
+	{
+		switch(type->getKind())
+		{
+			case Type::FUNCTION:
+			case Type::UNION:
+			case Type::INTERSECTION:
+			case Type::OPTIONAL:
+				return "(" + type->toString() + ")";
+			default:
+				return type->toString();
+		}
+	}
+}
+
+Type::Type(kind_t kind)
+: kind(kind), id(0), hash(0), index(0), flags(0), returnType(nullptr)
+{}
+
+size_t Type::computeHash() const
+{
+	size_t seed = this->kind;
+	combineHash(seed, std::hash<std::string>()(this->locator));
+	combineHash(seed, this->index);
+	combineHash(seed, this->flags);
+	for(const auto& origin : this->origins)
+		combineHash(seed, std::hash<std::string>()(origin));
+	for(const auto& name : this->names)
+		combineHash(seed, std::hash<std::string>()(name));
+	for(const Type* operand : this->operands)
+		combineHash(seed, operand->id);
+	combineHash(seed, this->returnType == nullptr ? SIZE_MAX : this->returnType->id);
+	return seed;
+}
+
+bool Type::equals(const Type& other) const
+{
+	return this->hash == other.hash && this->kind == other.kind && this->locator == other.locator
+		&& this->index == other.index && this->flags == other.flags && this->origins == other.origins
+		&& this->names == other.names && this->operands == other.operands && this->returnType == other.returnType;
+}
+
+Type::kind_t Type::getKind() const
+{
+	return this->kind;
+}
+
+uint32_t Type::getID() const
+{
+	return this->id;
+}
+
+const std::string& Type::getLocator() const
+{
+	return this->locator;
+}
+
+uint32_t Type::getIndex() const
+{
+	return this->index;
+}
+
+uint32_t Type::getFlags() const
+{
+	return this->flags;
+}
+
+const std::vector<std::string>& Type::getOrigins() const
+{
+	return this->origins;
+}
+
+const std::vector<std::string>& Type::getPropertyNames() const
+{
+	return this->names;
+}
+
+const std::vector<const Type*>& Type::getOperands() const
+{
+	return this->operands;
+}
+
+const Type* Type::getOperand() const
+{
+	return this->operands[0];
+}
+
+const Type* Type::getReturnType() const
+{
+	return this->returnType;
+}
+
+const Type* Type::findProperty(std::string_view name) const
+{
+	auto it = std::lower_bound(this->names.begin(), this->names.end(), name);
+	if(it == this->names.end() || *it != name)
+		return nullptr;
+	return this->operands[it - this->names.begin()];
+}
+
+bool Type::hasOrigin(std::string_view origin) const
+{
+	return std::binary_search(this->origins.begin(), this->origins.end(), origin);
+}
+
+std::string Type::toString() const
+{
+	std::string result;
+	switch(this->kind)
+	{
+		case ERROR:
+			return "[error]";
+
+		case REFERENCE:
+			result = this->locator;
+			for(size_t i = 0 ; i < this->operands.size() ; ++i)
+				result += (i == 0 ? "<" : ", ") + this->operands[i]->toString();
+			return this->operands.empty() ? result : result + ">";
+
+		case GENERIC:
+			return "[generic " + std::to_string(this->index) + "]";
+
+		case CONTRACT:
+		{
+			if(this->flags != 0)
+			{
+				result = "[";
+				if(this->flags & CALLABLE)
+					result += "callable";
+				if(this->flags & SWITCH_BEHAVIOR)
+					result += std::string(this->flags & CALLABLE ? ", " : "") + "switch-behavior";
+				result += "] ";
+			}
+
+			std::vector<std::string> entries;
+			for(const auto& origin : this->origins)
+				entries.push_back("origin " + origin);
+			for(size_t i = 0 ; i < this->names.size() ; ++i)
+				entries.push_back(this->names[i] + ": " + this->operands[i]->toString());
+			if(entries.empty())
+				return result + "{}";
+
+			result += "{ ";
+			for(size_t i = 0 ; i < entries.size() ; ++i)
+				result += (i == 0 ? "" : ", ") + entries[i];
+			return result + " }";
+		}
+
+		case FUNCTION:
+			result = "(";
+			for(size_t i = 0 ; i < this->operands.size() ; ++i)
+				result += (i == 0 ? "" : ", ") + this->operands[i]->toString();
+			return result + ") -> " + (this->returnType == nullptr ? "void" : operandString(this->returnType));
+
+		case UNION:
+		case INTERSECTION:
+			for(size_t i = 0 ; i < this->operands.size() ; ++i)
+				result += (i == 0 ? "" : this->kind == UNION ? " | " : " & ") + operandString(this->operands[i]);
+			return result;
+
+		case OPTIONAL:
+			return operandString(this->operands[0]) + "?";
+
+		default: // Fallback
+			return "[unknown]";
+	}
+}
+
+const uint32_t TypeTable::NO_ASSUMPTION = UINT32_MAX;
+
+TypeTable::TypeTable()
+: dependency(NO_ASSUMPTION)
+{}
+
+const Type* TypeTable::intern(Type&& type)
+{
+	type.hash = type.computeHash();
+	auto it = this->interned.find(&type);
+	if(it != this->interned.end())
+		return *it;
+
+	type.id = this->types.size();
+	this->types.push_back(std::unique_ptr<Type>(new Type(std::move(type))));
+	this->interned.insert(this->types.back().get());
+	return this->types.back().get();
+}
+
+const Type* TypeTable::error()
+{
+	return intern(Type(Type::ERROR));
+}
+
+const Type* TypeTable::reference(const std::string& locator, const std::vector<const Type*>& arguments)
+{
+	Type type(Type::REFERENCE);
+	type.locator = locator;
+	type.operands = arguments;
+	return intern(std::move(type));
+}
+
+const Type* TypeTable::generic(uint32_t index)
+{
+	Type type(Type::GENERIC);
+	type.index = index;
+	return intern(std::move(type));
+}
+
+const Type* TypeTable::contract(const std::vector<std::string>& origins, uint32_t flags,
+	const std::vector<type_property_t>& properties)
+{
+	Type type(Type::CONTRACT);
+	type.flags = flags;
+	type.origins = origins;
+	std::sort(type.origins.begin(), type.origins.end());
+	type.origins.erase(std::unique(type.origins.begin(), type.origins.end()), type.origins.end());
+
+	std::vector<type_property_t> sorted = properties;
+	std::stable_sort(sorted.begin(), sorted.end(), [](const type_property_t& a, const type_property_t& b) {
+		return a.first < b.first;
+	});
+	for(const auto& property : sorted)
+	{
+		if(property.second == nullptr)
+			throw BadArgumentError("Property " + property.first + " has no type");
+		if(!type.names.empty() && type.names.back() == property.first)
+			type.operands.back() = intersect(type.operands.back(), property.second);
+		else
+		{
+			type.names.push_back(property.first);
+			type.operands.push_back(property.second);
+		}
+	}
+	return intern(std::move(type));
+}
+
+const Type* TypeTable::function(const std::vector<const Type*>& parameters, const Type* returnType)
+{
+	Type type(Type::FUNCTION);
+	type.operands = parameters;
+	type.returnType = returnType;
+	return intern(std::move(type));
+}
+
+const Type* TypeTable::optional(const Type* type)
+{
+	// Optionals only appear once at the end of a type, and errors absorb them
+	if(type->getKind() == Type::OPTIONAL || type->getKind() == Type::ERROR)
+		return type;
+	Type result(Type::OPTIONAL);
+	result.operands.push_back(type);
+	return intern(std::move(result));
+}
+
+const Type* TypeTable::unite(const Type* a, const Type* b)
+{
+	if(a == b)
+		return a;
+	if(a->getKind() == Type::ERROR || b->getKind() == Type::ERROR)
+		return error();
+
+	uint64_t key = pairKey(a, b, true);
+	auto cached = this->unions.find(key);
+	if(cached != this->unions.end())
+		return cached->second;
+
+	const Type* result;
+	if(a->getKind() == Type::OPTIONAL || b->getKind() == Type::OPTIONAL)
+		result = optional(unite(strip(a), strip(b)));
+	else
+	{
+		std::vector<const Type*> members;
+		flatten(a, Type::UNION, members);
+		flatten(b, Type::UNION, members);
+		result = combine(members, Type::UNION);
+	}
+	this->unions.emplace(key, result);
+	return result;
+}
+
+const Type* TypeTable::intersect(const Type* a, const Type* b)
+{
+	if(a == b)
+		return a;
+	if(a->getKind() == Type::ERROR || b->getKind() == Type::ERROR)
+		return error();
+
+	uint64_t key = pairKey(a, b, true);
+	auto cached = this->intersections.find(key);
+	if(cached != this->intersections.end())
+		return cached->second;
+
+	const Type* result = nullptr;
+	if(a->getKind() == Type::OPTIONAL && b->getKind() == Type::OPTIONAL)
+		result = optional(intersect(a->getOperand(), b->getOperand()));
+	else if(a->getKind() == Type::OPTIONAL || b->getKind() == Type::OPTIONAL)
+		result = intersect(strip(a), strip(b));
+	else if(a->getKind() == Type::UNION || b->getKind() == Type::UNION)
+	{
+		// Intersections distribute over unions, keeping the result in disjunctive normal form
+		std::vector<const Type*> left, right;
+		flatten(a, Type::UNION, left);
+		flatten(b, Type::UNION, right);
+		for(const Type* l : left)
+			for(const Type* r : right)
+				result = result == nullptr ? intersect(l, r) : unite(result, intersect(l, r));
+	}
+	else
+	{
+		std::vector<const Type*> members;
+		flatten(a, Type::INTERSECTION, members);
+		flatten(b, Type::INTERSECTION, members);
+		result = combine(members, Type::INTERSECTION);
+	}
+	this->intersections.emplace(key, result);
+	return result;
+}
+
+const Type* TypeTable::combine(std::vector<const Type*>& members, Type::kind_t kind)
+{
+	bool isUnion = kind == Type::UNION;
+	const Type* merged = nullptr;
+	std::vector<const Type*> result;
+	for(const Type* member : members)
+	{
+		if(member->getKind() != Type::CONTRACT && member->getKind() != Type::FUNCTION)
+			result.push_back(member);
+		else if(merged == nullptr)
+			merged = member;
+		else if(merged->getKind() == Type::FUNCTION && member->getKind() == Type::FUNCTION)
+			merged = mergeFunctions(merged, member, isUnion);
+		else merged = mergeContracts(asContract(merged), asContract(member), isUnion);
+	}
+	if(merged != nullptr)
+		result.push_back(merged);
+
+	std::sort(result.begin(), result.end(), [](const Type* a, const Type* b) { return a->getID() < b->getID(); });
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	if(result.size() == 1)
+		return result[0];
+
+	Type type(kind);
+	type.operands = std::move(result);
+	return intern(std::move(type));
+}
+
+const Type* TypeTable::mergeContracts(const Type* a, const Type* b, bool isUnion)
+{
+	// Unions intersect the shallow property spaces, origins and flags, and unite the common properties'
+	// types, intersections do the opposite
+	std::vector<std::string> origins;
+	if(isUnion)
+		std::set_intersection(a->getOrigins().begin(), a->getOrigins().end(), b->getOrigins().begin(),
+			b->getOrigins().end(), std::back_inserter(origins));
+	else std::set_union(a->getOrigins().begin(), a->getOrigins().end(), b->getOrigins().begin(),
+		b->getOrigins().end(), std::back_inserter(origins));
+
+	std::vector<type_property_t> properties;
+	const std::vector<std::string>& left = a->getPropertyNames();
+	const std::vector<std::string>& right = b->getPropertyNames();
+	size_t i = 0, j = 0;
+	while(i < left.size() || j < right.size())
+	{
+		if(j == right.size() || (i < left.size() && left[i] < right[j]))
+		{
+			if(!isUnion)
+				properties.push_back({ left[i], a->getOperands()[i] });
+			++i;
+		}
+		else if(i == left.size() || right[j] < left[i])
+		{
+			if(!isUnion)
+				properties.push_back({ right[j], b->getOperands()[j] });
+			++j;
+		}
+		else
+		{
+			const Type* l = a->getOperands()[i++];
+			const Type* r = b->getOperands()[j++];
+			properties.push_back({ left[i - 1], isUnion ? unite(l, r) : intersect(l, r) });
+		}
+	}
+
+	uint32_t flags = isUnion ? a->getFlags() & b->getFlags() : a->getFlags() | b->getFlags();
+	return contract(origins, flags, properties);
+}
+
+const Type* TypeTable::mergeFunctions(const Type* a, const Type* b, bool isUnion)
+{
+	// Unions intersect the arguments and keep extra ones, intersections unite them and make extra ones optional
+	const std::vector<const Type*>& left = a->getOperands();
+	const std::vector<const Type*>& right = b->getOperands();
+	std::vector<const Type*> parameters;
+	for(size_t i = 0 ; i < std::max(left.size(), right.size()) ; ++i)
+	{
+		if(i < left.size() && i < right.size())
+			parameters.push_back(isUnion ? intersect(left[i], right[i]) : unite(left[i], right[i]));
+		else
+		{
+			const Type* extra = i < left.size() ? left[i] : right[i];
+			parameters.push_back(isUnion ? extra : optional(extra));
+		}
+	}
+
+	// A union may return nothing if either does, an intersection returns whatever either returns
+	const Type* l = a->getReturnType();
+	const Type* r = b->getReturnType();
+	const Type* returnType;
+	if(isUnion)
+		returnType = l == nullptr || r == nullptr ? nullptr : unite(l, r);
+	else returnType = l == nullptr ? r : r == nullptr ? l : intersect(l, r);
+	return function(parameters, returnType);
+}
+
+const Type* TypeTable::asContract(const Type* function)
+{
+	if(function->getKind() != Type::FUNCTION)
+		return function;
+	return contract({}, Type::CALLABLE, { { "call", function } });
+}
+
+bool TypeTable::isSubtype(const Type* a, const Type* b)
+{
+	if(a == b || a->getKind() == Type::ERROR || b->getKind() == Type::ERROR)
+		return true;
+
+	uint64_t key = pairKey(a, b, false);
+	auto cached = this->subtypes.find(key);
+	if(cached != this->subtypes.end())
+	{
+		this->dependency = std::min(this->dependency, cached->second.assumption);
+		return cached->second.holds;
+	}
+
+	// Recursive types hold coinductively, a pair already being checked is assumed to hold
+	auto assumed = this->assumptions.find(key);
+	if(assumed != this->assumptions.end())
+	{
+		this->dependency = std::min(this->dependency, assumed->second);
+		return true;
+	}
+
+	uint32_t depth = this->assumptions.size();
+	uint32_t outer = this->dependency;
+	size_t mark = this->provisional.size();
+	this->assumptions.emplace(key, depth);
+	this->dependency = NO_ASSUMPTION;
+	bool holds = computeSubtype(a, b);
+	this->assumptions.erase(key);
+
+	if(!holds)
+	{
+		// Failures hold under any assumptions, but results since the check began may have assumed this pair
+		for(size_t i = mark ; i < this->provisional.size() ; ++i)
+			this->subtypes.erase(this->provisional[i]);
+		this->provisional.resize(mark);
+		this->subtypes[key] = { false, NO_ASSUMPTION };
+		this->dependency = outer;
+	}
+	else if(this->dependency >= depth)
+	{
+		// Every assumption relied on since the check began has been confirmed
+		for(size_t i = mark ; i < this->provisional.size() ; ++i)
+			this->subtypes[this->provisional[i]].assumption = NO_ASSUMPTION;
+		this->provisional.resize(mark);
+		this->subtypes[key] = { true, NO_ASSUMPTION };
+		this->dependency = outer;
+	}
+	else
+	{
+		this->subtypes[key] = { true, this->dependency };
+		this->provisional.push_back(key);
+		this->dependency = std::min(outer, this->dependency);
+	}
+	return holds;
+}
+
+bool TypeTable::computeSubtype(const Type* a, const Type* b)
+{
+	const Type* expandedA = expand(a);
+	const Type* expandedB = expand(b);
+	if(expandedA != a || expandedB != b)
+		return isSubtype(expandedA, expandedB);
+
+	auto all = [](const std::vector<const Type*>& types, auto predicate) {
+		return std::all_of(types.begin(), types.end(), predicate);
+	};
+	auto any = [](const std::vector<const Type*>& types, auto predicate) {
+		return std::any_of(types.begin(), types.end(), predicate);
+	};
+
+	if(b->getKind() == Type::OPTIONAL)
+		return isSubtype(strip(a), b->getOperand());
+	if(a->getKind() == Type::OPTIONAL)
+		return false;
+
+	if(a->getKind() == Type::UNION)
+		return all(a->getOperands(), [&](const Type* member) { return isSubtype(member, b); });
+	if(b->getKind() == Type::INTERSECTION)
+		return all(b->getOperands(), [&](const Type* member) { return isSubtype(a, member); });
+	if(b->getKind() == Type::UNION)
+		return any(b->getOperands(), [&](const Type* member) { return isSubtype(a, member); });
+	if(a->getKind() == Type::INTERSECTION)
+		return any(a->getOperands(), [&](const Type* member) { return isSubtype(member, b); });
+
+	if(a->getKind() == Type::FUNCTION && b->getKind() == Type::FUNCTION)
+	{
+		// Parameters are contravariant and the return type covariant
+		if(a->getOperands().size() != b->getOperands().size())
+			return false;
+		for(size_t i = 0 ; i < a->getOperands().size() ; ++i)
+			if(!isSubtype(b->getOperands()[i], a->getOperands()[i]))
+				return false;
+		if(b->getReturnType() == nullptr)
+			return true;
+		return a->getReturnType() != nullptr && isSubtype(a->getReturnType(), b->getReturnType());
+	}
+
+	a = asContract(a);
+	if(a->getKind() != Type::CONTRACT)
+		return false; // Undefined references and generics are only compared by identity
+
+	if(b->getKind() == Type::FUNCTION)
+	{
+		// Objects are callable through their call property, or any case of a switch function
+		const Type* call = a->findProperty("call");
+		if(call != nullptr && isSubtype(call, b))
+			return true;
+		return (a->getFlags() & Type::SWITCH_BEHAVIOR)
+			&& any(a->getOperands(), [&](const Type* property) { return isSubtype(property, b); });
+	}
+	if(b->getKind() != Type::CONTRACT)
+		return false;
+
+	if((a->getFlags() & b->getFlags()) != b->getFlags())
+		return false;
+	if(!std::includes(a->getOrigins().begin(), a->getOrigins().end(), b->getOrigins().begin(), b->getOrigins().end()))
+		return false;
+	for(size_t i = 0 ; i < b->getPropertyNames().size() ; ++i)
+	{
+		const Type* property = a->findProperty(b->getPropertyNames()[i]);
+		if(property == nullptr || !isSubtype(property, b->getOperands()[i]))
+			return false;
+	}
+	return true;
+}
+
+const Type* TypeTable::expand(const Type* type)
+{
+	if(type->getKind() != Type::REFERENCE && type->getKind() != Type::INTERSECTION)
+		return type;
+	auto cached = this->expansions.find(type->getID());
+	if(cached != this->expansions.end())
+		return cached->second;
+
+	// Cyclic aliases and extensions are left unexpanded rather than unfolded forever
+	this->expansions[type->getID()] = type;
+	const Type* result = type;
+	if(type->getKind() == Type::INTERSECTION)
+	{
+		// Extended types are merged with the extending contract, so their properties are checked together
+		std::vector<const Type*> members;
+		for(const Type* member : type->getOperands())
+			members.push_back(expand(member));
+		if(members != type->getOperands())
+		{
+			result = members[0];
+			for(size_t i = 1 ; i < members.size() ; ++i)
+				result = intersect(result, members[i]);
+		}
+	}
+	else
+	{
+		auto definition = this->definitions.find(type->getLocator());
+		if(definition != this->definitions.end())
+		{
+			if(type->getOperands().size() != definition->second.genericCount)
+				result = error();
+			else result = expand(substitute(definition->second.body, type->getOperands()));
+		}
+	}
+	this->expansions[type->getID()] = result;
+	return result;
+}
+
+const Type* TypeTable::substitute(const Type* type, const std::vector<const Type*>& arguments)
+{
+	if(arguments.empty())
+		return type;
+
+	std::vector<const Type*> operands;
+	for(const Type* operand : type->getOperands())
+		operands.push_back(substitute(operand, arguments));
+
+	switch(type->getKind())
+	{
+		case Type::GENERIC:
+			return type->getIndex() < arguments.size() ? arguments[type->getIndex()] : type;
+
+		case Type::REFERENCE:
+			return reference(type->getLocator(), operands);
+
+		case Type::CONTRACT:
+		{
+			std::vector<type_property_t> properties;
+			for(size_t i = 0 ; i < operands.size() ; ++i)
+				properties.push_back({ type->getPropertyNames()[i], operands[i] });
+			return contract(type->getOrigins(), type->getFlags(), properties);
+		}
+
+		case Type::FUNCTION:
+			return function(operands, type->getReturnType() == nullptr ? nullptr
+				: substitute(type->getReturnType(), arguments));
+
+		case Type::UNION:
+		case Type::INTERSECTION:
+		{
+			const Type* result = operands[0];
+			for(size_t i = 1 ; i < operands.size() ; ++i)
+				result = type->getKind() == Type::UNION ? unite(result, operands[i]) : intersect(result, operands[i]);
+			return result;
+		}
+
+		case Type::OPTIONAL:
+			return optional(operands[0]);
+
+		default:
+			return type;
+	}
+}
+
+void TypeTable::define(const std::string& locator, uint32_t genericCount, const Type* body)
+{
+	if(body == nullptr)
+		throw BadArgumentError("Type " + locator + " has no body");
+	this->definitions[locator] = { genericCount, body };
+
+	// Unions and intersections never unfold references, only subtype results can depend on definitions
+	this->expansions.clear();
+	this->subtypes.clear();
+}
+
+void TypeTable::declare(const std::string& locator, const ast::TypeDeclaration& declaration)
+{
+	std::vector<std::string> generics;
+	if(declaration.getGenericDeclarator() != nullptr)
+		for(const auto& generic : declaration.getGenericDeclarator()->getTypes())
+			generics.push_back(generic.getIdentifier());
+	define(locator, generics.size(), fromExpression(declaration.getValue(), generics));
+}
+
+const Type* TypeTable::fromExpression(const ast::TypeExpression& expression, const std::vector<std::string>& generics)
+{
+	if(const auto* reference = dynamic_cast<const ast::TypeReference*>(&expression))
+	{
+		// Single identifiers may name a generic argument, the innermost declaration shadowing outer ones
+		sym::Locator locator = reference->getLocator();
+		if(locator.length() == 1)
+		{
+			auto generic = std::find(generics.rbegin(), generics.rend(), locator.getPackage(0));
+			if(generic != generics.rend())
+				return this->generic(generics.rend() - generic - 1);
+		}
+
+		std::vector<const Type*> arguments;
+		if(reference->getGenericSpecifier() != nullptr)
+			for(const auto& argument : reference->getGenericSpecifier()->getTypes())
+				arguments.push_back(fromExpression(*argument, generics));
+		return this->reference(locator.toString(), arguments);
+	}
+	if(const auto* unionExpr = dynamic_cast<const ast::UnionExpression*>(&expression))
+		return unite(fromExpression(unionExpr->getLeft(), generics), fromExpression(unionExpr->getRight(), generics));
+	if(const auto* intersectExpr = dynamic_cast<const ast::IntersectExpression*>(&expression))
+		return intersect(fromExpression(intersectExpr->getLeft(), generics), fromExpression(intersectExpr->getRight(), generics));
+	if(const auto* array = dynamic_cast<const ast::ArrayPostfixExpression*>(&expression))
+		return this->reference("Array", { fromExpression(array->getOperand(), generics) }); // semantics.md section 1.4
+	if(const auto* optionalExpr = dynamic_cast<const ast::OptionalPostfixExpression*>(&expression))
+		return optional(fromExpression(optionalExpr->getOperand(), generics));
+
+	if(const auto* functionExpr = dynamic_cast<const ast::FunctionType*>(&expression))
+	{
+		// Generic arguments of the function type are numbered after those of the enclosing declarations
+		std::vector<std::string> scope = generics;
+		if(functionExpr->getGenericDeclarator() != nullptr)
+			for(const auto& generic : functionExpr->getGenericDeclarator()->getTypes())
+				scope.push_back(generic.getIdentifier());
+
+		std::vector<const Type*> parameters;
+		for(const auto& parameter : functionExpr->getParamTypes())
+			parameters.push_back(fromExpression(*parameter, scope));
+		return function(parameters, functionExpr->getReturnType() == nullptr ? nullptr
+			: fromExpression(*functionExpr->getReturnType(), scope));
+	}
+
+	// Erroneous types are already reported, and implicit ones are inferred from values instead
+	if(dynamic_cast<const ast::ErrorType*>(&expression) || dynamic_cast<const ast::ImplicitType*>(&expression))
+		return error();
+	throw BadArgumentError("Unknown type expression " + expression.toString());
+}
+
+size_t TypeTable::getTypeCount() const
+{
+	return this->types.size();
+}
+
+size_t TypeTable::getSubtypeCount() const
+{
+	return this->subtypes.size();
+}
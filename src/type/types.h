@@ -0,0 +1,200 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "ast/types/typeexpr.h"
+#include "ast/decls/typedecl.h"
+#include <unordered_set>
+
+namespace wckt::type
+{
+	class TypeTable;
+
+	/**
+	 * Semantic type, as opposed to the type expressions of the AST. Types are interned by a TypeTable so
+	 * structurally equal types are the same node and compare by pointer. Unions and intersections are kept
+	 * in disjunctive normal form: a union's members are never unions, an intersection's members are never
+	 * unions or intersections, and both are sorted by ID without duplicates. Contracts and function types
+	 * are merged into a single member following the property space rules of semantics.md section 1.
+	 */
+	class Type
+	{
+		public:
+			enum kind_t : uint8_t
+			{
+				/* Type of an erroneous expression, compatible with every type so errors do not cascade */
+				ERROR,
+				/* Declared type, contract or template, with generic arguments as operands */
+				REFERENCE,
+				/* Generic type argument of the enclosing declaration, by index */
+				GENERIC,
+				/* Origins, flags and properties, whose types are the operands */
+				CONTRACT,
+				/* Parameter types as operands, and a return type or nullptr for void */
+				FUNCTION,
+				UNION,
+				INTERSECTION,
+				/* Single operand or null */
+				OPTIONAL
+			};
+
+			/* Flags of contracts (semantics.md sections 1 and 1.8) */
+			enum flag_t : uint32_t
+			{
+				CALLABLE = 0x1,
+				SWITCH_BEHAVIOR = 0x2
+			};
+
+		private:
+			kind_t kind;
+			uint32_t id;
+			size_t hash;
+
+			std::string locator;
+			uint32_t index;
+			uint32_t flags;
+			/* Sorted origin locators and property names of contracts */
+			std::vector<std::string> origins;
+			std::vector<std::string> names;
+			std::vector<const Type*> operands;
+			const Type* returnType;
+
+			Type(kind_t kind);
+			Type(Type&& other) = default;
+
+			/* Structural hash and equality, children being interned already */
+			size_t computeHash() const;
+			bool equals(const Type& other) const;
+
+			friend class TypeTable;
+
+		public:
+			~Type() = default;
+
+			kind_t getKind() const;
+			/* Unique within the type's table, in order of creation */
+			uint32_t getID() const;
+
+			const std::string& getLocator() const;
+			uint32_t getIndex() const;
+			uint32_t getFlags() const;
+			const std::vector<std::string>& getOrigins() const;
+			const std::vector<std::string>& getPropertyNames() const;
+			const std::vector<const Type*>& getOperands() const;
+			/* Operand of optional types */
+			const Type* getOperand() const;
+			const Type* getReturnType() const;
+
+			/* Type of a contract's property, or nullptr */
+			const Type* findProperty(std::string_view name) const;
+			bool hasOrigin(std::string_view origin) const;
+
+			std::string toString() const;
+	};
+
+	/* Property of a contract under construction */
+	typedef std::pair<std::string, const Type*> type_property_t;
+
+	/* Declared type, contract or template, whose body refers to its generic arguments by index */
+	typedef struct
+	{
+		uint32_t genericCount;
+		const Type* body;
+	} type_definition_t;
+
+	/**
+	 * Interns types and memoizes the type algebra over them. Every type built by a table lives as long
+	 * as the table, and types of different tables must not be mixed. References to defined types are
+	 * unfolded lazily by subtype checks, which hold coinductively so recursive types such as linked lists
+	 * are compared in time linear in the number of distinct type pairs reached.
+	 */
+	class TypeTable
+	{
+		private:
+			struct type_hash_t
+			{
+				size_t operator()(const Type* type) const { return type->hash; }
+			};
+
+			struct type_equal_t
+			{
+				bool operator()(const Type* a, const Type* b) const { return a->equals(*b); }
+			};
+
+			std::vector<std::unique_ptr<Type>> types;
+			std::unordered_set<const Type*, type_hash_t, type_equal_t> interned;
+
+			/* Results of binary operations, by operand IDs in the upper and lower half */
+			std::unordered_map<uint64_t, const Type*> unions;
+			std::unordered_map<uint64_t, const Type*> intersections;
+
+			typedef struct
+			{
+				bool holds;
+				/* Depth of the outermost pending check whose assumption the result relies on, or NO_ASSUMPTION */
+				uint32_t assumption;
+			} subtype_result_t;
+
+			static const uint32_t NO_ASSUMPTION;
+
+			std::unordered_map<uint64_t, subtype_result_t> subtypes;
+			/* Pairs being checked, assumed to hold while checking their properties, by depth */
+			std::unordered_map<uint64_t, uint32_t> assumptions;
+			/* Results relying on pending assumptions, dropped if one of those fails */
+			std::vector<uint64_t> provisional;
+			/* Outermost assumption relied on by the current check */
+			uint32_t dependency;
+
+			std::unordered_map<std::string, type_definition_t> definitions;
+			/* Unfolded references and intersections by type ID */
+			std::unordered_map<uint32_t, const Type*> expansions;
+
+			const Type* intern(Type&& type);
+
+			/* Merges contracts and functions into one member, then builds the union or intersection */
+			const Type* combine(std::vector<const Type*>& members, Type::kind_t kind);
+			const Type* mergeContracts(const Type* a, const Type* b, bool isUnion);
+			const Type* mergeFunctions(const Type* a, const Type* b, bool isUnion);
+			/* Function as an object whose call property has the function type (semantics.md section 1.7) */
+			const Type* asContract(const Type* function);
+
+			/* Body of a defined reference, and intersections with their defined members merged */
+			const Type* expand(const Type* type);
+			/* Replaces generic arguments below the count of arguments given */
+			const Type* substitute(const Type* type, const std::vector<const Type*>& arguments);
+
+			bool computeSubtype(const Type* a, const Type* b);
+
+		public:
+			TypeTable();
+			TypeTable(const TypeTable&) = delete;
+			~TypeTable() = default;
+
+			const Type* error();
+			const Type* reference(const std::string& locator, const std::vector<const Type*>& arguments = {});
+			const Type* generic(uint32_t index);
+			/* Properties declared more than once are intersected */
+			const Type* contract(const std::vector<std::string>& origins, uint32_t flags,
+				const std::vector<type_property_t>& properties);
+			/* returnType is nullptr for void */
+			const Type* function(const std::vector<const Type*>& parameters, const Type* returnType);
+			const Type* optional(const Type* type);
+
+			/* Type union and intersection (semantics.md sections 1.1 and 1.2) */
+			const Type* unite(const Type* a, const Type* b);
+			const Type* intersect(const Type* a, const Type* b);
+
+			/* Whether every value of type a is a value of type b, so a implicitly extends b (semantics.md
+			   section 1.6). Undefined references are compared by identity. */
+			bool isSubtype(const Type* a, const Type* b);
+
+			/* Defines the body of references to a locator, discarding subtype results relying on it */
+			void define(const std::string& locator, uint32_t genericCount, const Type* body);
+			void declare(const std::string& locator, const ast::TypeDeclaration& declaration);
+			/* Type of an expression, whose generic arguments are named by generics (innermost last) */
+			const Type* fromExpression(const ast::TypeExpression& expression, const std::vector<std::string>& generics = {});
+
+			size_t getTypeCount() const;
+			/* Number of memoized subtype results, which grows linearly with the type pairs compared */
+			size_t getSubtypeCount() const;
+	};
+}
@@ -0,0 +1,78 @@
+#include "test.h"
+#include "buildw/parser.h"
+#include "buildw/tokenizer.h"
+
+using namespace wckt;
+using namespace wckt::build;
+
+struct counted_t
+{
+	uint32_t& destructed;
+	alignas(32) uint8_t payload[40];
+
+	counted_t(uint32_t& destructed) : destructed(destructed) {}
+	~counted_t() { this->destructed++; }
+};
+
+static void arenaRunsDestructors()
+{
+	uint32_t destructed = 0;
+	{
+		ParseArena arena;
+		std::vector<std::unique_ptr<counted_t, ArenaDeleter>> objects;
+		for(uint32_t i = 0 ; i < 100 ; ++i)
+			objects.push_back(arena.make<counted_t>(destructed));
+		for(const auto& object : objects)
+			TEST_CHECK((uintptr_t) object.get() % alignof(counted_t) == 0);
+		objects.resize(50);
+		TEST_CHECK_EQ(destructed, 50u);
+	}
+	TEST_CHECK_EQ(destructed, 100u);
+}
+
+static void arenaFillsBlocks()
+{
+	ParseArena arena;
+	TEST_CHECK_EQ(arena.getBlockCount(), 0u);
+	for(size_t i = 0 ; i < ParseArena::BLOCK_SIZE / 64 ; ++i)
+		arena.allocate(64, 8);
+	TEST_CHECK_EQ(arena.getBlockCount(), 1u);
+	arena.allocate(64, 8);
+	TEST_CHECK_EQ(arena.getBlockCount(), 2u);
+
+	// Oversized objects get their own block, and the current one keeps being filled
+	uint8_t* before = (uint8_t*) arena.allocate(8, 8);
+	arena.allocate(ParseArena::BLOCK_SIZE * 2, 16);
+	uint8_t* after = (uint8_t*) arena.allocate(8, 8);
+	TEST_CHECK_EQ(arena.getBlockCount(), 3u);
+	TEST_CHECK(after == before + 8);
+	TEST_CHECK_EQ(arena.getAllocationCount(), ParseArena::BLOCK_SIZE / 64 + 4);
+	TEST_CHECK_EQ(arena.getBytesUsed(), ParseArena::BLOCK_SIZE + 64 + 16 + ParseArena::BLOCK_SIZE * 2);
+}
+
+static void translationUnitReleasesItsArena()
+{
+	build_info_t info = {};
+	info.sourceTable = std::make_shared<SourceTable>(base::URL(base::URL::STRING_PROTOCOL, "namespace n { type X as Y; }\n"));
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	services::tokenize(info, &sentinel);
+	services::parse(info, &sentinel);
+	TEST_CHECK(!sentinel.hasErrors() && info.translationUnit != nullptr);
+
+	// Every parse object of the unit is in one arena, which lives exactly as long as the unit
+	ParseTreeDeleter* deleter = std::get_deleter<ParseTreeDeleter>(info.translationUnit);
+	TEST_CHECK(deleter != nullptr && deleter->arenas.size() == 1);
+	std::weak_ptr<ParseArena> arena = deleter->arenas[0];
+	TEST_CHECK(arena.lock()->getAllocationCount() > 0 && arena.lock()->getBlockCount() == 1);
+	info.translationUnit = nullptr;
+	TEST_CHECK(arena.expired());
+}
+
+int main()
+{
+	return test::runCases({
+		{ "arena runs destructors", arenaRunsDestructors },
+		{ "arena fills blocks", arenaFillsBlocks },
+		{ "translation unit releases its arena", translationUnitReleasesItsArena }
+	});
+}
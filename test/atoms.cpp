@@ -0,0 +1,89 @@
+#include "test.h"
+#include "include/atommap.h"
+#include <random>
+#include <unordered_map>
+
+using namespace wckt;
+
+/* Checks map holds exactly the entries of expected, through both find and iteration */
+static bool matches(const AtomMap<uint32_t>& map, const std::unordered_map<atom_t, uint32_t>& expected)
+{
+	if(!TEST_CHECK_EQ(map.size(), expected.size()))
+		return false;
+	size_t iterated = 0;
+	for(const auto& [key, value] : map)
+	{
+		auto it = expected.find(key);
+		if(!TEST_CHECK(it != expected.end() && it->second == value))
+			return false;
+		iterated++;
+	}
+	for(const auto& [key, value] : expected)
+		if(!TEST_CHECK(map.find(key) != nullptr && *map.find(key) == value))
+			return false;
+	return TEST_CHECK_EQ(iterated, expected.size());
+}
+
+static void atomMapMatchesUnorderedMap()
+{
+	// Keys from a small range keep probe sequences long and wrapping, so erasing shifts entries back often
+	std::mt19937 random(17);
+	for(atom_t range : { 16u, 200u, 5000u })
+	{
+		AtomMap<uint32_t> map;
+		std::unordered_map<atom_t, uint32_t> expected;
+		for(uint32_t step = 0 ; step < 100000 ; ++step)
+		{
+			atom_t key = (random() % range) << (random() % 2 ? ATOM_SHARD_BITS : 0);
+			uint32_t value = random();
+			// Inserting more than erasing grows the table, then the map is drained and grows again
+			bool insert = (step / 20000) % 2 == 0 ? random() % 3 != 0 : random() % 3 == 0;
+			if(insert)
+			{
+				bool inserted = expected.emplace(key, value).second;
+				TEST_CHECK_EQ(map.insert(key, std::move(value)), inserted);
+			}
+			else TEST_CHECK_EQ(map.erase(key), expected.erase(key) == 1);
+
+			if(step % 997 == 0 && !matches(map, expected))
+			{
+				std::cerr << "  range " << range << ", step " << step << std::endl;
+				return;
+			}
+		}
+		for(atom_t key = 0 ; key < (range << ATOM_SHARD_BITS) ; ++key)
+			TEST_CHECK_EQ(map.find(key) != nullptr, expected.count(key) == 1);
+		matches(map, expected);
+	}
+}
+
+static void atomMapSurvivesMoves()
+{
+	AtomMap<uint32_t> map;
+	for(atom_t key = 0 ; key < 100 ; ++key)
+		map.insert(key, key * 2);
+
+	// Moved-from maps are empty and usable again
+	AtomMap<uint32_t> moved(std::move(map));
+	TEST_CHECK(map.empty() && map.find(7) == nullptr && map.begin() == map.end());
+	TEST_CHECK(map.insert(7, 1) && *map.find(7) == 1);
+	TEST_CHECK(moved.size() == 100 && *moved.find(99) == 198);
+
+	AtomMap<uint32_t> assigned;
+	assigned.insert(1000, 1);
+	assigned = std::move(moved);
+	TEST_CHECK(moved.empty() && moved.find(99) == nullptr && !moved.erase(99));
+	TEST_CHECK(assigned.size() == 100 && assigned.find(1000) == nullptr && *assigned.find(50) == 100);
+	for(atom_t key = 0 ; key < 100 ; ++key)
+		moved.insert(key, (uint32_t) key);
+	TEST_CHECK_EQ(moved.size(), 100u);
+	TEST_CHECK_THROWS(moved.insert(ATOM_NPOS, 0), BadArgumentError);
+}
+
+int main()
+{
+	return test::runCases({
+		{ "atom map matches unordered map", atomMapMatchesUnorderedMap },
+		{ "atom map survives moves", atomMapSurvivesMoves }
+	});
+}
@@ -0,0 +1,149 @@
+#include "test.h"
+#include "buildw/build.h"
+#include "buildw/cache.h"
+#include <sstream>
+
+using namespace wckt;
+using namespace wckt::build;
+
+/* Builds the asset in a new context, as a new run of the compiler would, and returns its build info */
+static build_info_t buildOnce(const base::URL& url, std::shared_ptr<BuildCache> cache, bool& errors)
+{
+	BuildContext context(std::make_shared<base::EngineContext>(), 0);
+	uint32_t assetID = context.addAsset(url, sym::Locator());
+	context.setCache(cache);
+
+	std::stringstream discard;
+	std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	services::buildFromContext(context, &sentinel);
+	std::cout.rdbuf(previous);
+
+	errors = sentinel.hasErrors();
+	sentinel.clear();
+	return context.getBuildInfo(assetID);
+}
+
+static void cacheSkipsUnchangedAssets()
+{
+	test::TemporaryDirectory directory("build");
+	base::URL url(base::URL::FILE_PROTOCOL, directory.write("asset.wckt", "namespace n { type X as Y; }\n").string());
+	auto cache = std::make_shared<BuildCache>(directory.getPath() / "cache");
+
+	bool errors;
+	build_info_t info = buildOnce(url, cache, errors);
+	TEST_CHECK(!errors && info.translationUnit != nullptr);
+	TEST_CHECK_EQ(cache->getStatistics().misses, 1u);
+
+	// Nothing is tokenized or parsed for an asset that built cleanly from the same source
+	info = buildOnce(url, cache, errors);
+	TEST_CHECK(!errors && info.tokenSequence == nullptr && info.translationUnit == nullptr);
+	TEST_CHECK_EQ(cache->getStatistics().diskHits, 1u);
+	TEST_CHECK(info.sourceChecksum != 0);
+
+	directory.write("asset.wckt", "namespace n { type X as Z; }\n");
+	info = buildOnce(url, cache, errors);
+	TEST_CHECK(!errors && info.translationUnit != nullptr);
+	TEST_CHECK_EQ(cache->getStatistics().misses, 2u);
+	info = buildOnce(url, cache, errors);
+	TEST_CHECK(info.translationUnit == nullptr);
+	TEST_CHECK_EQ(cache->getStatistics().diskHits, 2u);
+}
+
+static void cacheRebuildsAssetsWithErrors()
+{
+	test::TemporaryDirectory directory("build");
+	base::URL url(base::URL::FILE_PROTOCOL, directory.write("asset.wckt", "namespace n { type ; }\n").string());
+	auto cache = std::make_shared<BuildCache>(directory.getPath() / "cache");
+
+	bool errors;
+	buildOnce(url, cache, errors);
+	TEST_CHECK(errors);
+	buildOnce(url, cache, errors);
+	TEST_CHECK(errors);
+	TEST_CHECK(cache->getStatistics().diskHits == 0 && cache->getStatistics().misses == 2);
+}
+
+static void cacheReusesBuildInMemory()
+{
+	test::TemporaryDirectory directory("build");
+	base::URL url(base::URL::FILE_PROTOCOL, directory.write("asset.wckt", "namespace n { }\n").string());
+
+	BuildContext context(std::make_shared<base::EngineContext>(), 0);
+	uint32_t assetID = context.addAsset(url, sym::Locator());
+	context.setCache(std::make_shared<BuildCache>(directory.getPath() / "cache"));
+
+	std::stringstream discard;
+	std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	services::buildFromContext(context, &sentinel);
+	std::shared_ptr<TranslationUnit> unit = context.getBuildInfo(assetID).translationUnit;
+	services::buildFromContext(context, &sentinel);
+	std::cout.rdbuf(previous);
+
+	TEST_CHECK(!sentinel.hasErrors());
+	TEST_CHECK(unit != nullptr && context.getBuildInfo(assetID).translationUnit == unit);
+	TEST_CHECK_EQ(context.getCache()->getStatistics().memoryHits, 1u);
+	sentinel.clear();
+}
+
+static void buildWithoutCacheSkipsChecksum()
+{
+	test::TemporaryDirectory directory("build");
+	base::URL url(base::URL::FILE_PROTOCOL, directory.write("asset.wckt", "namespace n { }\n").string());
+
+	bool errors;
+	build_info_t info = buildOnce(url, nullptr, errors);
+	TEST_CHECK(!errors && info.translationUnit != nullptr && info.sourceChecksum == 0);
+}
+
+/* Messages of the errors building every asset with the given number of jobs */
+static std::vector<std::string> buildErrors(const std::vector<base::URL>& urls, uint32_t jobs)
+{
+	BuildContext context(std::make_shared<base::EngineContext>(), 0);
+	for(const base::URL& url : urls)
+		context.addAsset(url, sym::Locator());
+
+	std::stringstream discard;
+	std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	services::buildFromContext(context, &sentinel, jobs);
+	std::cout.rdbuf(previous);
+
+	std::vector<std::string> messages;
+	for(const auto& error : sentinel.getErrors())
+		messages.push_back(error->what());
+	sentinel.clear();
+	return messages;
+}
+
+static void parallelBuildReportsErrorsInAssetOrder()
+{
+	// Assets get longer towards the start, so workers finish them out of order
+	test::TemporaryDirectory directory("build");
+	std::vector<base::URL> urls;
+	for(uint32_t i = 0 ; i < 16 ; ++i)
+	{
+		std::string source;
+		for(uint32_t j = 0 ; j < (16 - i) * 200 ; ++j)
+			source += "namespace n" + std::to_string(j) + " { }\n";
+		source += i % 2 ? "namespace e" + std::to_string(i) + " { type ; }\n" : "";
+		urls.emplace_back(base::URL::FILE_PROTOCOL, directory.write("asset" + std::to_string(i) + ".wckt", source).string());
+	}
+
+	std::vector<std::string> sequential = buildErrors(urls, 1);
+	TEST_CHECK(sequential.size() >= 8);
+	for(uint32_t jobs : { 4, 16 })
+		TEST_CHECK(buildErrors(urls, jobs) == sequential);
+}
+
+int main()
+{
+	return test::runCases({
+		{ "cache skips unchanged assets", cacheSkipsUnchangedAssets },
+		{ "cache rebuilds assets with errors", cacheRebuildsAssetsWithErrors },
+		{ "cache reuses build in memory", cacheReusesBuildInMemory },
+		{ "build without cache skips checksum", buildWithoutCacheSkipsChecksum },
+		{ "parallel build reports errors in asset order", parallelBuildReportsErrorsInAssetOrder }
+	});
+}
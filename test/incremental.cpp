@@ -0,0 +1,133 @@
+#include "test.h"
+#include "buildw/incremental.h"
+#include "buildw/parser.h"
+#include "ast/include.h"
+
+using namespace wckt;
+using namespace wckt::build;
+
+static const std::string SOURCE =
+	"import a.b;\n"
+	"namespace first { type X as Y; }\n"
+	"namespace second { type Z<T> as W | V; }\n"
+	"namespace third { x: Int = 1 + 2; }\n";
+
+static build_info_t buildSource(const std::string& source)
+{
+	build_info_t info = {};
+	info.sourceTable = std::make_shared<SourceTable>(base::URL(base::URL::STRING_PROTOCOL, source));
+
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	services::tokenize(info, &sentinel);
+	services::parse(info, &sentinel);
+	TEST_CHECK(!sentinel.hasErrors());
+	sentinel.clear();
+	return info;
+}
+
+/* Applies the edit, returns whether it was incremental */
+static bool rebuild(build_info_t& info, size_t position, size_t removed, const std::string& inserted)
+{
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	bool incremental = services::rebuild(info, { position, removed, inserted }, &sentinel);
+	TEST_CHECK(!sentinel.hasErrors());
+	sentinel.clear();
+	return incremental;
+}
+
+static void checkSameTree(const ParseObject* actual, const ParseObject* expected)
+{
+	if(!TEST_CHECK((actual == nullptr) == (expected == nullptr)) || actual == nullptr)
+		return;
+	TEST_CHECK_EQ(actual->toString(), expected->toString());
+	TEST_CHECK(actual->getSegment().getPosition() == expected->getSegment().getPosition()
+		&& actual->getSegment().getLength() == expected->getSegment().getLength());
+
+	std::vector<const ParseObject*> actualElements = actual->getElements(), expectedElements = expected->getElements();
+	if(TEST_CHECK_EQ(actualElements.size(), expectedElements.size()))
+		for(size_t i = 0 ; i < actualElements.size() ; ++i)
+			checkSameTree(actualElements[i], expectedElements[i]);
+}
+
+/* Checks tokens, segments and tree of an incrementally rebuilt asset against a full build of its source */
+static void checkSameAsFullBuild(const build_info_t& info)
+{
+	build_info_t full = buildSource(std::string(info.sourceTable->getSource()));
+
+	const std::vector<Token>& tokens = *info.tokenSequence;
+	const std::vector<Token>& expected = *full.tokenSequence;
+	if(TEST_CHECK_EQ(tokens.size(), expected.size()))
+		for(size_t i = 0 ; i < tokens.size() ; ++i)
+			TEST_CHECK(tokens[i].getClass() == expected[i].getClass() && tokens[i].getPosition() == expected[i].getPosition()
+				&& tokens[i].getLength() == expected[i].getLength());
+
+	const ParseObject* unit = info.translationUnit.get();
+	const ParseObject* expectedUnit = full.translationUnit.get();
+	TEST_CHECK_EQ(unit->toTreeString(), expectedUnit->toTreeString());
+	checkSameTree(unit, expectedUnit);
+}
+
+static void rebuildInsertsIntoDeclaration()
+{
+	build_info_t info = buildSource(SOURCE);
+	TEST_CHECK(rebuild(info, SOURCE.find("type Z"), 0, "type Q as R; "));
+	checkSameAsFullBuild(info);
+	TEST_CHECK(static_cast<const ParseObject*>(info.translationUnit.get())->toTreeString().find("<TypeDeclaration: Q>") != std::string::npos);
+}
+
+static void rebuildDeletesDeclaration()
+{
+	build_info_t info = buildSource(SOURCE);
+	size_t position = SOURCE.find("namespace second");
+	TEST_CHECK(rebuild(info, position, SOURCE.find("namespace third") - position, ""));
+	checkSameAsFullBuild(info);
+	TEST_CHECK(static_cast<const ParseObject*>(info.translationUnit.get())->toTreeString().find("second") == std::string::npos);
+}
+
+static void rebuildSpansDeclarations()
+{
+	// Replaces the end of the first namespace and the start of the second one
+	build_info_t info = buildSource(SOURCE);
+	size_t position = SOURCE.find("Y; }");
+	TEST_CHECK(rebuild(info, position, SOURCE.find("{ type Z") - position, "Y2; type U as V; }\nnamespace renamed "));
+	checkSameAsFullBuild(info);
+	TEST_CHECK(static_cast<const ParseObject*>(info.translationUnit.get())->toTreeString().find("<NamespaceDeclaration: renamed>") != std::string::npos);
+}
+
+static void rebuildMergesTokens()
+{
+	// Removing the operator merges both literals into one token, across the edit
+	build_info_t info = buildSource(SOURCE);
+	TEST_CHECK(rebuild(info, SOURCE.find("1 + 2") + 1, 3, ""));
+	checkSameAsFullBuild(info);
+}
+
+static void rebuildFallsBack()
+{
+	// Edits in the import section are never incremental
+	build_info_t info = buildSource(SOURCE);
+	TEST_CHECK(!rebuild(info, SOURCE.find("a.b"), 1, "c"));
+	checkSameAsFullBuild(info);
+
+	// Every incremental rebuild keeps the previous arenas alive, until a full rebuild compacts them
+	size_t position = SOURCE.find("1 + 2") + 1;
+	size_t incremental = 0;
+	for(; incremental < 32 && rebuild(info, position, 0, " + 3") ; ++incremental)
+		checkSameAsFullBuild(info);
+	TEST_CHECK_EQ(incremental, 15u);
+	TEST_CHECK_EQ(std::get_deleter<ParseTreeDeleter>(info.translationUnit)->arenas.size(), 1u);
+	checkSameAsFullBuild(info);
+	TEST_CHECK(rebuild(info, position, 0, " + 3"));
+	checkSameAsFullBuild(info);
+}
+
+int main()
+{
+	return test::runCases({
+		{ "rebuild inserts into declaration", rebuildInsertsIntoDeclaration },
+		{ "rebuild deletes declaration", rebuildDeletesDeclaration },
+		{ "rebuild spans declarations", rebuildSpansDeclarations },
+		{ "rebuild merges tokens", rebuildMergesTokens },
+		{ "rebuild falls back", rebuildFallsBack }
+	});
+}
@@ -0,0 +1,708 @@
+#include "test.h"
+#include "base/engine.h"
+#include "base/runtime/bytecode.h"
+#include "include/checksum.h"
+#include "include/exception.h"
+#include <cmath>
+#include <thread>
+
+using namespace wckt;
+using namespace wckt::base;
+
+static void putU16(std::string& out, uint16_t value)
+{
+	out += (char) (value & 0xff);
+	out += (char) (value >> 8);
+}
+
+static void putU32(std::string& out, uint32_t value)
+{
+	putU16(out, value & 0xffff);
+	putU16(out, value >> 16);
+}
+
+/* Instructions of a function, labels become its branch table in the order they are placed */
+struct code_t
+{
+	std::string bytes;
+	std::vector<uint16_t> branches;
+
+	code_t& op(uint8_t opcode)
+	{
+		this->bytes += (char) opcode;
+		return *this;
+	}
+
+	code_t& op(uint8_t opcode, uint8_t operand)
+	{
+		this->bytes += (char) opcode;
+		this->bytes += (char) operand;
+		return *this;
+	}
+
+	code_t& label()
+	{
+		this->branches.push_back(this->bytes.length());
+		return *this;
+	}
+};
+
+/* Hand-assembled OPP file, whose initializer stores every named function in its package */
+struct assembler_t
+{
+	uint16_t majorVersion = OPPFile::MAJOR_VERSION;
+	uint8_t minorVersion = OPPFile::MINOR_VERSION;
+	uint32_t sourceChecksum = 0;
+	std::string declarations;
+	std::string constants;
+	uint16_t constantCount = 0;
+	std::string pool;
+	std::vector<std::pair<uint16_t, uint16_t>> named;
+
+	uint16_t constant(uint8_t signature, const std::string& value)
+	{
+		this->constants += (char) signature;
+		this->constants += value;
+		return ++this->constantCount;
+	}
+
+	uint16_t utf8(const std::string& value)
+	{
+		std::string entry;
+		putU16(entry, value.length());
+		return constant(OPPFile::CUTF8, entry + value);
+	}
+
+	uint16_t intLiteral(int32_t value)
+	{
+		std::string entry;
+		putU32(entry, value);
+		return constant(OPPFile::CINTLIT, entry);
+	}
+
+	/* Type of a single conjunction of units */
+	uint16_t type(const std::string& units, bool optional = false)
+	{
+		std::string entry;
+		putU32(entry, 4 + units.length());
+		putU32(entry, units.length());
+		return constant(optional ? OPPFile::COPTTYPE : OPPFile::CTYPE, entry + units);
+	}
+
+	uint16_t function(uint8_t argCount, uint16_t localCount, const code_t& code)
+	{
+		std::string entry;
+		putU32(entry, this->pool.length());
+		putU16(entry, 5 + 2 * code.branches.size() + code.bytes.length());
+
+		this->pool += (char) argCount;
+		putU16(this->pool, localCount);
+		putU16(this->pool, code.branches.size());
+		for(uint16_t branch : code.branches)
+			putU16(this->pool, branch);
+		this->pool += code.bytes;
+		return constant(OPPFile::CFNLIT, entry);
+	}
+
+	uint16_t function(const std::string& name, uint8_t argCount, uint16_t localCount, const code_t& code)
+	{
+		uint16_t index = function(argCount, localCount, code);
+		this->named.push_back({ index, utf8(name) });
+		return index;
+	}
+
+	/* Switch constructor of the given cases, each a CFNLIT taking any arguments */
+	void switchConstructor(const std::string& name, const std::vector<uint16_t>& impls)
+	{
+		this->declarations += (char) OPPFile::DECL_SWITCH_CONSTRUCTOR;
+		this->declarations += '\0';
+		putU16(this->declarations, utf8(name));
+		putU32(this->declarations, 11 * impls.size());
+		for(uint16_t impl : impls)
+		{
+			this->declarations += '\0';
+			putU16(this->declarations, utf8(name));
+			putU16(this->declarations, 0);
+			putU16(this->declarations, impl);
+			putU32(this->declarations, 0);
+		}
+	}
+
+	/* Contract or template of the given property names and types, with an unnamed constructor per impl */
+	void typeDeclaration(uint8_t signature, const std::string& name, const std::vector<std::pair<uint16_t, uint16_t>>& properties,
+		const std::vector<uint16_t>& impls)
+	{
+		this->declarations += (char) signature;
+		this->declarations += '\0';
+		putU16(this->declarations, utf8(name));
+		putU16(this->declarations, 0);
+		putU32(this->declarations, 0);
+		putU32(this->declarations, 5 * properties.size());
+		putU32(this->declarations, 12 * impls.size());
+		for(const auto& [property, type] : properties)
+		{
+			this->declarations += '\0';
+			putU16(this->declarations, property);
+			putU16(this->declarations, type);
+		}
+		for(uint16_t impl : impls)
+		{
+			this->declarations += (char) OPPFile::DECL_CONSTRUCTOR;
+			this->declarations += '\0';
+			putU16(this->declarations, 0);
+			putU16(this->declarations, 0);
+			putU16(this->declarations, impl);
+			putU32(this->declarations, 0);
+		}
+	}
+
+	std::string assemble()
+	{
+		code_t init;
+		for(const auto& [index, name] : this->named)
+			init.op(OP_THIS).op(OP_CONST, index).op(OP_SETPROP, name);
+		uint16_t initializer = function(0, 0, init.op(OP_RETURN));
+
+		std::string file;
+		putU16(file, OPPFile::SIGNATURE);
+		putU16(file, this->majorVersion);
+		file += (char) this->minorVersion;
+		putU32(file, 0);
+		putU32(file, 0);
+		putU32(file, this->sourceChecksum);
+		putU16(file, initializer);
+		putU32(file, this->declarations.length());
+		putU32(file, this->constants.length());
+		return file + this->declarations + this->constants + this->pool;
+	}
+};
+
+/* Contract type unit of properties given by name and type constants */
+static std::string contract(const std::vector<std::pair<uint16_t, uint16_t>>& properties)
+{
+	std::string unit(1, '\0');
+	putU32(unit, 4 * properties.size());
+	for(const auto& [name, type] : properties)
+	{
+		putU16(unit, name);
+		putU16(unit, type);
+	}
+	return unit;
+}
+
+/* Type reference unit without generic arguments */
+static std::string reference(uint16_t locator)
+{
+	std::string unit(1, '\3');
+	putU16(unit, locator);
+	putU32(unit, 0);
+	return unit;
+}
+
+static std::shared_ptr<OPPFile> open(const std::string& contents)
+{
+	return std::make_shared<OPPFile>(URL(URL::STRING_PROTOCOL, "fixture.opp"), std::make_shared<StringBuffer>(std::string(contents)));
+}
+
+/* Engine of a new context, terminated when the fixture goes out of scope */
+struct engine_fixture_t
+{
+	std::shared_ptr<EngineContext> context = std::make_shared<EngineContext>();
+	Engine& engine = Engine::startInstance(this->context);
+
+	~engine_fixture_t()
+	{
+		Engine::terminateInstance(*this->context);
+	}
+
+	void load(assembler_t& assembler)
+	{
+		this->engine.load(sym::Locator("fixture"), open(assembler.assemble()));
+	}
+
+	Value invoke(const std::string& name, const std::vector<Value>& args)
+	{
+		return this->engine.invoke(this->engine.resolve(sym::Locator("fixture." + name)), args);
+	}
+};
+
+static Value integer(Value::kind_t kind, int64_t value)
+{
+	return Value::fromInteger(kind, value);
+}
+
+static void oppChecksFormatVersion()
+{
+	assembler_t assembler;
+	TEST_CHECK_EQ(open(assembler.assemble())->getMajorVersion(), OPPFile::MAJOR_VERSION);
+
+	// Files of the first format have no function headers and no invoke argument counts
+	assembler.majorVersion = 1;
+	TEST_CHECK_THROWS(open(assembler.assemble()), FormatError);
+	assembler.majorVersion = OPPFile::MAJOR_VERSION;
+	assembler.minorVersion = OPPFile::MINOR_VERSION + 1;
+	TEST_CHECK_THROWS(open(assembler.assemble()), FormatError);
+}
+
+static void loadChecksSource()
+{
+	std::string source = "fn f() { return 1 }";
+	URL url(URL::STRING_PROTOCOL, source);
+	assembler_t assembler;
+	assembler.sourceChecksum = crc32(source.data(), source.length());
+	assembler.function("f", 0, 0, code_t().op(OP_ICONST, 1).op(OP_VRETURN));
+
+	engine_fixture_t fixture;
+	fixture.engine.load(sym::Locator("fixture"), open(assembler.assemble()), url);
+	TEST_CHECK_EQ(fixture.invoke("f", {}).getInteger(), 1);
+
+	// A stale file is rejected before any of its symbols are declared
+	engine_fixture_t stale;
+	URL edited(URL::STRING_PROTOCOL, source + " ");
+	TEST_CHECK_THROWS(stale.engine.load(sym::Locator("fixture"), open(assembler.assemble()), edited), BadStateError);
+	TEST_CHECK_THROWS(stale.invoke("f", {}), std::exception);
+}
+
+/* Loads a file whose initializer uses the function, which verifies it */
+static void checkRejected(uint8_t argCount, uint16_t localCount, const code_t& code)
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	assembler.function("f", argCount, localCount, code);
+	TEST_CHECK_THROWS(fixture.load(assembler), FormatError);
+}
+
+static void verifyRejectsInvalidFunctions()
+{
+	checkRejected(0, 0, code_t().op(0xff).op(OP_RETURN));
+	checkRejected(0, 0, code_t().op(OP_ICONST));
+	checkRejected(0, 1, code_t().op(OP_LOAD, 1).op(OP_VRETURN));
+	checkRejected(2, 1, code_t().op(OP_RETURN));
+	checkRejected(0, 0, code_t().op(OP_ICONST, 1).op(OP_NULL));
+	checkRejected(0, 0, code_t().op(OP_GOTO, 1).label().op(OP_RETURN));
+	checkRejected(0, 0, code_t().op(OP_CONST, 200).op(OP_VRETURN));
+
+	// Branch targets must be the start of an instruction
+	code_t code = code_t().op(OP_ICONST, 1).op(OP_VRETURN);
+	code.branches.push_back(1);
+	checkRejected(0, 0, code);
+
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	assembler.function("f", 0, 0, code_t().op(OP_ICONST, 1).label().op(OP_VRETURN));
+	fixture.load(assembler);
+	TEST_CHECK_EQ(fixture.invoke("f", {}).getInteger(), 1);
+}
+
+static void interpreterBranches()
+{
+	// sum(n): s = 0; while(n > 0) { s += n; n-- } return s
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	code_t code;
+	code.op(OP_ICONST, 0).op(OP_STORE, 1)
+		.label().op(OP_LOAD, 0).op(OP_ICONST, 0).op(OP_GRT).op(OP_GOTOIF, 1)
+		.op(OP_LOAD, 1).op(OP_VRETURN)
+		.label().op(OP_LOAD, 1).op(OP_LOAD, 0).op(OP_ADD).op(OP_STORE, 1)
+		.op(OP_LOAD, 0).op(OP_DEC).op(OP_STORE, 0)
+		.op(OP_GOTO, 0);
+	assembler.function("sum", 1, 2, code);
+
+	code_t isNull;
+	isNull.op(OP_LOAD, 0).op(OP_GOTOIFNULL, 0).op(OP_BLCONST_FALSE).op(OP_VRETURN)
+		.label().op(OP_BLCONST_TRUE).op(OP_VRETURN);
+	assembler.function("isNull", 1, 1, isNull);
+	fixture.load(assembler);
+
+	uint64_t before = fixture.engine.getInstructionCount();
+	Value sum = fixture.invoke("sum", { integer(Value::INT, 100) });
+	TEST_CHECK(sum.getKind() == Value::INT && sum.getInteger() == 5050);
+	TEST_CHECK_EQ(fixture.invoke("sum", { integer(Value::INT, 0) }).getInteger(), 0);
+	// 2 to initialize, 13 per iteration and 7 to leave the loop
+	// 2 to initialize, 12 per iteration and 6 to leave the loop
+	TEST_CHECK_EQ(fixture.engine.getInstructionCount() - before, (2 + 100 * 12 + 6) + (2 + 6u));
+
+	TEST_CHECK(fixture.invoke("isNull", { Value() }).getBool());
+	TEST_CHECK(!fixture.invoke("isNull", { integer(Value::INT, 0) }).getBool());
+
+	// gotoif only takes Bool conditions
+	assembler_t invalid;
+	invalid.function("f", 0, 0, code_t().op(OP_ICONST, 1).op(OP_GOTOIF, 0).label().op(OP_RETURN));
+	engine_fixture_t other;
+	other.load(invalid);
+	TEST_CHECK_THROWS(other.invoke("f", {}), ExecutionError);
+}
+
+static void interpreterCallsFunctions()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	uint16_t add = assembler.function("add", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_ADD).op(OP_VRETURN));
+	assembler.function("five", 0, 0, code_t().op(OP_CONST, add).op(OP_ICONST, 2).op(OP_ICONST, 3).op(OP_INVOKE, 2).op(OP_VRETURN));
+	assembler.function("wrongCount", 0, 0, code_t().op(OP_CONST, add).op(OP_ICONST, 2).op(OP_INVOKE, 1).op(OP_VRETURN));
+
+	// fact(n) looks itself up as a static symbol: n <= 1 ? 1 : n * fact(n - 1)
+	uint16_t self = assembler.utf8("fixture.fact");
+	code_t fact;
+	fact.op(OP_LOAD, 0).op(OP_ICONST, 1).op(OP_LTE).op(OP_GOTOIF, 0)
+		.op(OP_LOAD, 0).op(OP_CONST, self).op(OP_LOAD, 0).op(OP_DEC).op(OP_INVOKE, 1).op(OP_MUL).op(OP_VRETURN)
+		.label().op(OP_ICONST, 1).op(OP_VRETURN);
+	assembler.function("fact", 1, 1, fact);
+
+	// Void functions push nothing
+	uint16_t nothing = assembler.function(0, 0, code_t().op(OP_RETURN));
+	assembler.function("afterVoid", 0, 0, code_t().op(OP_ICONST, 7).op(OP_CONST, nothing).op(OP_INVOKE, 0).op(OP_VRETURN));
+	fixture.load(assembler);
+
+	TEST_CHECK_EQ(fixture.invoke("five", {}).getInteger(), 5);
+	TEST_CHECK_EQ(fixture.invoke("fact", { integer(Value::INT, 10) }).getInteger(), 3628800);
+	TEST_CHECK_EQ(fixture.invoke("afterVoid", {}).getInteger(), 7);
+	TEST_CHECK_THROWS(fixture.invoke("wrongCount", {}), ExecutionError);
+	TEST_CHECK_THROWS(fixture.invoke("add", { integer(Value::INT, 1) }), ExecutionError);
+
+	// Unbounded recursion is stopped, and the stack is usable afterwards
+	TEST_CHECK_THROWS(fixture.invoke("fact", { integer(Value::INT, 100000) }), ExecutionError);
+	TEST_CHECK_EQ(fixture.invoke("five", {}).getInteger(), 5);
+}
+
+static void interpreterIntFastPaths()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	assembler.function("add", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_ADD).op(OP_VRETURN));
+	assembler.function("mul", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_MUL).op(OP_VRETURN));
+	assembler.function("lst", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_LST).op(OP_VRETURN));
+	assembler.function("inc", 1, 1, code_t().op(OP_LOAD, 0).op(OP_INC).op(OP_VRETURN));
+	uint16_t max = assembler.intLiteral(INT32_MAX);
+	assembler.function("max", 0, 0, code_t().op(OP_CONST, max).op(OP_VRETURN));
+	fixture.load(assembler);
+
+	// Int results wrap to 32 bits
+	Value result = fixture.invoke("add", { fixture.invoke("max", {}), integer(Value::INT, 1) });
+	TEST_CHECK(result.getKind() == Value::INT && result.getInteger() == INT32_MIN);
+	TEST_CHECK_EQ(fixture.invoke("inc", { integer(Value::INT, INT32_MAX) }).getInteger(), INT32_MIN);
+	TEST_CHECK_EQ(fixture.invoke("mul", { integer(Value::INT, 65536), integer(Value::INT, 65536) }).getInteger(), 0);
+	TEST_CHECK(fixture.invoke("lst", { integer(Value::INT, -1), integer(Value::INT, 1) }).getBool());
+
+	// Other kinds take the generic path, governed by the left operand
+	result = fixture.invoke("add", { integer(Value::LONG, INT32_MAX), integer(Value::INT, 1) });
+	TEST_CHECK(result.getKind() == Value::LONG && result.getInteger() == (int64_t) INT32_MAX + 1);
+	result = fixture.invoke("add", { integer(Value::INT, INT32_MAX), integer(Value::LONG, 1) });
+	TEST_CHECK(result.getKind() == Value::INT && result.getInteger() == INT32_MIN);
+	TEST_CHECK(!fixture.invoke("lst", { integer(Value::ULONG, -1), integer(Value::ULONG, 1) }).getBool());
+	result = fixture.invoke("inc", { integer(Value::BYTE, 127) });
+	TEST_CHECK(result.getKind() == Value::BYTE && result.getInteger() == -128);
+	TEST_CHECK_THROWS(fixture.invoke("add", { integer(Value::INT, 1), Value() }), ExecutionError);
+}
+
+static void interpreterDividesByZero()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	assembler.function("div", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_DIV).op(OP_VRETURN));
+	assembler.function("mod", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_MOD).op(OP_VRETURN));
+	fixture.load(assembler);
+
+	TEST_CHECK_EQ(fixture.invoke("div", { integer(Value::INT, -7), integer(Value::INT, 2) }).getInteger(), -3);
+	TEST_CHECK_EQ(fixture.invoke("mod", { integer(Value::INT, -7), integer(Value::INT, 2) }).getInteger(), -1);
+	TEST_CHECK_THROWS(fixture.invoke("div", { integer(Value::INT, 1), integer(Value::INT, 0) }), ExecutionError);
+	TEST_CHECK_THROWS(fixture.invoke("mod", { integer(Value::LONG, 1), integer(Value::LONG, 0) }), ExecutionError);
+	TEST_CHECK_THROWS(fixture.invoke("div", { integer(Value::ULONG, 1), integer(Value::ULONG, 0) }), ExecutionError);
+
+	// The quotient overflowing a Long wraps, real division by zero is not an error
+	TEST_CHECK_EQ(fixture.invoke("div", { integer(Value::LONG, INT64_MIN), integer(Value::LONG, -1) }).getInteger(), INT64_MIN);
+	TEST_CHECK(std::isinf(fixture.invoke("div", { Value::fromReal(Value::DOUBLE, 1), integer(Value::INT, 0) }).getReal()));
+
+	// A failed frame leaves the stack as it was
+	TEST_CHECK_EQ(fixture.invoke("div", { integer(Value::ULONG, 8), integer(Value::ULONG, 2) }).getInteger(), 4);
+}
+
+static Value object(const std::vector<std::pair<std::string, Value>>& properties)
+{
+	auto object = std::make_shared<Object>();
+	for(const auto& [name, value] : properties)
+		object->setProperty(name, value);
+	return Value::fromObject(object);
+}
+
+static void satisfiesPlansShapes()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	uint16_t x = assembler.utf8("x"), next = assembler.utf8("next");
+	uint16_t point = assembler.type(contract({ { x, assembler.type(reference(assembler.utf8("Int"))) } }));
+	// Node? is { next: Node? }, its own property type refers back to it
+	uint16_t node = assembler.type(contract({ { next, assembler.constantCount + 1 } }), true);
+	TEST_CHECK_EQ(node, assembler.constantCount);
+	assembler.function("isPoint", 1, 1, code_t().op(OP_LOAD, 0).op(OP_SATISFIES, point).op(OP_VRETURN));
+	assembler.function("isNode", 1, 1, code_t().op(OP_LOAD, 0).op(OP_SATISFIES, node).op(OP_VRETURN));
+	fixture.load(assembler);
+
+	TEST_CHECK(fixture.invoke("isPoint", { object({ { "x", integer(Value::INT, 1) } }) }).getBool());
+	runtime_cache_stats_t before = fixture.engine.getSatisfactionStatistics();
+
+	// Objects of the same shape reuse its plan whatever their values, only the values are checked again
+	TEST_CHECK(fixture.invoke("isPoint", { object({ { "x", integer(Value::INT, 2) } }) }).getBool());
+	TEST_CHECK(!fixture.invoke("isPoint", { object({ { "x", integer(Value::LONG, 2) } }) }).getBool());
+	TEST_CHECK(!fixture.invoke("isPoint", { object({ { "x", Value() } }) }).getBool());
+	runtime_cache_stats_t after = fixture.engine.getSatisfactionStatistics();
+	TEST_CHECK(after.hits - before.hits == 3 && after.misses == before.misses);
+
+	TEST_CHECK(!fixture.invoke("isPoint", { object({}) }).getBool());
+	TEST_CHECK(fixture.invoke("isPoint", { object({ { "y", Value() }, { "x", integer(Value::INT, 1) } }) }).getBool());
+	TEST_CHECK(!fixture.invoke("isPoint", { integer(Value::INT, 1) }).getBool());
+	TEST_CHECK_EQ(fixture.engine.getSatisfactionStatistics().misses, after.misses + 2);
+
+	// Cycles hold coinductively, values deeper in the cycle are still checked
+	Value first = object({ { "next", Value() } }), second = object({ { "next", first } });
+	first.getObject().setProperty("next", second);
+	TEST_CHECK(fixture.invoke("isNode", { first }).getBool());
+	second.getObject().setProperty("next", integer(Value::INT, 1));
+	TEST_CHECK(!fixture.invoke("isNode", { first }).getBool());
+	TEST_CHECK(fixture.invoke("isNode", { object({}) }).getBool());
+}
+
+static void constructorsDecodeOnce()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	uint16_t x = assembler.utf8("x");
+	uint16_t init = assembler.function(1, 1, code_t().op(OP_THIS).op(OP_LOAD, 0).op(OP_SETPROP, x).op(OP_RETURN));
+	assembler.switchConstructor("Point", { init });
+	assembler.switchConstructor("Empty", {});
+	uint16_t point = assembler.utf8("fixture.Point"), empty = assembler.utf8("fixture.Empty");
+	assembler.function("point", 0, 1, code_t().op(OP_NEW).op(OP_ICONST, 3).op(OP_INVOKECON, point).op(OP_GETPROP, x).op(OP_VRETURN));
+	assembler.function("empty", 0, 0, code_t().op(OP_NEW).op(OP_INVOKECON, empty).op(OP_VRETURN));
+	fixture.load(assembler);
+
+	TEST_CHECK_EQ(fixture.invoke("point", {}).getInteger(), 3);
+	TEST_CHECK_EQ(fixture.invoke("point", {}).getInteger(), 3);
+
+	// A switch constructor without cases is decoded once, and every invocation fails cleanly
+	TEST_CHECK_THROWS(fixture.invoke("empty", {}), ExecutionError);
+	TEST_CHECK_THROWS(fixture.invoke("empty", {}), ExecutionError);
+	TEST_CHECK_EQ(fixture.invoke("point", {}).getInteger(), 3);
+}
+
+static void templatesShareShapes()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	uint16_t x = assembler.utf8("x"), y = assembler.utf8("y");
+	uint16_t integerType = assembler.type(reference(assembler.utf8("Int")));
+	uint16_t init = assembler.function(2, 2, code_t().op(OP_THIS).op(OP_LOAD, 0).op(OP_SETPROP, x)
+		.op(OP_THIS).op(OP_LOAD, 1).op(OP_SETPROP, y).op(OP_RETURN));
+	assembler.typeDeclaration(OPPFile::DECL_TEMPLATE, "Point", { { x, integerType }, { y, integerType } }, { init });
+	assembler.typeDeclaration(OPPFile::DECL_CONTRACT, "Pointlike", { { x, integerType }, { y, integerType } }, {});
+	uint16_t point = assembler.utf8("fixture.Point");
+	uint16_t isPoint = assembler.type(reference(point)), isPointlike = assembler.type(reference(assembler.utf8("fixture.Pointlike")));
+	assembler.function("make", 2, 2, code_t().op(OP_NEW).op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_INVOKECON, point).op(OP_VRETURN));
+	assembler.function("isPoint", 1, 1, code_t().op(OP_LOAD, 0).op(OP_SATISFIES, isPoint).op(OP_VRETURN));
+	assembler.function("isPointlike", 1, 1, code_t().op(OP_LOAD, 0).op(OP_SATISFIES, isPointlike).op(OP_VRETURN));
+	fixture.load(assembler);
+
+	// Objects initialized by the same constructor share one shape, which records the template as its origin
+	Value first = fixture.invoke("make", { integer(Value::INT, 1), integer(Value::INT, 2) });
+	Value second = fixture.invoke("make", { integer(Value::INT, 3), integer(Value::INT, 4) });
+	const Shape& shape = first.getObject().getShape();
+	TEST_CHECK(&shape == &second.getObject().getShape());
+	TEST_CHECK(shape.hasOrigin("fixture.Point") && shape.getSlotCount() == 2);
+	TEST_CHECK(second.getObject().getSlot(shape.find("x")).getInteger() == 3 && second.getObject().getSlot(shape.find("y")).getInteger() == 4);
+
+	// The same properties without the constructor make another shape, which satisfies the contract but not the template
+	Value literal = object({ { "x", integer(Value::INT, 1) }, { "y", integer(Value::INT, 2) } });
+	TEST_CHECK(&literal.getObject().getShape() != &shape && !literal.getObject().hasOrigin("fixture.Point"));
+	TEST_CHECK(fixture.invoke("isPoint", { first }).getBool());
+	TEST_CHECK(fixture.invoke("isPoint", { second }).getBool());
+	TEST_CHECK(!fixture.invoke("isPoint", { literal }).getBool());
+	TEST_CHECK(fixture.invoke("isPointlike", { literal }).getBool());
+	TEST_CHECK(fixture.invoke("isPointlike", { first }).getBool());
+
+	// An origin does not excuse the property types
+	TEST_CHECK(!fixture.invoke("isPoint", { fixture.invoke("make", { integer(Value::LONG, 1), integer(Value::INT, 2) }) }).getBool());
+	literal.getObject().addOrigin("fixture.Point");
+	TEST_CHECK(fixture.invoke("isPoint", { literal }).getBool());
+}
+
+static void inlineCachesHitAndMiss()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	uint16_t x = assembler.utf8("x");
+	assembler.function("get", 1, 1, code_t().op(OP_LOAD, 0).op(OP_GETPROP, x).op(OP_VRETURN));
+	fixture.load(assembler);
+
+	runtime_cache_stats_t before = fixture.engine.getInlineCacheStatistics();
+	TEST_CHECK_EQ(fixture.invoke("get", { object({ { "x", integer(Value::INT, 1) } }) }).getInteger(), 1);
+	TEST_CHECK_EQ(fixture.invoke("get", { object({ { "x", integer(Value::INT, 2) } }) }).getInteger(), 2);
+	runtime_cache_stats_t after = fixture.engine.getInlineCacheStatistics();
+	TEST_CHECK(after.misses - before.misses == 1 && after.hits - before.hits == 1);
+
+	// Another shape misses once, then both hit
+	Value other = object({ { "y", Value() }, { "x", integer(Value::INT, 3) } });
+	TEST_CHECK_EQ(fixture.invoke("get", { other }).getInteger(), 3);
+	TEST_CHECK_EQ(fixture.invoke("get", { other }).getInteger(), 3);
+	TEST_CHECK_EQ(fixture.invoke("get", { object({ { "x", integer(Value::INT, 4) } }) }).getInteger(), 4);
+	before = after;
+	after = fixture.engine.getInlineCacheStatistics();
+	TEST_CHECK(after.misses - before.misses == 1 && after.hits - before.hits == 2);
+
+	// Missing properties are looked up every time
+	TEST_CHECK(fixture.invoke("get", { object({}) }).getKind() == Value::NONE);
+	TEST_CHECK(fixture.invoke("get", { object({}) }).getKind() == Value::NONE);
+	TEST_CHECK_EQ(fixture.engine.getInlineCacheStatistics().misses - after.misses, 2u);
+}
+
+static void setpropFollowsShapeChanges()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	uint16_t x = assembler.utf8("x");
+	assembler.function("set", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_SETPROP, x).op(OP_RETURN));
+	fixture.load(assembler);
+
+	// The transition from the empty shape is cached, and objects taking it share the resulting shape
+	Value first = object({}), second = object({});
+	fixture.invoke("set", { first, integer(Value::INT, 1) });
+	runtime_cache_stats_t before = fixture.engine.getInlineCacheStatistics();
+	fixture.invoke("set", { second, integer(Value::INT, 2) });
+	TEST_CHECK_EQ(fixture.engine.getInlineCacheStatistics().hits - before.hits, 1u);
+	TEST_CHECK(&first.getObject().getShape() == &second.getObject().getShape());
+	TEST_CHECK_EQ(second.getObject().findProperty("x")->getInteger(), 2);
+
+	// An object which changed shape since it was cached misses, and keeps its properties
+	first.getObject().setProperty("y", integer(Value::INT, 5));
+	before = fixture.engine.getInlineCacheStatistics();
+	fixture.invoke("set", { first, integer(Value::INT, 3) });
+	TEST_CHECK_EQ(fixture.engine.getInlineCacheStatistics().misses - before.misses, 1u);
+	TEST_CHECK_EQ(first.getObject().findProperty("x")->getInteger(), 3);
+	TEST_CHECK_EQ(first.getObject().findProperty("y")->getInteger(), 5);
+	TEST_CHECK_EQ(first.getObject().getShape().getSlotCount(), 2u);
+
+	// The same property in another slot, and a cached transition taken again
+	Value reordered = object({ { "y", integer(Value::INT, 6) }, { "x", Value() } });
+	fixture.invoke("set", { reordered, integer(Value::INT, 4) });
+	TEST_CHECK(reordered.getObject().findProperty("x")->getInteger() == 4 && reordered.getObject().findProperty("y")->getInteger() == 6);
+	Value third = object({});
+	fixture.invoke("set", { third, integer(Value::INT, 7) });
+	TEST_CHECK(&third.getObject().getShape() == &second.getObject().getShape());
+	TEST_CHECK_EQ(third.getObject().getSlot(0).getInteger(), 7);
+}
+
+static void inlineCachesGoMegamorphic()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	uint16_t x = assembler.utf8("x");
+	assembler.function("get", 1, 1, code_t().op(OP_LOAD, 0).op(OP_GETPROP, x).op(OP_VRETURN));
+	assembler.function("set", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_SETPROP, x).op(OP_RETURN));
+	fixture.load(assembler);
+
+	// Object i has x in slot i, past INLINE_CACHE_SIZE shapes the instruction keeps the shapes it saw first
+	std::vector<Value> objects;
+	for(uint32_t i = 0 ; i < INLINE_CACHE_SIZE + 2 ; ++i)
+	{
+		std::vector<std::pair<std::string, Value>> properties;
+		for(uint32_t j = 0 ; j < i ; ++j)
+			properties.push_back({ "p" + std::to_string(j), Value() });
+		properties.push_back({ "x", integer(Value::INT, i) });
+		objects.push_back(object(properties));
+	}
+	for(const Value& value : objects)
+		fixture.invoke("get", { value });
+
+	runtime_cache_stats_t before = fixture.engine.getInlineCacheStatistics();
+	for(uint32_t i = 0 ; i < objects.size() ; ++i)
+		TEST_CHECK_EQ(fixture.invoke("get", { objects[i] }).getInteger(), i);
+	runtime_cache_stats_t after = fixture.engine.getInlineCacheStatistics();
+	TEST_CHECK_EQ(after.hits - before.hits, (uint64_t) INLINE_CACHE_SIZE);
+	TEST_CHECK_EQ(after.misses - before.misses, 2u);
+
+	for(uint32_t round = 0 ; round < 2 ; ++round)
+		for(uint32_t i = 0 ; i < objects.size() ; ++i)
+			fixture.invoke("set", { objects[i], integer(Value::INT, 100 * round + i) });
+	for(uint32_t i = 0 ; i < objects.size() ; ++i)
+		TEST_CHECK(objects[i].getObject().getSlot(i).getInteger() == 100 + i && objects[i].getObject().getShape().getSlotCount() == i + 1);
+}
+
+static void dictionaryObjectsLeaveTheTree()
+{
+	engine_fixture_t fixture;
+	assembler_t assembler;
+	uint16_t name = assembler.utf8("p100"), added = assembler.utf8("q");
+	assembler.function("get", 1, 1, code_t().op(OP_LOAD, 0).op(OP_GETPROP, name).op(OP_VRETURN));
+	assembler.function("set", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_SETPROP, name).op(OP_RETURN));
+	assembler.function("add", 2, 2, code_t().op(OP_LOAD, 0).op(OP_LOAD, 1).op(OP_SETPROP, added).op(OP_RETURN));
+	fixture.load(assembler);
+
+	// Objects share tree shapes up to the threshold
+	Value value = object({}), twin = object({});
+	for(uint32_t i = 0 ; i < 200 ; ++i)
+	{
+		if(i == Shape::DICTIONARY_THRESHOLD)
+			TEST_CHECK(!value.getObject().getShape().isDictionary() && &value.getObject().getShape() == &twin.getObject().getShape());
+		value.getObject().setProperty("p" + std::to_string(i), integer(Value::INT, i));
+		twin.getObject().setProperty("p" + std::to_string(i), integer(Value::INT, i));
+	}
+	TEST_CHECK(value.getObject().getShape().isDictionary() && &value.getObject().getShape() != &twin.getObject().getShape());
+	TEST_CHECK_EQ(value.getObject().getShape().getSlotCount(), 200u);
+	TEST_CHECK_EQ(value.getObject().findProperty("p199")->getInteger(), 199);
+
+	// Dictionary shapes are never cached, properties are still found and added
+	runtime_cache_stats_t before = fixture.engine.getInlineCacheStatistics();
+	TEST_CHECK_EQ(fixture.invoke("get", { value }).getInteger(), 100);
+	fixture.invoke("set", { value, integer(Value::INT, -1) });
+	TEST_CHECK_EQ(fixture.invoke("get", { value }).getInteger(), -1);
+	fixture.invoke("add", { value, integer(Value::INT, 7) });
+	fixture.invoke("add", { value, integer(Value::INT, 8) });
+	runtime_cache_stats_t after = fixture.engine.getInlineCacheStatistics();
+	TEST_CHECK(after.hits == before.hits && after.misses - before.misses == 5);
+	TEST_CHECK(value.getObject().findProperty("q")->getInteger() == 8 && value.getObject().getShape().getSlotCount() == 201);
+	TEST_CHECK_EQ(fixture.invoke("get", { twin }).getInteger(), 100);
+
+	value.getObject().addOrigin("fixture.T");
+	TEST_CHECK(value.getObject().hasOrigin("fixture.T") && !twin.getObject().hasOrigin("fixture.T"));
+}
+
+static void shapesAreSharedAcrossThreads()
+{
+	// Threads making the same transitions at once end up with the same shapes
+	std::vector<const Shape*> shapes(8);
+	std::vector<std::thread> threads;
+	for(uint32_t t = 0 ; t < shapes.size() ; ++t)
+		threads.emplace_back([&shapes, t] {
+			for(uint32_t n = 0 ; n < 100 ; ++n)
+			{
+				Object object;
+				for(uint32_t i = 0 ; i < 40 ; ++i)
+					object.setProperty("threaded" + std::to_string((i + n) % 40), Value());
+				object.addOrigin("fixture.T" + std::to_string(n % 3));
+				shapes[t] = n == 99 ? &object.getShape() : nullptr;
+			}
+		});
+	for(auto& thread : threads)
+		thread.join();
+	for(const Shape* shape : shapes)
+		TEST_CHECK(shape != nullptr && shape == shapes[0]);
+}
+
+int main()
+{
+	return test::runCases({
+		{ "opp checks format version", oppChecksFormatVersion },
+		{ "load checks source", loadChecksSource },
+		{ "verify rejects invalid functions", verifyRejectsInvalidFunctions },
+		{ "interpreter branches", interpreterBranches },
+		{ "interpreter calls functions", interpreterCallsFunctions },
+		{ "interpreter int fast paths", interpreterIntFastPaths },
+		{ "interpreter divides by zero", interpreterDividesByZero },
+		{ "satisfies plans shapes", satisfiesPlansShapes },
+		{ "constructors decode once", constructorsDecodeOnce },
+		{ "templates share shapes", templatesShareShapes },
+		{ "inline caches hit and miss", inlineCachesHitAndMiss },
+		{ "setprop follows shape changes", setpropFollowsShapeChanges },
+		{ "inline caches go megamorphic", inlineCachesGoMegamorphic },
+		{ "dictionary objects leave the tree", dictionaryObjectsLeaveTheTree },
+		{ "shapes are shared across threads", shapesAreSharedAcrossThreads }
+	});
+}
@@ -0,0 +1,144 @@
+#include "test.h"
+#include "buildw/dfa.h"
+#include "buildw/tokenizer.h"
+#include <regex>
+
+using namespace wckt;
+using namespace wckt::build;
+
+/* Longest match by the token class regexps, ties going to the lowest class ID, as the DFA must find it */
+static size_t matchByRegexps(const std::string& str, Token::class_t& _class)
+{
+	static std::vector<std::pair<Token::class_t, std::regex>> regexps = [] {
+		std::vector<std::pair<Token::class_t, std::regex>> regexps;
+		for(const auto& entry : Token::REGEXPS)
+			if(!entry.second.empty())
+				regexps.emplace_back(entry.first, std::regex(entry.second));
+		return regexps;
+	}();
+
+	for(size_t length = str.length() ; length > 0 ; --length)
+		for(const auto& entry : regexps)
+			if(std::regex_match(str.begin(), str.begin() + length, entry.second))
+			{
+				_class = entry.first;
+				return length;
+			}
+	_class = Token::__NULL__;
+	return 0;
+}
+
+static void dfaMatchesRegexps()
+{
+	const std::vector<std::string> samples = {
+		"contract", "contracts", "template", "namespace", "type", "typed", "as", "ask", "extends", "function", "switch",
+		"constructor", "import", "public", "restricted", "private", "partial", "static", "default", "void", "satisfies",
+		"new", "this", "conflict", "operator", "if", "while", "for", "do", "case", "break", "continue", "return", "throw",
+		"try", "catch", "finally", "var", "delegate", "null", "nullable", "true", "false", "falsey", "$abc", "_x9", "A1",
+		"(", ")", "[", "]", "{", "}", ";", ":", ".", ",", "#", "\\", "+", "-", "*", "/", "%", "&", "|", "^", "<<", ">>",
+		"&&", "||", "++", "--", "!", "~", "==", "!=", "===", "!==", ">", ">=", "<", "<=", "?", "->", "=", "+=", ":+=",
+		"<<=", ">>=", ":>>=", "||=", "^=", "---", "----", "+++", "-->", "=>", "<<<",
+		"0", "42", "42L", "7u", "3us", "12ub", "5s", "6b", "0x1F", "0xg", "0b101", "0b102", "0o17", "0o8", "1.5", "1.5f",
+		".5", "3.", "2.25d", "1.2.3", "\'c\'", "\'\\\\\'", "\"hello \\\"world\\\"\"", "\"a\" + \"b\"", "\"", "//", "/*",
+		"/**/", "@", "`", "12us12", "0xffLz"
+	};
+
+	for(const auto& sample : samples)
+		for(size_t length = 1 ; length <= sample.length() ; ++length)
+		{
+			std::string prefix = sample.substr(0, length);
+			Token::class_t expected, actual;
+			size_t expectedLength = matchByRegexps(prefix, expected);
+			size_t actualLength = LexerDFA::standard().match(prefix, actual);
+			if(!TEST_CHECK(actual == expected && (expected == Token::__NULL__ || actualLength == expectedLength)))
+				std::cerr << "  on \'" << prefix << "\': " << Token::getClassName(actual) << " of length " << actualLength
+					<< ", expected " << Token::getClassName(expected) << " of length " << expectedLength << std::endl;
+		}
+}
+
+/* Returns the build info, whose source table resolves the values of its tokens */
+static build_info_t tokenize(const std::string& source, bool& errors)
+{
+	build_info_t info = {};
+	info.sourceTable = std::make_shared<SourceTable>(base::URL(base::URL::STRING_PROTOCOL, source));
+
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	services::tokenize(info, &sentinel);
+	errors = sentinel.hasErrors();
+	TEST_CHECK_EQ(errors, info.syntaxErrors);
+	sentinel.clear();
+	return info;
+}
+
+static void tokenizerProducesTokens()
+{
+	bool errors;
+	build_info_t info = tokenize("x: Int = 0x1F + 12us; // comment\n/* multi\nline */ s := \"a b\" << .5f;", errors);
+	const std::vector<Token>& tokens = *info.tokenSequence;
+	const std::vector<std::pair<Token::class_t, std::string>> expected = {
+		{ Token::IDENTIFIER, "x" }, { Token::DELIM_COLON, ":" }, { Token::IDENTIFIER, "Int" }, { Token::OPERATOR_ASSIGN, "=" },
+		{ Token::INT_LITERAL, "0x1F" }, { Token::OPERATOR_ADD, "+" }, { Token::INT_LITERAL, "12us" },
+		{ Token::DELIM_SEMICOLON, ";" }, { Token::IDENTIFIER, "s" }, { Token::OPERATOR_OTHER_ASSIGN, ":=" },
+		{ Token::STRING_LITERAL, "\"a b\"" }, { Token::OPERATOR_SHL, "<<" }, { Token::FLOAT_LITERAL, ".5f" },
+		{ Token::DELIM_SEMICOLON, ";" }
+	};
+
+	TEST_CHECK(!errors);
+	if(TEST_CHECK_EQ(tokens.size(), expected.size()))
+		for(size_t i = 0 ; i < tokens.size() ; ++i)
+			TEST_CHECK(tokens[i].getClass() == expected[i].first && tokens[i].getValue(*info.sourceTable) == expected[i].second);
+}
+
+static void tokenizerRepairsLiterals()
+{
+	bool errors;
+	build_info_t info = tokenize("s = \"open\nc = \'x", errors);
+	const std::vector<Token>& tokens = *info.tokenSequence;
+
+	TEST_CHECK(errors);
+	if(TEST_CHECK_EQ(tokens.size(), 6u))
+	{
+		TEST_CHECK(tokens[2].getClass() == Token::STRING_LITERAL && tokens[2].getValue(*info.sourceTable) == "\"open\"");
+		TEST_CHECK(tokens[5].getClass() == Token::CHARACTER_LITERAL && tokens[5].getValue(*info.sourceTable) == "\'x\'");
+		// The repaired quote counts towards the segment, but not the source it views
+		TEST_CHECK_EQ(tokens[2].getLength(), 6u);
+		TEST_CHECK_EQ(tokens[2].getView(*info.sourceTable), "\"open");
+	}
+}
+
+static void tokensAreCompact()
+{
+	TEST_CHECK(sizeof(Token) <= 12);
+	
+	bool errors;
+	build_info_t info = tokenize("a b", errors);
+	const std::vector<Token>& tokens = *info.tokenSequence;
+	if(TEST_CHECK_EQ(tokens.size(), 2u))
+	{
+		Token moved = tokens[1].rebase(-2);
+		TEST_CHECK(moved.getPosition() == 0 && moved.getValue(*info.sourceTable) == "a");
+	}
+}
+
+static void tokenizerSkipsDisallowedCharacters()
+{
+	bool errors;
+	build_info_t info = tokenize("a @ b ` c /* open", errors);
+	const std::vector<Token>& tokens = *info.tokenSequence;
+
+	TEST_CHECK(errors);
+	if(TEST_CHECK_EQ(tokens.size(), 3u))
+		for(size_t i = 0 ; i < 3 ; ++i)
+			TEST_CHECK(tokens[i].getClass() == Token::IDENTIFIER && tokens[i].getValue(*info.sourceTable) == std::string(1, 'a' + i));
+}
+
+int main()
+{
+	return test::runCases({
+		{ "dfa matches regexps", dfaMatchesRegexps },
+		{ "tokenizer produces tokens", tokenizerProducesTokens },
+		{ "tokenizer repairs literals", tokenizerRepairsLiterals },
+		{ "tokenizer skips disallowed characters", tokenizerSkipsDisallowedCharacters },
+		{ "tokens are compact", tokensAreCompact }
+	});
+}
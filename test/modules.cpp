@@ -0,0 +1,301 @@
+#include "test.h"
+#include "base/context.h"
+#include "base/modules/dependencies.h"
+#include "base/modules/manifest.h"
+
+using namespace wckt;
+using namespace wckt::base;
+
+static std::string readFile(const std::filesystem::path& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void fileKeysResolveLinks()
+{
+	test::TemporaryDirectory directory("url-links");
+	std::filesystem::path file = directory.write("real/module.xml", "<module>\n</module>\n");
+	std::filesystem::create_symlink(file, directory.getPath() / "link.xml");
+	std::filesystem::create_directory_symlink(directory.getPath() / "real", directory.getPath() / "linked");
+
+	URL url(URL::FILE_PROTOCOL, file.string());
+	TEST_CHECK(URL(URL::FILE_PROTOCOL, (directory.getPath() / "link.xml").string()) == url);
+	TEST_CHECK(URL(URL::FILE_PROTOCOL, (directory.getPath() / "linked" / "module.xml").string()) == url);
+	TEST_CHECK(URL(URL::FILE_PROTOCOL, (directory.getPath() / "linked" / ".." / "link.xml").string()) == url);
+	TEST_CHECK(URL(URL::FILE_PROTOCOL, (directory.getPath() / "real" / "other.xml").string()) != url);
+
+	// Keys of missing files stay lexical, and resolve once the file is created
+	std::filesystem::path missing = directory.getPath() / "missing.xml";
+	TEST_CHECK_EQ(std::string(URL(URL::FILE_PROTOCOL, missing.string()).getKey()), std::filesystem::canonical(directory.getPath()) / "missing.xml");
+	std::filesystem::create_symlink(file, missing);
+	TEST_CHECK(URL(URL::FILE_PROTOCOL, missing.string()) == url);
+}
+
+static void stringKeysAreNotInterned()
+{
+	// Sources of str:// URLs are whole modulefiles or assets, which the atom table would keep for good
+	size_t atoms = AtomTable::getAtomCount();
+	std::unordered_map<URL, uint32_t, URL::hasher_t> urls;
+	for(uint32_t i = 0 ; i < 1000 ; ++i)
+		urls.emplace(URL(URL::STRING_PROTOCOL, std::string(4096, 'x') + std::to_string(i)), i);
+	TEST_CHECK_EQ(AtomTable::getAtomCount(), atoms);
+
+	URL url(URL::STRING_PROTOCOL, std::string(4096, 'x') + "7");
+	TEST_CHECK(urls.at(url) == 7 && url.getKey() == url.getSource());
+	TEST_CHECK(url == URL("str://" + url.getSource()) && url != URL(URL::STRING_PROTOCOL, std::string(4096, 'x') + "8"));
+	TEST_CHECK(URL(URL::STRING_PROTOCOL, "") == URL(URL::STRING_PROTOCOL, "") && URL(URL::STRING_PROTOCOL, "") != URL());
+	TEST_CHECK(URL() == URL() && URL().getKey().empty());
+
+	// File keys are still interned, once per file
+	test::TemporaryDirectory directory("url-keys");
+	std::filesystem::path file = directory.write("module.xml", "<module>\n</module>\n");
+	atoms = AtomTable::getAtomCount();
+	URL first(URL::FILE_PROTOCOL, file.string()), second(URL::FILE_PROTOCOL, file.string());
+	TEST_CHECK(first == second && AtomTable::getAtomCount() == atoms + 1);
+}
+
+static void manifestRestampsTouchedModulefiles()
+{
+	test::TemporaryDirectory directory("manifest-stamps");
+	std::filesystem::path file = directory.write("module.xml",
+		"<module>\n\t<packages>\n\t\t<package name=\"p\">\n\t\t\t<asset src=\"file://a.wckt\">\n\t\t</package>\n\t</packages>\n</module>\n");
+	URL url(URL::FILE_PROTOCOL, file.string());
+	ManifestCache cache(directory.getPath() / "cache");
+	TEST_CHECK(cache.getModule(url, DependencyResolver::modgenfuncDefault()) != nullptr);
+
+	std::filesystem::path entry = std::filesystem::directory_iterator(cache.getDirectory())->path();
+	std::string manifest = readFile(entry);
+
+	// A touched modulefile matches by hash, and its manifest is rewritten with the new time
+	std::filesystem::last_write_time(file, std::filesystem::last_write_time(file) + std::chrono::hours(1));
+	std::shared_ptr<Module> module = cache.getModule(url, DependencyResolver::modgenfuncDefault());
+	TEST_CHECK(module != nullptr && module->getRootPackage().getChildren().size() == 1);
+	TEST_CHECK(readFile(entry) != manifest);
+	TEST_CHECK_EQ(cache.getStatistics().hits, 1);
+
+	// Changed contents are a miss
+	directory.write("module.xml", "<module>\n</module>\n");
+	module = cache.getModule(url, DependencyResolver::modgenfuncDefault());
+	TEST_CHECK(module != nullptr && module->getRootPackage().getChildren().empty());
+	TEST_CHECK_EQ(cache.getStatistics().misses, 2);
+}
+
+typedef std::unordered_map<URL, std::shared_ptr<Module>, URL::hasher_t> graph_t;
+
+static URL moduleURL(const std::string& name)
+{
+	return URL(URL::STRING_PROTOCOL, name);
+}
+
+/* Module declaring lib.<name>.a and importing lib.<dep> of each dependency as imports.<dep> */
+static void addModule(graph_t& graph, const std::string& name, const std::vector<std::string>& deps)
+{
+	std::vector<ModuleDependency> dependencies;
+	for(const std::string& dep : deps)
+		dependencies.emplace_back(moduleURL(dep), sym::Locator("lib." + dep), sym::Locator("imports." + dep));
+	Package lib("lib", VIS_PUBLIC, { Package(name, VIS_PUBLIC, { Package("a", VIS_PUBLIC) }) });
+	graph[moduleURL(name)] = std::make_shared<Module>(moduleURL(name), dependencies, Package("", VIS_PUBLIC, { lib }));
+}
+
+/* Fetches copies of the graph's modules, taking longer for some so parallel fetches complete out of order */
+static modgenfunc_t fetchFrom(const graph_t& graph)
+{
+	return [&graph](const URL& url) {
+		std::this_thread::sleep_for(std::chrono::microseconds(URL::hasher_t()(url) % 7 * 300));
+		auto it = graph.find(url);
+		if(it == graph.end())
+			throw IOError("Cannot fetch " + url.toString());
+		return std::make_shared<Module>(*it->second);
+	};
+}
+
+/* Locator with the modulefile of its module in place of the module ID, which depends on unpacking order */
+static std::string describe(const EngineContext& context, const sym::Locator& locator)
+{
+	if(locator.getModuleID() == _MODULEID_NPOS)
+		return locator.toString();
+	return context.getModule(locator.getModuleID()).getSource()->getModulefile().toString() + ":" + sym::Locator(locator.getPackages()).toString();
+}
+
+/* Symbols declared in a scope and visible through its overlays, named by module rather than by module ID */
+static void listSymbols(const EngineContext& context, const sym::Namespace& scope, const std::string& path, std::vector<std::string>& out)
+{
+	for(const auto& [name, symbol] : scope.getSymbols())
+	{
+		std::string child = path + "." + std::string(AtomTable::getString(name));
+		if(const auto* reference = dynamic_cast<const sym::ReferenceSymbol*>(symbol.get()))
+			out.push_back(child + " -> " + describe(context, reference->getTarget()));
+		else out.push_back(child);
+		if(const auto* _namespace = dynamic_cast<const sym::Namespace*>(symbol.get()))
+			listSymbols(context, *_namespace, child, out);
+	}
+	for(const auto& overlay : scope.getOverlays())
+		out.push_back(path + " mounts " + describe(context, overlay->getLocator()));
+}
+
+/* Registry and declared symbols of the graph loaded from its root module on jobs threads, sorted */
+static std::vector<std::string> loadGraph(const graph_t& graph, const std::string& root, uint32_t jobs)
+{
+	DependencyResolver resolver(moduleURL(root), fetchFrom(graph), jobs);
+	auto context = std::make_shared<EngineContext>();
+	context->unpackModules(resolver.computeTopologicalLevels(), jobs);
+
+	std::vector<std::string> out;
+	for(const auto& [url, module] : resolver.getModuleRegistry())
+	{
+		out.push_back(url.toString() + " registers " + module->getModulefile().toString());
+		listSymbols(*context, context->getModule(url).getSymbolTable(), url.toString(), out);
+	}
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+static void parallelResolutionMatchesSequential()
+{
+	// Levels of 6 modules, each importing three of the next level, with every module reachable from the root
+	graph_t graph;
+	std::vector<std::string> top;
+	for(uint32_t level = 0 ; level < 5 ; ++level)
+		for(uint32_t i = 0 ; i < 6 ; ++i)
+		{
+			std::vector<std::string> deps;
+			for(uint32_t offset : { 0, 1, 4 })
+				if(level < 4)
+					deps.push_back("m" + std::to_string(level + 1) + "_" + std::to_string((i + offset) % 6));
+			addModule(graph, "m" + std::to_string(level) + "_" + std::to_string(i), deps);
+			if(level == 0)
+				top.push_back("m0_" + std::to_string(i));
+		}
+	addModule(graph, "root", top);
+
+	std::vector<std::string> sequential = loadGraph(graph, "root", 1);
+	auto count = [&sequential](const char* kind) {
+		return std::count_if(sequential.begin(), sequential.end(), [kind](const std::string& line) { return line.find(kind) != std::string::npos; });
+	};
+	TEST_CHECK_EQ(count(" registers "), 31);
+	TEST_CHECK_EQ(count(" mounts "), 30);
+	for(uint32_t jobs : { 2, 8 })
+		TEST_CHECK(loadGraph(graph, "root", jobs) == sequential);
+}
+
+/* Message of the error the resolver throws for the graph, on jobs threads */
+static std::string resolutionError(const graph_t& graph, const std::string& root, uint32_t jobs)
+{
+	try
+	{ DependencyResolver resolver(moduleURL(root), fetchFrom(graph), jobs); }
+	catch(const err::WickitError& e)
+	{ return e.getTop().what(); }
+	return "";
+}
+
+static void failedFetchReportsDependencyChain()
+{
+	// root -> a -> b -> missing, and c -> absent fetched in the same wave
+	graph_t graph;
+	addModule(graph, "root", { "a", "c" });
+	addModule(graph, "a", { "b" });
+	addModule(graph, "b", { "missing" });
+	addModule(graph, "c", { "d" });
+	addModule(graph, "d", { "absent" });
+
+	// The innermost dependent comes first, as when the resolver went depth first
+	std::string message = resolutionError(graph, "root", 1);
+	size_t cause = message.find("Cannot fetch str://missing"), b = message.find("Dependency of str://b"),
+		a = message.find("Dependency of str://a"), root = message.find("Dependency of str://root");
+	TEST_CHECK(cause != std::string::npos && b != std::string::npos && a != std::string::npos && root != std::string::npos);
+	TEST_CHECK(cause < b && b < a && a < root);
+	TEST_CHECK(message.find("absent") == std::string::npos && message.find("str://c") == std::string::npos);
+
+	// The first failure in dependency order is reported, whichever fetch fails first
+	for(uint32_t jobs : { 2, 8 })
+		TEST_CHECK_EQ(resolutionError(graph, "root", jobs), message);
+}
+
+/* Modulefiles of each level, sorted within the level */
+static std::vector<std::vector<std::string>> levelNames(const DependencyResolver& resolver)
+{
+	std::vector<std::vector<std::string>> names;
+	for(const auto& level : resolver.computeTopologicalLevels())
+	{
+		names.emplace_back();
+		for(const auto& module : level)
+			names.back().push_back(module->getModulefile().toString());
+		std::sort(names.back().begin(), names.back().end());
+	}
+	return names;
+}
+
+static void diamondSortsIntoLevels()
+{
+	// root -> left, right -> base, and root -> base directly, which must not pull base up a level
+	graph_t graph;
+	addModule(graph, "root", { "left", "base", "right" });
+	addModule(graph, "left", { "base" });
+	addModule(graph, "right", { "base" });
+	addModule(graph, "base", {});
+	DependencyResolver resolver(moduleURL("root"), fetchFrom(graph), 1);
+
+	std::vector<std::vector<std::string>> expected = { { "str://base" }, { "str://left", "str://right" }, { "str://root" } };
+	TEST_CHECK(levelNames(resolver) == expected);
+	std::vector<std::shared_ptr<Module>> order = resolver.computeTopologicalOrder();
+	TEST_CHECK(order.size() == 4 && order.front()->getModulefile() == moduleURL("base") && order.back()->getModulefile() == moduleURL("root"));
+}
+
+/* Cycle of the error thrown when sorting the graph loaded from root, which every sort must throw */
+static std::vector<URL> findCycle(const graph_t& graph, const std::string& root)
+{
+	DependencyResolver resolver(moduleURL(root), fetchFrom(graph), 1);
+	TEST_CHECK_THROWS(resolver.computeTopologicalOrder(), CyclicDependencyError);
+	try
+	{ resolver.computeTopologicalLevels(); }
+	catch(const CyclicDependencyError& e)
+	{ return e.cycle; }
+	return {};
+}
+
+static void cyclesAreReported()
+{
+	// root and tail lead into a -> b -> c -> a and hang off it, but are not part of it
+	graph_t graph;
+	addModule(graph, "root", { "tail", "a" });
+	addModule(graph, "a", { "b" });
+	addModule(graph, "b", { "c", "tail" });
+	addModule(graph, "c", { "a" });
+	addModule(graph, "tail", {});
+	std::vector<URL> cycle = findCycle(graph, "root");
+	TEST_CHECK(cycle.size() == 4 && cycle.front() == cycle.back());
+
+	// Whichever module it starts from, each depends on the next
+	std::vector<URL> members(cycle.begin(), cycle.end() - 1);
+	for(size_t i = 0 ; i + 1 < cycle.size() ; ++i)
+	{
+		const auto& deps = graph.at(cycle[i])->getDependencies();
+		TEST_CHECK(std::any_of(deps.begin(), deps.end(), [&next = cycle[i + 1]](const ModuleDependency& dep) { return dep.getModuleURL() == next; }));
+	}
+	std::vector<std::string> names;
+	for(const URL& url : members)
+		names.push_back(url.toString());
+	std::sort(names.begin(), names.end());
+	TEST_CHECK(names == std::vector<std::string>({ "str://a", "str://b", "str://c" }));
+
+	// A module depending on itself is a cycle of one
+	graph_t self;
+	addModule(self, "root", { "self" });
+	addModule(self, "self", { "self" });
+	TEST_CHECK(findCycle(self, "root") == std::vector<URL>({ moduleURL("self"), moduleURL("self") }));
+	TEST_CHECK(findCycle(self, "self") == std::vector<URL>({ moduleURL("self"), moduleURL("self") }));
+}
+
+int main()
+{
+	return test::runCases({
+		{ "file keys resolve links", fileKeysResolveLinks },
+		{ "string keys are not interned", stringKeysAreNotInterned },
+		{ "manifest restamps touched modulefiles", manifestRestampsTouchedModulefiles },
+		{ "parallel resolution matches sequential", parallelResolutionMatchesSequential },
+		{ "failed fetch reports dependency chain", failedFetchReportsDependencyChain },
+		{ "diamond sorts into levels", diamondSortsIntoLevels },
+		{ "cycles are reported", cyclesAreReported }
+	});
+}
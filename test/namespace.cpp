@@ -0,0 +1,80 @@
+#include "test.h"
+#include "base/context.h"
+#include "symbol/symbol.h"
+
+using namespace wckt;
+using namespace wckt::sym;
+
+static std::shared_ptr<Namespace> namespaceOf(std::initializer_list<const char*> names)
+{
+	auto _namespace = std::make_shared<Namespace>();
+	for(const char* name : names)
+		_namespace->declareSymbol(name, std::make_unique<Symbol>());
+	return _namespace;
+}
+
+static void mountRejectsCollisions()
+{
+	// With the overlay's own symbols
+	auto container = namespaceOf({ "a" });
+	TEST_CHECK_THROWS(container->mount(namespaceOf({ "b", "a" })), SymbolResolutionError);
+	container->mount(namespaceOf({ "b" }));
+	TEST_CHECK_THROWS(container->declareSymbol("b", std::make_unique<Symbol>()), SymbolResolutionError);
+
+	// With those of other overlays, whichever side is smaller, and those visible through their own overlays
+	TEST_CHECK_THROWS(container->mount(namespaceOf({ "b" })), SymbolResolutionError);
+	TEST_CHECK_THROWS(container->mount(namespaceOf({ "c", "d", "e", "b" })), SymbolResolutionError);
+	auto nested = namespaceOf({ "f" });
+	nested->mount(namespaceOf({ "b" }));
+	TEST_CHECK_THROWS(container->mount(nested), SymbolResolutionError);
+	TEST_CHECK_EQ(container->getOverlays().size(), 1);
+
+	auto other = namespaceOf({ "c" });
+	container->mount(other);
+	container->mount(other);
+	TEST_CHECK_EQ(container->getOverlays().size(), 2);
+	TEST_CHECK(container->isDeclared("a") && container->isDeclared("b") && container->isDeclared("c"));
+	TEST_CHECK_THROWS(container->mount(container), BadArgumentError);
+}
+
+static void shadowingInvalidatesLocators()
+{
+	auto context = std::make_shared<base::EngineContext>();
+	moduleid_t moduleID = context->unpackModule(std::make_shared<base::Module>(base::URL(base::URL::STRING_PROTOCOL, "test")));
+	Namespace& container = Namespace::assertSymbol(Locator(moduleID, "wckt.container").locateOrDeclare(*context));
+	auto first = namespaceOf({});
+	auto second = namespaceOf({ "x" });
+	container.mount(first);
+	container.mount(second);
+
+	Locator x(moduleID, "wckt.container.x");
+	TEST_CHECK(&x.locate(*context) == second->tryGetSymbol(AtomTable::intern("x")));
+
+	// The earlier overlay now shadows the later one, which the cached resolution must not hide
+	first->declareSymbol("x", std::make_unique<Symbol>());
+	TEST_CHECK(&x.locate(*context) == first->tryGetSymbol(AtomTable::intern("x")));
+
+	// Likewise when an overlay of a mounted namespace gains symbols
+	auto inner = namespaceOf({});
+	Locator y(moduleID, "wckt.container.y");
+	second->declareSymbol("y", std::make_unique<Symbol>());
+	TEST_CHECK(&y.locate(*context) == second->tryGetSymbol(AtomTable::intern("y")));
+	first->mount(inner);
+	inner->declareSymbol("y", std::make_unique<Symbol>());
+	TEST_CHECK(&y.locate(*context) == inner->tryGetSymbol(AtomTable::intern("y")));
+
+	// Symbols declared in the container itself come before any an overlay declares later
+	container.declareSymbol("z", std::make_unique<Symbol>());
+	const Symbol* own = container.getSymbols().find(AtomTable::intern("z"))->get();
+	first->declareSymbol("z", std::make_unique<Symbol>());
+	TEST_CHECK(&Locator(moduleID, "wckt.container.z").locate(*context) == own);
+	TEST_CHECK(container.tryGetSymbol(AtomTable::intern("z")) == own);
+}
+
+int main()
+{
+	return test::runCases({
+		{ "mount rejects collisions", mountRejectsCollisions },
+		{ "shadowing invalidates locators", shadowingInvalidatesLocators }
+	});
+}
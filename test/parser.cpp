@@ -0,0 +1,105 @@
+#include "test.h"
+#include "buildw/parser.h"
+#include "ast/include.h"
+
+using namespace wckt;
+using namespace wckt::build;
+
+/* Returns the build info, whose source table resolves the values of its tokens */
+static build_info_t parse(const std::string& source, bool& errors)
+{
+	build_info_t info = {};
+	info.sourceTable = std::make_shared<SourceTable>(base::URL(base::URL::STRING_PROTOCOL, source));
+
+	err::ErrorSentinel sentinel(err::ErrorSentinel::COLLECT, err::ErrorSentinel::NO_CONTEXT_FN);
+	services::tokenize(info, &sentinel);
+	services::parse(info, &sentinel);
+	errors = sentinel.hasErrors();
+	TEST_CHECK_EQ(errors, info.syntaxErrors);
+	sentinel.clear();
+	return info;
+}
+
+static std::string treeOf(const build_info_t& info)
+{ return info.translationUnit ? static_cast<const ParseObject*>(info.translationUnit.get())->toTreeString() : ""; }
+
+static void parserBuildsTree()
+{
+	bool errors;
+	build_info_t info = parse("import a.b.*;\nnamespace n\n{\n\ttype T<U satisfies V> as A | B & C[];\n\tnamespace m { }\n}\n", errors);
+
+	TEST_CHECK(!errors);
+	TEST_CHECK_EQ(treeOf(info),
+		"<TranslationUnit>\n"
+		"   <ImportStatement: a.b.*>\n"
+		"   <DeclarationSet>\n"
+		"      <NamespaceDeclaration: n>\n"
+		"         <DeclarationSet>\n"
+		"            <TypeDeclaration: T>\n"
+		"               <GenericTypeDeclarator>\n"
+		"                  <GenericType 'U'>\n"
+		"                     <TypeReference: V>\n"
+		"                  </GenericType 'U'>\n"
+		"               </GenericTypeDeclarator>\n"
+		"               <UnionExpression>\n"
+		"                  <TypeReference: A>\n"
+		"                  <IntersectExpression>\n"
+		"                     <TypeReference: B>\n"
+		"                     <ArrayPostfixExpression>\n"
+		"                        <TypeReference: C>\n"
+		"                     </ArrayPostfixExpression>\n"
+		"                  </IntersectExpression>\n"
+		"               </UnionExpression>\n"
+		"            </TypeDeclaration: T>\n"
+		"            <NamespaceDeclaration: m>\n"
+		"               <DeclarationSet>\n"
+		"            </NamespaceDeclaration: m>\n"
+		"         </DeclarationSet>\n"
+		"      </NamespaceDeclaration: n>\n"
+		"   </DeclarationSet>\n"
+		"</TranslationUnit>");
+}
+
+static void parserParsesExpressions()
+{
+	bool errors;
+	parse("namespace n { x: Int = 1 + 2 * f<T>(3, [4]) - -y.z[0]++; f = a -> a << 2; }", errors);
+	TEST_CHECK(!errors);
+}
+
+static void parserRecoversFromErrors()
+{
+	bool errors;
+	build_info_t info = parse("namespace n { type ; type X as Y; }\nnamespace m { }\n", errors);
+
+	TEST_CHECK(errors);
+	TEST_CHECK(treeOf(info).find("<TypeDeclaration: X>") != std::string::npos);
+	TEST_CHECK(treeOf(info).find("<NamespaceDeclaration: m>") != std::string::npos);
+}
+
+static void parserSetsSegments()
+{
+	bool errors;
+	const std::string source = "import a;\nnamespace n { type X as Y; }\n";
+	build_info_t info = parse(source, errors);
+
+	TEST_CHECK(!errors);
+	std::vector<ParseObject*> elements = static_cast<ParseObject*>(info.translationUnit.get())->getElements();
+	if(TEST_CHECK_EQ(elements.size(), 2u))
+	{
+		SourceSegment import = elements[0]->getSegment();
+		TEST_CHECK_EQ(source.substr(import.getPosition(), import.getLength()), "import a;");
+		SourceSegment set = elements[1]->getSegment();
+		TEST_CHECK_EQ(source.substr(set.getPosition(), set.getLength()), "namespace n { type X as Y; }");
+	}
+}
+
+int main()
+{
+	return test::runCases({
+		{ "parser builds tree", parserBuildsTree },
+		{ "parser parses expressions", parserParsesExpressions },
+		{ "parser recovers from errors", parserRecoversFromErrors },
+		{ "parser sets segments", parserSetsSegments }
+	});
+}
@@ -0,0 +1,106 @@
+#include "test.h"
+#include "buildw/scan.h"
+#include <random>
+
+using namespace wckt;
+using namespace wckt::build;
+
+static const scan::class_t CLASSES[] = { scan::WHITESPACE, scan::IDENTIFIER, scan::SYMBOL };
+
+static size_t runByTable(const char* data, size_t length, scan::class_t _class)
+{
+	size_t i = 0;
+	while(i < length && scan::is(data[i], _class))
+		i++;
+	return i;
+}
+
+static std::vector<size_t> newlinesByLoop(const char* data, size_t length, size_t offset)
+{
+	std::vector<size_t> lineStarts;
+	for(size_t i = 0 ; i < length ; ++i)
+		if(data[i] == '\n')
+			lineStarts.push_back(offset + i + 1);
+	return lineStarts;
+}
+
+/* Checks every primitive of the forced implementation against the table, from every start offset of data */
+static void checkAgainstTable(const std::string& data)
+{
+	for(size_t start = 0 ; start < data.length() ; ++start)
+	{
+		const char* at = data.data() + start;
+		size_t length = data.length() - start;
+		for(scan::class_t _class : CLASSES)
+			if(!TEST_CHECK_EQ(scan::runBlocks(at, length, _class), runByTable(at, length, _class))
+				|| !TEST_CHECK_EQ(scan::run(at, length, _class), runByTable(at, length, _class)))
+			{
+				std::cerr << "  " << scan::getImplementationName() << ", class " << (int) _class << ", offset " << start << std::endl;
+				return;
+			}
+
+		std::vector<size_t> lineStarts = { 0 };
+		scan::newlines(at, length, 7, lineStarts);
+		std::vector<size_t> expected = newlinesByLoop(at, length, 7);
+		expected.insert(expected.begin(), 0);
+		if(!TEST_CHECK(lineStarts == expected))
+			return;
+	}
+}
+
+/* Runs fn with each implementation the CPU supports forced in turn, then restores the default */
+static void forEachImplementation(const std::function<void()>& fn)
+{
+	std::string initial = scan::getImplementationName();
+	std::vector<const char*> names = scan::getSupportedImplementations();
+	TEST_CHECK(!names.empty() && initial == names[0]);
+	TEST_CHECK(std::string(names.back()) == "scalar");
+	for(const char* name : names)
+	{
+		TEST_CHECK(scan::setImplementation(name));
+		TEST_CHECK_EQ(std::string(scan::getImplementationName()), name);
+		fn();
+	}
+	TEST_CHECK(!scan::setImplementation("none"));
+	scan::setImplementation(initial);
+}
+
+static void scanMatchesTableOnRandomBuffers()
+{
+	// Bytes are drawn mostly from one class so runs cross several blocks, with every byte value possible
+	std::mt19937 random(42);
+	const std::string alphabets[] = { " \t\r\n", "aZ09_$", "+-*/<>{}", "\"'.#`\\" };
+	forEachImplementation([&random, &alphabets] {
+		for(uint32_t round = 0 ; round < 200 ; ++round)
+		{
+			std::string data(random() % 300, '\0');
+			const std::string& alphabet = alphabets[random() % 4];
+			for(char& ch : data)
+				ch = random() % 16 ? alphabet[random() % alphabet.length()] : (char) random();
+			checkAgainstTable(data);
+		}
+	});
+}
+
+static void scanMatchesTableAtBlockBoundaries()
+{
+	// Runs ending just before, at and after every block size, with the stop character of each kind
+	forEachImplementation([] {
+		for(size_t length : { 0, 1, 7, 8, 9, 15, 16, 17, 23, 24, 25, 31, 32, 33, 47, 48, 49, 63, 64, 65, 95, 96, 97 })
+			for(char fill : { ' ', '\n', 'x', '+' })
+				for(char stop : { '\0', '"', '\n', 'x', '+', (char) 0x80, (char) 0xff })
+				{
+					std::string data = std::string(length, fill) + stop + std::string(40, fill);
+					checkAgainstTable(data);
+					checkAgainstTable(std::string(length, fill));
+				}
+	});
+}
+
+int main()
+{
+	return test::runCases({
+		{ "scan matches table on random buffers", scanMatchesTableOnRandomBuffers },
+		{ "scan matches table at block boundaries", scanMatchesTableAtBlockBoundaries }
+	});
+}
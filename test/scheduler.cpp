@@ -0,0 +1,74 @@
+#include "test.h"
+#include "include/scheduler.h"
+#include <atomic>
+
+using namespace wckt;
+
+static void schedulerRunsEveryTaskOnce()
+{
+	// Far more tasks than workers, so workers run dry at different times and steal
+	const size_t count = 10000;
+	std::vector<std::atomic<uint32_t>> runs(count);
+	std::vector<WorkScheduler::task_t> tasks;
+	for(size_t i = 0 ; i < count ; ++i)
+		tasks.push_back([&runs, i] {
+			if(i % 97 == 0)
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			runs[i]++;
+		});
+	WorkScheduler(4).run(std::move(tasks));
+
+	size_t once = 0;
+	for(const auto& run : runs)
+		once += run == 1;
+	TEST_CHECK_EQ(once, count);
+}
+
+static void schedulerRunsInlineWithOneWorker()
+{
+	std::vector<size_t> order;
+	std::vector<WorkScheduler::task_t> tasks;
+	for(size_t i = 0 ; i < 100 ; ++i)
+		tasks.push_back([&order, i] { order.push_back(i); });
+	std::thread::id caller = std::this_thread::get_id(), ran;
+	tasks.push_back([&ran] { ran = std::this_thread::get_id(); });
+	WorkScheduler(1).run(std::move(tasks));
+
+	TEST_CHECK_EQ(order.size(), 100u);
+	TEST_CHECK(std::is_sorted(order.begin(), order.end()));
+	TEST_CHECK(ran == caller);
+	TEST_CHECK_THROWS(WorkScheduler(0), BadArgumentError);
+}
+
+static void schedulerKeepsCapturedExceptionsInOrder()
+{
+	// Results are kept per task, so the first failure by index is found whichever task failed first in time
+	const size_t count = 64;
+	std::vector<std::exception_ptr> exceptions(count);
+	std::vector<WorkScheduler::task_t> tasks;
+	for(size_t i = 0 ; i < count ; ++i)
+		tasks.push_back([&exceptions, i] {
+			try
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds((count - i) * 20));
+				if(i % 3 == 1)
+					throw BadArgumentError("task " + std::to_string(i));
+			}
+			catch(...)
+			{ exceptions[i] = std::current_exception(); }
+		});
+	WorkScheduler(8).run(std::move(tasks));
+
+	for(size_t i = 0 ; i < count ; ++i)
+		TEST_CHECK_EQ(exceptions[i] != nullptr, i % 3 == 1);
+	TEST_CHECK_THROWS(std::rethrow_exception(exceptions[1]), BadArgumentError);
+}
+
+int main()
+{
+	return test::runCases({
+		{ "scheduler runs every task once", schedulerRunsEveryTaskOnce },
+		{ "scheduler runs inline with one worker", schedulerRunsInlineWithOneWorker },
+		{ "scheduler keeps captured exceptions in order", schedulerKeepsCapturedExceptionsInOrder }
+	});
+}
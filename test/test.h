@@ -0,0 +1,98 @@
+#pragma once
+
+#include "include/definitions.h"
+#include "include/exception.h"
+#include <iostream>
+#include <unistd.h>
+
+/**
+ * Minimal unit test support. Every file under test/ is built into its own executable by `make test`,
+ * whose main() returns runCases() over its cases. A failed check is reported with its location and
+ * fails the running case without stopping it, an exception escaping a case fails it too.
+ */
+namespace wckt::test
+{
+	typedef struct
+	{
+		const char* name;
+		std::function<void()> fn;
+	} test_case_t;
+
+	inline uint32_t& failedChecks()
+	{
+		static uint32_t count = 0;
+		return count;
+	}
+
+	inline bool check(bool condition, const char* expression, const char* file, int line)
+	{
+		if(!condition)
+		{
+			std::cerr << "  " << file << ":" << line << ": check failed: " << expression << std::endl;
+			failedChecks()++;
+		}
+		return condition;
+	}
+
+	/* Returns the number of failed cases */
+	inline int runCases(const std::vector<test_case_t>& cases)
+	{
+		int failed = 0;
+		for(const auto& _case : cases)
+		{
+			failedChecks() = 0;
+			try
+			{ _case.fn(); }
+			catch(const std::exception& e)
+			{
+				std::cerr << "  uncaught exception: " << e.what() << std::endl;
+				failedChecks()++;
+			}
+			std::cerr << (failedChecks() ? "FAIL " : "ok   ") << _case.name << std::endl;
+			failed += failedChecks() != 0;
+		}
+		return failed;
+	}
+
+	/* Empty directory removed with its contents on destruction */
+	class TemporaryDirectory
+	{
+		private:
+			std::filesystem::path path;
+
+		public:
+			TemporaryDirectory(const std::string& name)
+			: path(std::filesystem::temp_directory_path() / ("wckt-test-" + name + "-" + std::to_string(::getpid())))
+			{
+				std::filesystem::remove_all(this->path);
+				std::filesystem::create_directories(this->path);
+			}
+
+			~TemporaryDirectory()
+			{
+				std::error_code ec;
+				std::filesystem::remove_all(this->path, ec);
+			}
+
+			std::filesystem::path getPath() const { return this->path; }
+
+			std::filesystem::path write(const std::string& name, std::string_view contents) const
+			{
+				std::filesystem::path file = this->path / name;
+				std::filesystem::create_directories(file.parent_path());
+				std::ofstream out(file, std::ios::binary | std::ios::trunc);
+				out.write(contents.data(), contents.length());
+				return file;
+			}
+	};
+}
+
+#define TEST_CHECK(_Cond)			::wckt::test::check((_Cond), #_Cond, __FILE__, __LINE__)
+#define TEST_CHECK_EQ(_A, _B)		::wckt::test::check((_A) == (_B), #_A " == " #_B, __FILE__, __LINE__)
+#define TEST_CHECK_THROWS(_Expr, _Exc)																		\
+	do																										\
+	{																										\
+		bool __thrown = false;																				\
+		try { _Expr; } catch(const _Exc&) { __thrown = true; }												\
+		::wckt::test::check(__thrown, #_Expr " throws " #_Exc, __FILE__, __LINE__);							\
+	} while(0)
@@ -0,0 +1,211 @@
+#include "test.h"
+#include "type/types.h"
+
+using namespace wckt;
+using namespace wckt::type;
+
+static bool isSorted(const Type* type)
+{
+	const std::vector<const Type*>& operands = type->getOperands();
+	for(size_t i = 1 ; i < operands.size() ; ++i)
+		if(operands[i - 1]->getID() >= operands[i]->getID())
+			return false;
+	return true;
+}
+
+static void tableHashConsesTypes()
+{
+	TypeTable table;
+	const Type* a = table.reference("A");
+	TEST_CHECK(table.reference("A") == a);
+	TEST_CHECK(table.reference("B") != a);
+	TEST_CHECK(table.reference("A", { a }) == table.reference("A", { table.reference("A") }));
+	TEST_CHECK(table.reference("A", { a }) != a);
+	TEST_CHECK(table.generic(0) == table.generic(0) && table.generic(0) != table.generic(1));
+	TEST_CHECK(table.optional(a) == table.optional(a) && table.optional(table.optional(a)) == table.optional(a));
+
+	// Contracts are equal whatever the order of their origins and properties
+	const Type* b = table.reference("B");
+	const Type* contract = table.contract({ "T", "S" }, 0, { { "x", a }, { "y", b } });
+	TEST_CHECK(table.contract({ "S", "T", "S" }, 0, { { "y", b }, { "x", a } }) == contract);
+	TEST_CHECK(table.contract({ "S", "T" }, Type::CALLABLE, { { "x", a }, { "y", b } }) != contract);
+	TEST_CHECK(table.contract({ "S", "T" }, 0, { { "x", b }, { "y", a } }) != contract);
+	TEST_CHECK_EQ(contract->toString(), "{ origin S, origin T, x: A, y: B }");
+
+	TEST_CHECK(table.function({ a, b }, nullptr) == table.function({ a, b }, nullptr));
+	TEST_CHECK(table.function({ a, b }, nullptr) != table.function({ b, a }, nullptr));
+	TEST_CHECK(table.function({ a }, b) != table.function({ a }, nullptr));
+
+	// Building a type again creates no node
+	size_t count = table.getTypeCount();
+	table.contract({ "T", "S" }, 0, { { "y", b }, { "x", a } });
+	table.function({ a }, b);
+	table.reference("A", { a });
+	TEST_CHECK_EQ(table.getTypeCount(), count);
+
+	// Properties declared twice are intersected
+	const Type* twice = table.contract({}, 0, { { "x", a }, { "x", b } });
+	TEST_CHECK(twice->getPropertyNames().size() == 1 && twice->findProperty("x") == table.intersect(a, b));
+}
+
+static void tableNormalizesUnions()
+{
+	TypeTable table;
+	const Type* a = table.reference("A");
+	const Type* b = table.reference("B");
+	const Type* c = table.reference("C");
+
+	// Unions are flattened, sorted and deduplicated, so every grouping and order gives the same node
+	const Type* abc = table.unite(table.unite(a, b), c);
+	TEST_CHECK(abc->getKind() == Type::UNION && abc->getOperands().size() == 3 && isSorted(abc));
+	TEST_CHECK(table.unite(c, table.unite(b, a)) == abc);
+	TEST_CHECK(table.unite(table.unite(c, a), table.unite(b, c)) == abc);
+	TEST_CHECK(table.unite(abc, b) == abc && table.unite(a, a) == a);
+	for(const Type* member : abc->getOperands())
+		TEST_CHECK(member->getKind() != Type::UNION);
+
+	const Type* ab = table.intersect(table.intersect(c, a), b);
+	TEST_CHECK(ab->getKind() == Type::INTERSECTION && ab->getOperands().size() == 3 && isSorted(ab));
+	TEST_CHECK(table.intersect(a, table.intersect(b, c)) == ab);
+	TEST_CHECK(table.intersect(ab, table.intersect(a, b)) == ab);
+
+	// Intersections distribute over unions, so no intersection has a union member
+	const Type* distributed = table.intersect(table.unite(a, b), c);
+	TEST_CHECK(distributed == table.unite(table.intersect(a, c), table.intersect(b, c)));
+	TEST_CHECK(distributed->getKind() == Type::UNION && isSorted(distributed));
+	for(const Type* member : distributed->getOperands())
+	{
+		TEST_CHECK(member->getKind() == Type::INTERSECTION && isSorted(member));
+		for(const Type* operand : member->getOperands())
+			TEST_CHECK(operand->getKind() != Type::UNION && operand->getKind() != Type::INTERSECTION);
+	}
+
+	// Optionals move to the outside, errors absorb everything
+	TEST_CHECK(table.unite(table.optional(a), b) == table.optional(table.unite(a, b)));
+	TEST_CHECK(table.intersect(table.optional(a), table.optional(b)) == table.optional(table.intersect(a, b)));
+	TEST_CHECK(table.intersect(table.optional(a), b) == table.intersect(a, b));
+	TEST_CHECK(table.unite(abc, table.error()) == table.error());
+
+	// Contracts and functions merge into a single member
+	const Type* x = table.contract({}, 0, { { "x", a } });
+	const Type* y = table.contract({}, 0, { { "y", b } });
+	TEST_CHECK(table.intersect(x, y) == table.contract({}, 0, { { "x", a }, { "y", b } }));
+	TEST_CHECK(table.unite(x, y) == table.contract({}, 0, {}));
+	TEST_CHECK(table.unite(table.contract({}, 0, { { "x", a } }), table.contract({}, 0, { { "x", b } }))
+		== table.contract({}, 0, { { "x", table.unite(a, b) } }));
+	const Type* withCall = table.intersect(x, table.function({ a }, b));
+	TEST_CHECK(withCall == table.contract({}, Type::CALLABLE, { { "call", table.function({ a }, b) }, { "x", a } }));
+	TEST_CHECK(table.unite(table.unite(x, c), y) == table.unite(c, table.contract({}, 0, {})));
+}
+
+static void tableMemoizesAlgebra()
+{
+	TypeTable table;
+	const Type* a = table.reference("A");
+	const Type* b = table.reference("B");
+	const Type* c = table.reference("C");
+	const Type* x = table.contract({}, 0, { { "x", table.unite(a, b) } });
+	const Type* y = table.contract({}, 0, { { "x", table.unite(b, c) }, { "y", a } });
+
+	const Type* united = table.unite(table.intersect(x, y), table.unite(c, a));
+	const Type* intersected = table.intersect(table.unite(a, x), table.unite(y, c));
+	size_t count = table.getTypeCount();
+
+	// Repeated and commuted operations return the same node without building anything
+	TEST_CHECK(table.unite(table.intersect(x, y), table.unite(c, a)) == united);
+	TEST_CHECK(table.unite(table.unite(a, c), table.intersect(y, x)) == united);
+	TEST_CHECK(table.intersect(table.unite(a, x), table.unite(y, c)) == intersected);
+	TEST_CHECK(table.intersect(table.unite(c, y), table.unite(x, a)) == intersected);
+	TEST_CHECK_EQ(table.getTypeCount(), count);
+
+	// A table is independent of others, but builds the same structure
+	TypeTable other;
+	const Type* otherUnion = other.unite(other.reference("B"), other.reference("A"));
+	TEST_CHECK(otherUnion != table.unite(a, b));
+	TEST_CHECK_EQ(otherUnion->toString(), table.unite(a, b)->toString());
+}
+
+/* List<T> as { head: T, tail: List<T>? } */
+static void defineList(TypeTable& table, const std::string& locator)
+{
+	const Type* element = table.generic(0);
+	table.define(locator, 1, table.contract({}, 0, {
+		{ "head", element }, { "tail", table.optional(table.reference(locator, { element })) } }));
+}
+
+/* Chain of types prefix0 to prefix{depth - 1}, each of which refers to the next twice and the last to the first */
+static void defineChain(TypeTable& table, const std::string& prefix, size_t depth)
+{
+	for(size_t i = 0 ; i < depth ; ++i)
+	{
+		const Type* next = table.reference(prefix + std::to_string((i + 1) % depth));
+		table.define(prefix + std::to_string(i), 0, table.contract({}, 0, { { "left", next }, { "right", table.optional(next) } }));
+	}
+}
+
+static void subtypeComparesLists()
+{
+	TypeTable table;
+	defineList(table, "List");
+	defineList(table, "Sequence");
+	const Type* a = table.reference("A");
+	const Type* list = table.reference("List", { a });
+	const Type* sequence = table.reference("Sequence", { a });
+
+	// Structurally equal recursive types hold both ways, relying on the pair being checked
+	TEST_CHECK(table.isSubtype(list, list));
+	TEST_CHECK(table.isSubtype(list, sequence) && table.isSubtype(sequence, list));
+	TEST_CHECK(table.isSubtype(table.optional(list), table.optional(sequence)));
+	TEST_CHECK(!table.isSubtype(table.optional(list), sequence));
+	TEST_CHECK(!table.isSubtype(list, table.reference("List", { table.reference("B") })));
+	TEST_CHECK(table.isSubtype(list, table.reference("List", { table.unite(a, table.reference("B")) })));
+	TEST_CHECK(!table.isSubtype(table.reference("List", { table.unite(a, table.reference("B")) }), list));
+}
+
+static void subtypeDiscardsProvisionalResults()
+{
+	// The tails compare under the assumption that the lists do, which the heads then refute
+	TypeTable table;
+	const Type* good = table.reference("Good");
+	const Type* bad = table.reference("Bad");
+	table.define("Good", 0, table.contract({}, 0, { { "next", table.optional(good) }, { "value", table.reference("A") } }));
+	table.define("Bad", 0, table.contract({}, 0, { { "next", table.optional(bad) }, { "value", table.reference("B") } }));
+
+	TEST_CHECK(!table.isSubtype(good, bad));
+	TEST_CHECK(!table.isSubtype(table.optional(good), table.optional(bad)));
+	TEST_CHECK(!table.isSubtype(table.contract({}, 0, { { "next", table.optional(good) } }),
+		table.contract({}, 0, { { "next", table.optional(bad) } })));
+
+	// The same pairs hold once the heads agree, and redefining a type drops results relying on it
+	table.define("Bad", 0, table.contract({}, 0, { { "next", table.optional(bad) }, { "value", table.reference("A") } }));
+	TEST_CHECK(table.isSubtype(table.optional(good), table.optional(bad)));
+	TEST_CHECK(table.isSubtype(good, bad) && table.isSubtype(bad, good));
+}
+
+static void subtypeIsLinearInChains()
+{
+	// Each level is reached twice, so checks without memoization would take time exponential in the depth
+	std::vector<size_t> counts;
+	for(size_t depth : { 500, 1000 })
+	{
+		TypeTable table;
+		defineChain(table, "T", depth);
+		defineChain(table, "U", depth);
+		TEST_CHECK(table.isSubtype(table.reference("T0"), table.reference("U0")));
+		TEST_CHECK(table.isSubtype(table.reference("U" + std::to_string(depth / 2)), table.reference("T0")));
+		counts.push_back(table.getSubtypeCount());
+	}
+	TEST_CHECK_EQ(counts[1], 2 * counts[0]);
+}
+
+int main()
+{
+	return test::runCases({
+		{ "table hash-conses types", tableHashConsesTypes },
+		{ "table normalizes unions", tableNormalizesUnions },
+		{ "table memoizes algebra", tableMemoizesAlgebra },
+		{ "subtype compares lists", subtypeComparesLists },
+		{ "subtype discards provisional results", subtypeDiscardsProvisionalResults },
+		{ "subtype is linear in chains", subtypeIsLinearInChains }
+	});
+}